@@ -259,6 +259,28 @@ int icsneo_addMessageCallback(const neodevice_t* device, void (*callback)(neomes
 	);
 }
 
+int icsneo_addBatchMessageCallback(const neodevice_t* device, void (*callback)(const neomessage_t* messages, size_t count),
+	size_t maxMessages, uint32_t maxLatencyMicroseconds, void*) {
+	if(!icsneo_isValidNeoDevice(device))
+		return -1;
+
+	return device->device->addMessageCallback(
+		BatchMessageCallback(
+			[=](std::vector<std::shared_ptr<icsneo::Message>> msgs) {
+				// The neomessage_t's point into msgs, which stays alive until the callback returns
+				std::vector<neomessage_t> neomsgs;
+				neomsgs.reserve(msgs.size());
+				for(const auto& msg : msgs)
+					neomsgs.push_back(CreateNeoMessage(msg));
+				return callback(neomsgs.data(), neomsgs.size());
+			},
+			MessageFilter(),
+			maxMessages,
+			std::chrono::microseconds(maxLatencyMicroseconds)
+		)
+	);
+}
+
 bool icsneo_removeMessageCallback(const neodevice_t* device, int id) {
 	if(!icsneo_isValidNeoDevice(device))
 		return false;
@@ -109,6 +109,10 @@ static constexpr const char* EOF_REACHED = "The requested length exceeds the ava
 static constexpr const char* SETTINGS_DEFAULTS_USED = "The device settings could not be loaded, the default settings have been applied.";
 static constexpr const char* ATOMIC_OPERATION_RETRIED = "An operation failed to be atomically completed, but will be retried.";
 static constexpr const char* ATOMIC_OPERATION_COMPLETED_NONATOMICALLY = "An ideally-atomic operation was completed nonatomically.";
+static constexpr const char* PREPARED_TRANSMIT_NOT_SUPPORTED = "Only CAN and Ethernet frames which are not handled by a device extension can be prepared for transmit.";
+static constexpr const char* EXTRACTION_FILE_ERROR = "The file being extracted to could not be opened or written.";
+static constexpr const char* EXTRACTION_RESTARTED = "The checkpoint of an interrupted extraction could not be verified, so some or all of it will be extracted again.";
+static constexpr const char* DISK_IMAGE_ERROR = "The disk image file could not be opened or mapped into memory.";
 
 // Transport Errors
 static constexpr const char* FAILED_TO_READ = "A read operation failed.";
@@ -118,6 +122,8 @@ static constexpr const char* DRIVER_FAILED_TO_CLOSE = "The device driver encount
 static constexpr const char* PACKET_CHECKSUM_ERROR = "There was a checksum error while decoding a packet. The packet was dropped.";
 static constexpr const char* TRANSMIT_BUFFER_FULL = "The transmit buffer is full and the device is set to non-blocking.";
 static constexpr const char* DEVICE_IN_USE = "The device is currently in use by another program.";
+static constexpr const char* MTU_NOT_SUPPORTED = "The MTU can not be changed for this device's connection.";
+static constexpr const char* DECODE_QUEUE_OVERFLOW = "Too many packets are waiting to be decoded, some have been lost!";
 static constexpr const char* PCAP_COULD_NOT_START = "The PCAP driver could not be started. Ethernet devices will not be found.";
 static constexpr const char* PCAP_COULD_NOT_FIND_DEVICES = "The PCAP driver failed to find devices. Ethernet devices will not be found.";
 static constexpr const char* PACKET_DECODING = "There was an error decoding a packet from the device.";
@@ -232,6 +238,14 @@ const char* APIEvent::DescriptionForType(Type type) {
 			return ATOMIC_OPERATION_RETRIED;
 		case Type::AtomicOperationCompletedNonatomically:
 			return ATOMIC_OPERATION_COMPLETED_NONATOMICALLY;
+		case Type::PreparedTransmitNotSupported:
+			return PREPARED_TRANSMIT_NOT_SUPPORTED;
+		case Type::ExtractionFileError:
+			return EXTRACTION_FILE_ERROR;
+		case Type::ExtractionRestarted:
+			return EXTRACTION_RESTARTED;
+		case Type::DiskImageError:
+			return DISK_IMAGE_ERROR;
 
 		// Transport Errors
 		case Type::FailedToRead:
@@ -248,6 +262,10 @@ const char* APIEvent::DescriptionForType(Type type) {
 			return TRANSMIT_BUFFER_FULL;
 		case Type::DeviceInUse:
 			return DEVICE_IN_USE;
+		case Type::MTUNotSupported:
+			return MTU_NOT_SUPPORTED;
+		case Type::DecodeQueueOverflow:
+			return DECODE_QUEUE_OVERFLOW;
 		case Type::PCAPCouldNotStart:
 			return PCAP_COULD_NOT_START;
 		case Type::PCAPCouldNotFindDevices:
@@ -0,0 +1,70 @@
+// Measures Decoder::decode over a mixed stream of CAN, Ethernet and Main51 command packets
+
+#include "icsneo/communication/decoder.h"
+#include "icsneo/communication/command.h"
+#include "icsneo/communication/packet/ethernetpacket.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+using namespace icsneo;
+
+static const size_t Iterations = 1000000;
+static const size_t Rounds = 5;
+
+static std::shared_ptr<Packet> MakePacket(Network::NetID netid, std::vector<uint8_t> data) {
+	auto packet = std::make_shared<Packet>();
+	packet->network = netid;
+	packet->data = std::move(data);
+	return packet;
+}
+
+int main() {
+	size_t errors = 0;
+	Decoder decoder([&errors](APIEvent::Type, APIEvent::Severity) { errors++; });
+
+	std::vector<uint8_t> can(24);
+	can[4] = 8; // DLC
+	std::vector<uint8_t> eth(sizeof(HardwareEthernetPacket) + 64);
+	reinterpret_cast<HardwareEthernetPacket*>(eth.data())->Length = 64 + 4; // Including the two trailing words
+
+	// Roughly the mix seen on a busy multi-bus device
+	const std::vector<std::shared_ptr<Packet>> stream = {
+		MakePacket(Network::NetID::HSCAN, can),
+		MakePacket(Network::NetID::MSCAN, can),
+		MakePacket(Network::NetID::HSCAN2, can),
+		MakePacket(Network::NetID::Ethernet, eth),
+		MakePacket(Network::NetID::HSCAN, can),
+		MakePacket(Network::NetID::SWCAN, can),
+		MakePacket(Network::NetID::Main51, { uint8_t(Command::RequestStatusUpdate) }),
+		MakePacket(Network::NetID::HSCAN3, can),
+	};
+
+	std::cout << "Decoder::decode, mixed CAN/Ethernet/Main51 stream, " << Iterations << " packets" << std::endl;
+
+	double best = 0;
+	for(size_t round = 0; round < Rounds; round++) {
+		// Packets may be modified by decoding, so each decode gets a fresh copy
+		std::vector<std::shared_ptr<Packet>> packets;
+		packets.reserve(Iterations);
+		for(size_t i = 0; i < Iterations; i++)
+			packets.push_back(std::make_shared<Packet>(*stream[i % stream.size()]));
+
+		std::shared_ptr<Message> msg;
+		size_t decoded = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for(const auto& packet : packets) {
+			if(decoder.decode(msg, packet))
+				decoded++;
+		}
+		const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+		const double perPacket = elapsed.count() / Iterations;
+		if(round == 0 || perPacket < best)
+			best = perPacket;
+
+		std::cout << "Round " << round + 1 << ": " << std::fixed << std::setprecision(2) << perPacket << " ns/packet, "
+			<< decoded << " decoded, " << errors << " errors" << std::endl;
+	}
+	std::cout << "Best: " << std::fixed << std::setprecision(2) << best << " ns/packet" << std::endl;
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+// Measures the disk layer, Disk::ReadDriver and Disk::WriteDriver, against modeled
+// devices with a configurable round trip latency, bandwidth and block size
+
+#include "icsneo/disk/diskreaddriver.h"
+#include "icsneo/disk/diskwritedriver.h"
+#include "icsneo/communication/communication.h"
+#include "icsneo/communication/driver.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace icsneo;
+
+static const size_t Rounds = 3;
+static const uint64_t DiskSize = 4 * 1024 * 1024;
+static const double LinkMegabytesPerSecond = 40; // Roughly USB high speed once the protocol is accounted for
+
+struct Model {
+	const char* name;
+	uint32_t maxBlockSize;
+	bool pipelined;
+};
+
+// Every block read or write is a round trip over a link with this latency and bandwidth
+class ModeledDiskDriver : public Disk::ReadDriver, public Disk::WriteDriver {
+public:
+	ModeledDiskDriver(const Model& model, std::chrono::microseconds latency)
+		: model(model), latency(latency), disk(DiskSize) {
+		cacheMaxBytes = 0; // Every round should go to the modeled device
+		for(size_t i = 0; i < disk.size(); i++)
+			disk[i] = uint8_t(i);
+	}
+
+	std::pair<uint32_t, uint32_t> getBlockSizeBounds() const override {
+		return { static_cast<uint32_t>(Disk::SectorSize), model.maxBlockSize };
+	}
+
+	size_t roundTrips = 0;
+
+private:
+	class PendingRead {
+	public:
+		uint64_t pos;
+		optional<uint64_t> result;
+		std::chrono::steady_clock::time_point readyAt;
+	};
+
+	const Model model;
+	const std::chrono::microseconds latency;
+	std::vector<uint8_t> disk;
+	std::deque<PendingRead> pendingReads;
+	std::chrono::steady_clock::time_point linkFreeAt;
+
+	Disk::Access getPossibleAccess() const override { return Disk::Access::EntireCard; }
+
+	// When a transfer started now would complete, the link carries one transfer at a time
+	std::chrono::steady_clock::time_point schedule(uint64_t amount) {
+		const auto now = std::chrono::steady_clock::now();
+		const auto transferTime = std::chrono::nanoseconds(uint64_t(amount * 1000 / LinkMegabytesPerSecond));
+		linkFreeAt = std::max(now + latency, linkFreeAt) + transferTime;
+		roundTrips++;
+		return linkFreeAt;
+	}
+
+	optional<uint64_t> copyOut(uint64_t pos, uint8_t* into, uint64_t amount) const {
+		if(pos >= disk.size())
+			return nullopt;
+		amount = std::min(amount, disk.size() - pos);
+		memcpy(into, disk.data() + pos, size_t(amount));
+		return amount;
+	}
+
+	optional<uint64_t> readLogicalDiskAligned(Communication&, device_eventhandler_t,
+		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds) override {
+		std::this_thread::sleep_until(schedule(amount));
+		return copyOut(pos, into, amount);
+	}
+
+	bool supportsPipelinedReads() const override { return model.pipelined; }
+
+	bool beginReadLogicalDiskAligned(Communication&, device_eventhandler_t,
+		uint64_t pos, uint8_t* into, uint64_t amount) override {
+		pendingReads.push_back({ pos, copyOut(pos, into, amount), schedule(amount) });
+		return true;
+	}
+
+	bool finishReadLogicalDiskAligned(Communication&, uint64_t& pos, optional<uint64_t>& result,
+		std::chrono::milliseconds) override {
+		if(pendingReads.empty())
+			return false;
+		std::this_thread::sleep_until(pendingReads.front().readyAt);
+		pos = pendingReads.front().pos;
+		result = pendingReads.front().result;
+		pendingReads.pop_front();
+		return true;
+	}
+
+	optional<uint64_t> writeLogicalDiskAligned(Communication&, device_eventhandler_t,
+		uint64_t pos, const uint8_t* atomicBuf, const uint8_t* from, uint64_t amount, std::chrono::milliseconds) override {
+		std::this_thread::sleep_until(schedule(amount));
+		if(pos >= disk.size())
+			return nullopt;
+		amount = std::min(amount, disk.size() - pos);
+		if(atomicBuf && memcmp(disk.data() + pos, atomicBuf, size_t(amount)) != 0)
+			return RetryAtomic;
+		memcpy(disk.data() + pos, from, size_t(amount));
+		return amount;
+	}
+};
+
+// The disk layer passes this along to the drivers, which never use it here
+class NullDriver : public Driver {
+public:
+	using Driver::Driver;
+	bool open() override { return false; }
+	bool isOpen() override { return false; }
+	bool close() override { return true; }
+private:
+	void readTask() override {}
+	void writeTask() override {}
+};
+
+int main() {
+	const Model reads[] = {
+		{ "NeoMemory-style, 1 sector/trip", uint32_t(Disk::SectorSize), false },
+		{ "ExtExtractor-style, 512 sectors/trip", uint32_t(Disk::SectorSize * 512), false },
+		{ "Pipelined, 8 sectors/trip", uint32_t(Disk::SectorSize * 8), true },
+	};
+	const Model write = { "Write, 1 sector/trip", uint32_t(Disk::SectorSize), false };
+	const std::chrono::microseconds latencies[] = { std::chrono::microseconds(0), std::chrono::microseconds(100), std::chrono::microseconds(1000) };
+	const uint64_t sizes[] = { 64 * 1024, 1024 * 1024 };
+
+	size_t errors = 0;
+	const device_eventhandler_t report = [&errors](APIEvent::Type, APIEvent::Severity) { errors++; };
+	Communication com(report, std::unique_ptr<Driver>(new NullDriver(report)), {}, nullptr, nullptr);
+
+	std::cout << "Disk::ReadDriver and Disk::WriteDriver over a modeled " << LinkMegabytesPerSecond << " MB/s link, best of "
+		<< Rounds << " rounds" << std::endl;
+	std::cout << std::left << std::setw(48) << "" << std::setw(10) << "Size" << std::setw(10) << "Latency"
+		<< std::setw(12) << "MB/s" << "Trips/MB" << std::endl;
+
+	// Each round runs one transfer of `size` through a fresh driver, which returns how much was transferred
+	const auto run = [&](const std::string& name, const Model& model, std::chrono::microseconds latency, uint64_t size,
+		const std::function<optional<uint64_t>(ModeledDiskDriver&, std::vector<uint8_t>&)>& transfer) {
+		double best = 0;
+		size_t roundTrips = 0;
+		for(size_t round = 0; round < Rounds; round++) {
+			ModeledDiskDriver driver(model, latency);
+			std::vector<uint8_t> buffer(size_t(size), 0xCD);
+			const auto start = std::chrono::steady_clock::now();
+			const auto transferred = transfer(driver, buffer);
+			const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+			if(transferred != size)
+				errors++;
+			const double megabytesPerSecond = double(size) / (1024 * 1024) / elapsed.count();
+			if(round == 0 || megabytesPerSecond > best)
+				best = megabytesPerSecond;
+			roundTrips = driver.roundTrips;
+		}
+
+		std::cout << std::left << std::setw(48) << name << std::setw(10) << (std::to_string(size / 1024) + " KiB")
+			<< std::setw(10) << (std::to_string(latency.count()) + " us") << std::fixed << std::setprecision(2)
+			<< std::setw(12) << best << double(roundTrips) * 1024 * 1024 / double(size) << std::endl;
+	};
+
+	for(const auto latency : latencies) {
+		for(const auto size : sizes) {
+			for(const auto& model : reads) {
+				run(model.name, model, latency, size, [&](ModeledDiskDriver& driver, std::vector<uint8_t>& buffer) {
+					return driver.readLogicalDisk(com, report, 0, buffer.data(), buffer.size(), std::chrono::seconds(60));
+				});
+			}
+
+			run(std::string(write.name) + ", aligned", write, latency, size, [&](ModeledDiskDriver& driver, std::vector<uint8_t>& buffer) {
+				return driver.writeLogicalDisk(com, report, driver, 0, buffer.data(), buffer.size(), std::chrono::seconds(60));
+			});
+			// Only the partial sectors at either end are read first
+			run(std::string(write.name) + ", unaligned", write, latency, size, [&](ModeledDiskDriver& driver, std::vector<uint8_t>& buffer) {
+				return driver.writeLogicalDisk(com, report, driver, 100, buffer.data(), buffer.size(), std::chrono::seconds(60));
+			});
+		}
+	}
+
+	if(errors)
+		std::cout << errors << " errors" << std::endl;
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+// Measures the per-message cost of Device::handleInternalMessage, which
+// runs for every message received, with various extensions installed.
+
+#include "icsneo/device/device.h"
+#include "icsneo/device/extensions/deviceextension.h"
+#include "icsneo/device/extensions/flexray/extension.h"
+#include "icsneo/communication/message/canmessage.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+using namespace icsneo;
+
+class NullDriver : public Driver {
+public:
+	NullDriver(const device_eventhandler_t& report) : Driver(report) {}
+	bool open() override { return false; }
+	bool isOpen() override { return false; }
+	bool close() override { return true; }
+private:
+	void readTask() override {}
+	void writeTask() override {}
+};
+
+class BenchmarkDevice : public Device {
+public:
+	BenchmarkDevice() : Device(neodevice_t()) {
+		initialize([](device_eventhandler_t report, neodevice_t&) {
+			return std::unique_ptr<Driver>(new NullDriver(report));
+		});
+	}
+	using Device::addExtension;
+	using Device::handleInternalMessage;
+};
+
+// An extension which has not declared which messages it wants, so it sees all of them
+class CatchAllExtension : public DeviceExtension {
+public:
+	CatchAllExtension(Device& device) : DeviceExtension(device) {}
+	const char* getName() const override { return "CatchAll"; }
+	void handleMessage(const std::shared_ptr<Message>&) override { handled++; }
+	size_t handled = 0;
+};
+
+static const size_t Iterations = 10000000;
+
+static void Run(const char* name, BenchmarkDevice& device) {
+	auto msg = std::make_shared<CANMessage>();
+	msg->network = Network::NetID::HSCAN;
+
+	const auto start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < Iterations; i++)
+		device.handleInternalMessage(msg);
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+	std::cout << std::left << std::setw(32) << name << std::fixed << std::setprecision(2)
+		<< elapsed.count() / Iterations << " ns/message" << std::endl;
+}
+
+int main() {
+	std::cout << "Device::handleInternalMessage with a CAN message, " << Iterations << " iterations" << std::endl;
+
+	{
+		BenchmarkDevice device;
+		Run("No extensions", device);
+	}
+
+	{
+		BenchmarkDevice device;
+		device.addExtension(std::make_shared<FlexRay::Extension>(device, std::vector<Network>({ Network::NetID::FlexRay })));
+		Run("FlexRay extension", device);
+	}
+
+	{
+		BenchmarkDevice device;
+		device.addExtension(std::make_shared<CatchAllExtension>(device));
+		Run("Catch-all extension", device);
+	}
+
+	{
+		BenchmarkDevice device;
+		device.addExtension(std::make_shared<FlexRay::Extension>(device, std::vector<Network>({ Network::NetID::FlexRay })));
+		device.addExtension(std::make_shared<CatchAllExtension>(device));
+		Run("FlexRay and catch-all", device);
+	}
+
+	return 0;
+}
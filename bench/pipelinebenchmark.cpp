@@ -0,0 +1,88 @@
+// Measures the receive pipeline, Packetizer::input and Decoder::decode, for a
+// stream of CAN frames with the packetizer and decoder set up like each device family
+
+#include "icsneo/communication/packetizer.h"
+#include "icsneo/communication/decoder.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+using namespace icsneo;
+
+static const size_t Packets = 1000000;
+static const size_t ReadSize = 512; // Roughly what one USB read gives us
+static const size_t Rounds = 5;
+
+struct Family {
+	const char* name;
+	bool disableChecksum;
+	bool align16bit;
+	uint16_t timestampResolution;
+};
+
+// A long format packet from the device, as CAN frames are sent
+static std::vector<uint8_t> MakeCANPacket(Network::NetID netid) {
+	std::vector<uint8_t> packet = { 0xAA, 0x00, 0, 0, uint8_t(netid), uint8_t(uint16_t(netid) >> 8) };
+	packet.resize(6 + 24);
+	packet[2] = uint8_t(packet.size());
+	packet[6 + 4] = 8; // DLC
+	return packet;
+}
+
+int main() {
+	const Family families[] = {
+		{ "ValueCAN 4 / neoVI FIRE 2", false, true, 25 },
+		{ "neoVI RED 2", false, false, 25 },
+		{ "RAD-Galaxy / RAD-Gigastar", true, false, 10 },
+	};
+
+	std::vector<uint8_t> stream;
+	for(size_t i = 0; i < Packets; i++) {
+		const auto packet = MakeCANPacket(i % 2 ? Network::NetID::HSCAN : Network::NetID::HSCAN2);
+		stream.insert(stream.end(), packet.begin(), packet.end());
+	}
+	std::vector<std::vector<uint8_t>> reads;
+	for(size_t i = 0; i < stream.size(); i += ReadSize)
+		reads.emplace_back(stream.begin() + i, stream.begin() + std::min(i + ReadSize, stream.size()));
+
+	std::cout << "Packetizer::input and Decoder::decode, " << Packets << " CAN packets in " << ReadSize << " byte reads" << std::endl;
+
+	int ret = 0;
+	for(const auto& family : families) {
+		size_t errors = 0;
+		const device_eventhandler_t report = [&errors](APIEvent::Type, APIEvent::Severity) { errors++; };
+
+		double best = 0;
+		for(size_t round = 0; round < Rounds; round++) {
+			Packetizer packetizer(report);
+			packetizer.disableChecksum = family.disableChecksum;
+			packetizer.align16bit = family.align16bit;
+			Decoder decoder(report);
+			decoder.timestampResolution = family.timestampResolution;
+
+			size_t decoded = 0;
+			std::shared_ptr<Message> msg;
+			const auto start = std::chrono::steady_clock::now();
+			for(const auto& read : reads) {
+				if(!packetizer.input(read))
+					continue;
+				for(const auto& packet : packetizer.output()) {
+					if(decoder.decode(msg, packet))
+						decoded++;
+				}
+			}
+			const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+			const double perPacket = elapsed.count() / Packets;
+			if(round == 0 || perPacket < best)
+				best = perPacket;
+			if(decoded != Packets)
+				ret = 1;
+		}
+
+		std::cout << std::left << std::setw(32) << family.name << std::fixed << std::setprecision(2)
+			<< best << " ns/packet, " << errors << " errors" << std::endl;
+		if(errors)
+			ret = 1;
+	}
+	return ret;
+}
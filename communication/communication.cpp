@@ -22,6 +22,11 @@ Communication::~Communication() {
 	if(redirectingRead)
 		clearRedirectRead();
 	close();
+
+	// Asynchronous callbacks sharing an executor could otherwise outlive us
+	std::lock_guard<std::mutex> lk(messageCallbacksLock);
+	for(auto& cb : messageCallbacks)
+		cb.second.stopAsync();
 }
 
 bool Communication::open() {
@@ -37,6 +42,12 @@ bool Communication::open() {
 }
 
 void Communication::spawnThreads() {
+	if(pipelined) {
+		pipelineQueue.reset(new moodycamel::BlockingReaderWriterQueue<PipelinedPacket>(pipelineQueueSize));
+		pipelineOverflowing = false;
+		pipelineActive = true;
+		decodeTaskThread = std::thread(&Communication::decodeTask, this);
+	}
 	readTaskThread = std::thread(&Communication::readTask, this);
 }
 
@@ -44,7 +55,16 @@ void Communication::joinThreads() {
 	closing = true;
 	if(readTaskThread.joinable())
 		readTaskThread.join();
+	if(decodeTaskThread.joinable())
+		decodeTaskThread.join();
+	pipelineActive = false;
+	pipelineQueue.reset();
 	closing = false;
+
+	// Don't leave anything the subscribers were waiting on in a partial batch
+	std::lock_guard<std::mutex> lk(messageCallbacksLock);
+	for(auto& cb : batchMessageCallbacks)
+		cb.second.flush();
 }
 
 bool Communication::close() {
@@ -71,12 +91,16 @@ bool Communication::sendPacket(std::vector<uint8_t>& bytes) {
 	return rawWrite(bytes);
 }
 
+bool Communication::sendPacket(EncodeBuffer& bytes) {
+	return rawWrite(bytes.data(), bytes.size());
+}
+
 bool Communication::sendCommand(Command cmd, std::vector<uint8_t> arguments) {
-	std::vector<uint8_t> packet;
-	if(!encoder->encode(*packetizer, packet, cmd, arguments))
+	auto packet = encodeBuffers.acquire();
+	if(!encoder->encode(*packetizer, *packet, cmd, std::move(arguments)))
 		return false;
 
-	return sendPacket(packet);
+	return sendPacket(*packet);
 }
 
 bool Communication::sendCommand(ExtendedCommand cmd, std::vector<uint8_t> arguments) {
@@ -196,13 +220,33 @@ std::shared_ptr<LogicalDiskInfoMessage> Communication::getLogicalDiskInfoSync(st
 int Communication::addMessageCallback(const MessageCallback& cb) {
 	std::lock_guard<std::mutex> lk(messageCallbacksLock);
 	messageCallbacks.insert(std::make_pair(messageCallbackIDCounter, cb));
+	updateSubscriptions();
 	return messageCallbackIDCounter++;
 }
 
-bool Communication::removeMessageCallback(int id) {
+int Communication::addMessageCallback(const BatchMessageCallback& cb) {
 	std::lock_guard<std::mutex> lk(messageCallbacksLock);
+	batchMessageCallbacks.insert(std::make_pair(messageCallbackIDCounter, cb));
+	updateSubscriptions();
+	return messageCallbackIDCounter++;
+}
+
+bool Communication::removeMessageCallback(int id) {
+	std::unique_lock<std::mutex> lk(messageCallbacksLock);
 	try {
-		messageCallbacks.erase(id);
+		auto it = messageCallbacks.find(id);
+		if(it == messageCallbacks.end()) {
+			batchMessageCallbacks.erase(id);
+			updateSubscriptions();
+			return true;
+		}
+		const MessageCallback cb = it->second;
+		messageCallbacks.erase(it);
+		updateSubscriptions();
+		lk.unlock();
+
+		// Done outside of the lock, as an asynchronous callback may be waiting on it
+		cb.stopAsync();
 		return true;
 	} catch(...) {
 		report(APIEvent::Type::Unknown, APIEvent::Severity::Error);
@@ -210,6 +254,49 @@ bool Communication::removeMessageCallback(int id) {
 	}
 }
 
+static bool IsFrameNetworkType(Network::Type type) {
+	return type >= Network::Type::CAN && type <= Network::Type::I2C;
+}
+
+bool Communication::isSubscribed(const Network& network) const {
+	const auto netid = neonetid_t(network.getNetID());
+	if(netid >= Network::NetIDTableSize || !IsFrameNetworkType(network.getType()))
+		return true;
+	return (subscribedNetworks[netid / 64].load(std::memory_order_relaxed) >> (netid % 64)) & 1;
+}
+
+void Communication::refreshSubscriptions() {
+	std::lock_guard<std::mutex> lk(messageCallbacksLock);
+	updateSubscriptions();
+}
+
+void Communication::updateSubscriptions() {
+	std::vector<const MessageFilter*> filters;
+	filters.reserve(messageCallbacks.size() + batchMessageCallbacks.size());
+	for(const auto& cb : messageCallbacks)
+		filters.push_back(&cb.second.getFilter());
+	for(const auto& cb : batchMessageCallbacks)
+		filters.push_back(&cb.second.getFilter());
+
+	uint64_t words[SubscriptionWords] = {};
+	for(neonetid_t netid = 0; netid < Network::NetIDTableSize; netid++) {
+		const Network network(netid);
+		if(!IsFrameNetworkType(network.getType()))
+			continue;
+		for(const auto filter : filters) {
+			if(filter->mayMatchNetwork(network)) {
+				words[netid / 64] |= uint64_t(1) << (netid % 64);
+				break;
+			}
+		}
+	}
+
+	// Each word is swapped atomically, a reader may briefly see a mix of the old and new
+	// networks, which only matters for a callback being added or removed at that moment
+	for(size_t i = 0; i < SubscriptionWords; i++)
+		subscribedNetworks[i].store(words[i], std::memory_order_relaxed);
+}
+
 std::shared_ptr<Message> Communication::waitForMessageSync(std::function<bool(void)> onceWaitingDo,
 	const std::shared_ptr<MessageFilter>& f, std::chrono::milliseconds timeout) {
 	std::mutex m;
@@ -243,21 +330,102 @@ std::shared_ptr<Message> Communication::waitForMessageSync(std::function<bool(vo
 }
 
 void Communication::dispatchMessage(const std::shared_ptr<Message>& msg) {
+	// Posting to an async callback may wait for room in its queue, so it is done once we let go of
+	// the lock, otherwise the callback could never add or remove a callback to make that room
+	std::vector< std::shared_ptr<AsyncCallbackQueue> > asyncQueues;
+	{
+		std::lock_guard<std::mutex> lk(messageCallbacksLock);
+
+		// We want callbacks to be able to access errors
+		const bool downgrade = EventManager::GetInstance().isDowngradingErrorsOnCurrentThread();
+		if(downgrade)
+			EventManager::GetInstance().cancelErrorDowngradingOnCurrentThread();
+		for(auto& cb : messageCallbacks) {
+			if(closing) // We might have closed while reading or processing
+				continue;
+			if(!cb.second.isAsync())
+				cb.second.callIfMatch(msg);
+			else if(cb.second.getFilter().match(msg))
+				asyncQueues.push_back(cb.second.getAsyncQueue());
+		}
+		for(auto& cb : batchMessageCallbacks)
+			cb.second.addIfMatch(msg);
+		if(downgrade)
+			EventManager::GetInstance().downgradeErrorsOnCurrentThread();
+	}
+
+	// A callback removed meanwhile has been stopped, and its queue will ignore the message
+	for(const auto& queue : asyncQueues)
+		queue->post(msg);
+}
+
+void Communication::flushBatchMessageCallbacks(bool endOfRead) {
 	std::lock_guard<std::mutex> lk(messageCallbacksLock);
+	if(batchMessageCallbacks.empty())
+		return;
 
-	// We want callbacks to be able to access errors
 	const bool downgrade = EventManager::GetInstance().isDowngradingErrorsOnCurrentThread();
 	if(downgrade)
 		EventManager::GetInstance().cancelErrorDowngradingOnCurrentThread();
-	for(auto& cb : messageCallbacks) {
-		if(!closing) { // We might have closed while reading or processing
-			cb.second.callIfMatch(msg);
-		}
+	for(auto& cb : batchMessageCallbacks) {
+		if(endOfRead)
+			cb.second.endOfRead();
+		else
+			cb.second.flushIfExpired();
 	}
 	if(downgrade)
 		EventManager::GetInstance().downgradeErrorsOnCurrentThread();
 }
 
+Communication::PipelineStats Communication::getPipelineStats() const {
+	PipelineStats stats;
+	stats.packetizing = packetizingCounters.get();
+	stats.packetizing.queueDepth = driver->getReadQueueSize();
+	stats.decoding = decodingCounters.get();
+	if(pipelineActive && pipelineQueue)
+		stats.decoding.queueDepth = pipelineQueue->size_approx();
+	stats.overflows = pipelineOverflows;
+	return stats;
+}
+
+void Communication::resetPipelineStats() {
+	packetizingCounters.reset();
+	decodingCounters.reset();
+	pipelineOverflows = 0;
+}
+
+void Communication::StageCounters::record(size_t queueDepth, std::chrono::nanoseconds processingTime, std::chrono::nanoseconds queueLatency) {
+	processed++;
+	totalProcessingTime += processingTime.count();
+	totalQueueLatency += queueLatency.count();
+	if(queueDepth > maxQueueDepth)
+		maxQueueDepth = queueDepth;
+	if(processingTime.count() > maxProcessingTime)
+		maxProcessingTime = processingTime.count();
+	if(queueLatency.count() > maxQueueLatency)
+		maxQueueLatency = queueLatency.count();
+}
+
+void Communication::StageCounters::reset() {
+	maxQueueDepth = 0;
+	processed = 0;
+	totalProcessingTime = 0;
+	maxProcessingTime = 0;
+	totalQueueLatency = 0;
+	maxQueueLatency = 0;
+}
+
+Communication::PipelineStats::Stage Communication::StageCounters::get() const {
+	PipelineStats::Stage stage;
+	stage.maxQueueDepth = maxQueueDepth;
+	stage.processed = processed;
+	stage.totalProcessingTime = std::chrono::nanoseconds(totalProcessingTime);
+	stage.maxProcessingTime = std::chrono::nanoseconds(maxProcessingTime);
+	stage.totalQueueLatency = std::chrono::nanoseconds(totalQueueLatency);
+	stage.maxQueueLatency = std::chrono::nanoseconds(maxQueueLatency);
+	return stage;
+}
+
 void Communication::readTask() {
 	std::vector<uint8_t> readBytes;
 
@@ -266,11 +434,51 @@ void Communication::readTask() {
 	while(!closing) {
 		readBytes.clear();
 		if(driver->readWait(readBytes)) {
+			if(!pipelineActive) {
+				handleInput(*packetizer, readBytes);
+				continue;
+			}
+
+			const size_t queueDepth = readBytes.size() + driver->getReadQueueSize();
+			const auto start = std::chrono::steady_clock::now();
 			handleInput(*packetizer, readBytes);
+			packetizingCounters.record(queueDepth, std::chrono::steady_clock::now() - start, std::chrono::nanoseconds(0));
+		} else if(!pipelineActive) {
+			flushBatchMessageCallbacks(false);
 		}
 	}
 }
 
+void Communication::decodeTask() {
+	PipelinedPacket queued;
+
+	EventManager::GetInstance().downgradeErrorsOnCurrentThread();
+
+	while(!closing) {
+		if(!pipelineQueue->wait_dequeue_timed(queued, std::chrono::milliseconds(100))) {
+			flushBatchMessageCallbacks(false);
+			continue;
+		}
+
+		const size_t queueDepth = pipelineQueue->size_approx() + 1;
+		const auto start = std::chrono::steady_clock::now();
+		decodeAndDispatch(queued.packet);
+		queued.packet.reset();
+		// We no longer know where one read ended, so a batch ends when we catch up
+		if(queueDepth == 1)
+			flushBatchMessageCallbacks(true);
+		decodingCounters.record(queueDepth, std::chrono::steady_clock::now() - start, start - queued.enqueued);
+	}
+}
+
+void Communication::decodeAndDispatch(const std::shared_ptr<Packet>& packet) {
+	std::shared_ptr<Message> msg;
+	if(!decoder->decode(msg, packet))
+		return;
+
+	dispatchMessage(msg);
+}
+
 void Communication::handleInput(Packetizer& p, std::vector<uint8_t>& readBytes) {
 	if(redirectingRead) {
 		// redirectingRead is an atomic so it can be set without acquiring a mutex
@@ -289,13 +497,29 @@ void Communication::handleInput(Packetizer& p, std::vector<uint8_t>& readBytes)
 		}
 	} else {
 		if(p.input(readBytes)) {
-			for(const auto& packet : p.output()) {
-				std::shared_ptr<Message> msg;
-				if(!decoder->decode(msg, packet))
+			const auto packets = p.output();
+			receivedPackets += packets.size();
+			for(const auto& packet : packets) {
+				if(!isSubscribed(packet->network))
+					continue; // Nobody wants this traffic, skip decoding it
+
+				if(!pipelineActive) {
+					decodeAndDispatch(packet);
 					continue;
-
-				dispatchMessage(msg);
+				}
+
+				// Hand off to the decodeTask, never blocking the read
+				if(pipelineQueue->try_enqueue({ packet, std::chrono::steady_clock::now() })) {
+					pipelineOverflowing = false;
+				} else {
+					pipelineOverflows++;
+					if(!pipelineOverflowing)
+						report(APIEvent::Type::DecodeQueueOverflow, APIEvent::Severity::EventWarning);
+					pipelineOverflowing = true;
+				}
 			}
 		}
+		if(!pipelineActive)
+			flushBatchMessageCallbacks(true);
 	}
 }
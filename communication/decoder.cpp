@@ -12,6 +12,7 @@
 #include "icsneo/communication/packet/ethernetpacket.h"
 #include "icsneo/communication/packet/flexraypacket.h"
 #include "icsneo/communication/packet/iso9141packet.h"
+#include "icsneo/communication/packet/linpacket.h"
 #include "icsneo/communication/packet/versionpacket.h"
 #include "icsneo/communication/packet/ethphyregpacket.h"
 #include "icsneo/communication/packet/logicaldiskinfopacket.h"
@@ -26,281 +27,411 @@ uint64_t Decoder::GetUInt64FromLEBytes(const uint8_t* bytes) {
 	return ret;
 }
 
-bool Decoder::decode(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
-	switch(packet->network.getType()) {
-		case Network::Type::Ethernet: {
-			result = HardwareEthernetPacket::DecodeToMessage(packet->data, report);
-			if(!result) {
-				report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-				return false; // A nullptr was returned, the packet was not long enough to decode
+const Decoder::DecodeTables& Decoder::DefaultDecodeTables() {
+	static const DecodeTables defaults = []() {
+		DecodeTables tables;
+		tables.netid.resize(size_t(Network::NetID::Ethernet2) + 1);
+		for(size_t i = 0; i < tables.netid.size(); i++) {
+			const Network net(static_cast<neonetid_t>(i));
+			BuiltinDecodeFunction& fn = tables.netid[i].builtin;
+			switch(net.getType()) {
+				case Network::Type::Ethernet:
+					fn = &Decoder::decodeEthernet;
+					break;
+				case Network::Type::CAN:
+				case Network::Type::SWCAN:
+				case Network::Type::LSFTCAN:
+					fn = &Decoder::decodeCAN;
+					break;
+				case Network::Type::FlexRay:
+					fn = &Decoder::decodeFlexRay;
+					break;
+				case Network::Type::ISO9141:
+					fn = &Decoder::decodeISO9141;
+					break;
+				case Network::Type::LIN:
+					fn = &Decoder::decodeLIN;
+					break;
+				case Network::Type::Internal:
+					switch(net.getNetID()) {
+						case Network::NetID::Reset_Status: fn = &Decoder::decodeResetStatus; break;
+						case Network::NetID::Device: fn = &Decoder::decodeDevice; break;
+						case Network::NetID::DeviceStatus: fn = &Decoder::decodeDeviceStatus; break;
+						case Network::NetID::NeoMemorySDRead: fn = &Decoder::decodeNeoMemorySDRead; break;
+						case Network::NetID::FlexRayControl: fn = &Decoder::decodeFlexRayControl; break;
+						case Network::NetID::Main51: fn = &Decoder::decodeMain51; break;
+						case Network::NetID::RED_OLDFORMAT: fn = &Decoder::decodeOldFormat; break;
+						case Network::NetID::ReadSettings: fn = &Decoder::decodeReadSettings; break;
+						case Network::NetID::LogicalDiskInfo: fn = &Decoder::decodeLogicalDiskInfo; break;
+						case Network::NetID::EthPHYControl: fn = &Decoder::decodeEthPHYControl; break;
+						default: break;
+					}
+					break;
+				default:
+					break;
 			}
-
-			// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
-			// The resolution depends on the device
-			EthernetMessage& eth = *static_cast<EthernetMessage*>(result.get());
-			eth.timestamp *= timestampResolution;
-			eth.network = packet->network;
-			return true;
 		}
-		case Network::Type::CAN:
-		case Network::Type::SWCAN:
-		case Network::Type::LSFTCAN: {
-			if(packet->data.size() < 24) {
-				report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-				return false;
-			}
 
-			result = HardwareCANPacket::DecodeToMessage(packet->data);
-			if(!result) {
-				report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-				return false; // A nullptr was returned, the packet was malformed
-			}
+		tables.main51.resize(256);
+		tables.main51[uint8_t(Command::RequestSerialNumber)].builtin = &Decoder::decodeSerialNumber;
+		tables.main51[uint8_t(Command::GetMainVersion)].builtin = &Decoder::decodeMainVersion;
+		tables.main51[uint8_t(Command::GetSecondaryVersions)].builtin = &Decoder::decodeSecondaryVersions;
+		return tables;
+	}();
+	return defaults;
+}
 
-			// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
-			// The resolution depends on the device
-			result->timestamp *= timestampResolution;
+Decoder::Decoder(device_eventhandler_t report) : report(report), tables(DefaultDecodeTables()) {}
 
-			switch(result->type) {
-				case Message::Type::Frame: {
-					CANMessage& can = *static_cast<CANMessage*>(result.get());
-					can.network = packet->network;
-					break;
-				}
-				case Message::Type::CANErrorCount: {
-					CANErrorCountMessage& can = *static_cast<CANErrorCountMessage*>(result.get());
-					can.network = packet->network;
-					break;
-				}
-				default: {
-					report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-					return false; // An unknown type was returned, the packet was malformed
-				}
-			}
+void Decoder::setDecodeFunction(Network::NetID netid, DecodeFunction fn) {
+	const size_t index = size_t(netid);
+	if(index >= tables.netid.size()) {
+		if(!fn)
+			return; // Already the default
+		tables.netid.resize(index + 1);
+	}
+	tables.netid[index].custom = std::move(fn);
+}
 
-			return true;
-		}
-		case Network::Type::FlexRay: {
-			if(packet->data.size() < 24) {
-				report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-				return false;
-			}
+void Decoder::setDecodeFunction(Command main51Command, DecodeFunction fn) {
+	tables.main51[uint8_t(main51Command)].custom = std::move(fn);
+}
 
-			result = HardwareFlexRayPacket::DecodeToMessage(packet->data);
-			if(!result) {
-				report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-				return false; // A nullptr was returned, the packet was malformed
-			}
+bool Decoder::decode(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	const size_t index = size_t(packet->network.getNetID());
+	if(index < tables.netid.size()) {
+		const DecodeEntry& entry = tables.netid[index];
+		if(entry.custom)
+			return entry.custom(*this, result, packet);
+		if(entry.builtin)
+			return (this->*entry.builtin)(result, packet);
+	}
 
-			// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
-			// The resolution depends on the device
-			FlexRayMessage& fr = *static_cast<FlexRayMessage*>(result.get());
-			fr.timestamp *= timestampResolution;
-			fr.network = packet->network;
-			return true;
-		}
-		case Network::Type::ISO9141: {
-			if(packet->data.size() < sizeof(HardwareISO9141Packet)) {
-				report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-				return false;
-			}
+	// For the moment other types of messages will automatically be decoded as raw messages
+	result = std::make_shared<RawMessage>(packet->network, packet->data);
+	return true;
+}
 
-			result = iso9141decoder.decodeToMessage(packet->data);
-			if(!result)
-				return false; // A nullptr was returned, more data is required to decode this packet
+bool Decoder::decodeDefault(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	const size_t index = size_t(packet->network.getNetID());
+	const auto& defaults = DefaultDecodeTables().netid;
+	if(index < defaults.size() && defaults[index].builtin)
+		return (this->*defaults[index].builtin)(result, packet);
 
-			// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
-			// The resolution depends on the device
-			ISO9141Message& iso = *static_cast<ISO9141Message*>(result.get());
-			iso.timestamp *= timestampResolution;
-			iso.network = packet->network;
-			return true;
-		}
-		case Network::Type::Internal: {
-			switch(packet->network.getNetID()) {
-				case Network::NetID::Reset_Status: {
-					// We can deal with not having the last two fields (voltage and temperature)
-					if(packet->data.size() < (sizeof(HardwareResetStatusPacket) - (sizeof(uint16_t) * 2))) {
-						report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-						return false;
-					}
+	result = std::make_shared<RawMessage>(packet->network, packet->data);
+	return true;
+}
 
-					HardwareResetStatusPacket* data = (HardwareResetStatusPacket*)packet->data.data();
-					auto msg = std::make_shared<ResetStatusMessage>();
-					msg->mainLoopTime = data->main_loop_time_25ns * 25;
-					msg->maxMainLoopTime = data->max_main_loop_time_25ns * 25;
-					msg->justReset = data->status.just_reset;
-					msg->comEnabled = data->status.com_enabled;
-					msg->cmRunning = data->status.cm_is_running;
-					msg->cmChecksumFailed = data->status.cm_checksum_failed;
-					msg->cmLicenseFailed = data->status.cm_license_failed;
-					msg->cmVersionMismatch = data->status.cm_version_mismatch;
-					msg->cmBootOff = data->status.cm_boot_off;
-					msg->hardwareFailure = data->status.hardware_failure;
-					msg->usbComEnabled = data->status.usbComEnabled;
-					msg->linuxComEnabled = data->status.linuxComEnabled;
-					msg->cmTooBig = data->status.cm_too_big;
-					msg->hidUsbState = data->status.hidUsbState;
-					msg->fpgaUsbState = data->status.fpgaUsbState;
-					if(packet->data.size() >= sizeof(HardwareResetStatusPacket)) {
-						msg->busVoltage = data->busVoltage;
-						msg->deviceTemperature = data->deviceTemperature;
-					}
-					result = msg;
-					return true;
-				}
-				case Network::NetID::Device: {
-					// These are neoVI network messages
-					// They come in as CAN but we will handle them in the device rather than
-					// passing them onto the user.
-					if(packet->data.size() < 24) {
-						auto rawmsg = std::make_shared<RawMessage>(Network::NetID::Device);
-						result = rawmsg;
-						rawmsg->data = packet->data;
-						return true;
-					}
+bool Decoder::decodeEthernet(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	result = HardwareEthernetPacket::DecodeToMessage(packet->data, report);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false; // A nullptr was returned, the packet was not long enough to decode
+	}
 
-					result = HardwareCANPacket::DecodeToMessage(packet->data);
-					if(!result) {
-						report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-						return false; // A nullptr was returned, the packet was malformed
-					}
+	// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
+	// The resolution depends on the device
+	EthernetMessage& eth = *static_cast<EthernetMessage*>(result.get());
+	eth.timestamp *= timestampResolution;
+	eth.network = packet->network;
+	return true;
+}
 
-					// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
-					// The resolution depends on the device
-					auto* raw = dynamic_cast<RawMessage*>(result.get());
-					if(raw == nullptr) {
-						report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-						return false; // A nullptr was returned, the packet was malformed
-					}
-					raw->timestamp *= timestampResolution;
-					raw->network = packet->network;
-					return true;
-				}
-				case Network::NetID::DeviceStatus: {
-					// Just pass along the data, the device needs to handle this itself
-					result = std::make_shared<RawMessage>(packet->network, packet->data);
-					return true;
-				}
-				case Network::NetID::NeoMemorySDRead: {
-					if(packet->data.size() != 512 + sizeof(uint32_t)) {
-						report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-						return false; // Should get enough data for a start address and sector
-					}
+bool Decoder::decodeCAN(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	if(packet->data.size() < 24) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
 
-					const auto msg = std::make_shared<NeoReadMemorySDMessage>();
-					result = msg;
-					msg->startAddress = *reinterpret_cast<uint32_t*>(packet->data.data());
-					msg->data.insert(msg->data.end(), packet->data.begin() + 4, packet->data.end());
-					return true;
-				}
-				case Network::NetID::FlexRayControl: {
-					auto frResult = std::make_shared<FlexRayControlMessage>(*packet);
-					if(!frResult->decoded) {
-						report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-						return false;
-					}
-					result = frResult;
-					return true;
-				}
-				case Network::NetID::Main51: {
-					switch((Command)packet->data[0]) {
-						case Command::RequestSerialNumber: {
-							auto msg = std::make_shared<SerialNumberMessage>();
-							uint64_t serial = GetUInt64FromLEBytes(packet->data.data() + 1);
-							// The device sends 64-bits of serial number, but we never use more than 32-bits.
-							msg->deviceSerial = Device::SerialNumToString((uint32_t)serial);
-							msg->hasMacAddress = packet->data.size() >= 15;
-							if(msg->hasMacAddress)
-								memcpy(msg->macAddress, packet->data.data() + 9, sizeof(msg->macAddress));
-							msg->hasPCBSerial = packet->data.size() >= 31;
-							if(msg->hasPCBSerial)
-								memcpy(msg->pcbSerial, packet->data.data() + 15, sizeof(msg->pcbSerial));
-							result = msg;
-							return true;
-						}
-						case Command::GetMainVersion: {
-							result = HardwareVersionPacket::DecodeMainToMessage(packet->data);
-							if(!result) {
-								report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-								return false;
-							}
-
-							return true;
-						}
-						case Command::GetSecondaryVersions: {
-							result = HardwareVersionPacket::DecodeSecondaryToMessage(packet->data);
-							if(!result) {
-								report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-								return false;
-							}
-
-							return true;
-						}
-						default:
-							auto msg = std::make_shared<Main51Message>();
-							msg->command = Command(packet->data[0]);
-							msg->data.insert(msg->data.begin(), packet->data.begin() + 1, packet->data.end());
-							result = msg;
-							return true;
-					}
-				}
-				case Network::NetID::RED_OLDFORMAT: {
-					/* So-called "old format" messages are a "new style, long format" wrapper around the old short messages.
-					 * They consist of a 16-bit LE length first, then the 8-bit length and netid combo byte, then the payload
-					 * with no checksum. The upper-nibble length of the combo byte should be ignored completely, using the
-					 * length from the first two bytes in its place. Ideally, we never actually send the oldformat messages
-					 * out to the rest of the application as they can recursively get decoded to another message type here.
-					 * Feed the result back into the decoder in case we do something special with the resultant netid.
-					 */
-					uint16_t length = packet->data[0] | (packet->data[1] << 8);
-					packet->network = Network(packet->data[2] & 0xF);
-					packet->data.erase(packet->data.begin(), packet->data.begin() + 3);
-					if(packet->data.size() != length)
-						packet->data.resize(length);
-					return decode(result, packet);
-				}
-				case Network::NetID::ReadSettings: {
-					auto msg = std::make_shared<ReadSettingsMessage>();
-					msg->response = ReadSettingsMessage::Response(packet->data[0]);
-
-					if(msg->response == ReadSettingsMessage::Response::OK) {
-						// The global settings structure is the payload of the message in this case
-						msg->data.insert(msg->data.begin(), packet->data.begin() + 10, packet->data.end());
-						uint16_t resp_len = msg->data[8] | (msg->data[9] << 8);
-						if(msg->data.size() - 1 == resp_len) // There is a padding byte at the end
-							msg->data.pop_back();
-						result = msg;
-						return true;
-					}
+	result = HardwareCANPacket::DecodeToMessage(packet->data);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false; // A nullptr was returned, the packet was malformed
+	}
 
-					// We did not get a successful response, so the payload is all of the data
-					msg->data.insert(msg->data.begin(), packet->data.begin(), packet->data.end());
-					result = msg;
-					return true;
-				}
-				case Network::NetID::LogicalDiskInfo: {
-					result = LogicalDiskInfoPacket::DecodeToMessage(packet->data);
-					if(!result) {
-						report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::EventWarning);
-						return false;
-					}
-					return true;
-				}
-				case Network::NetID::EthPHYControl: {
-					result = HardwareEthernetPhyRegisterPacket::DecodeToMessage(packet->data, report);
-					if(!result) {
-						report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::EventWarning);
-						return false;
-					}
-					return true;
-				}
-				default:
-					break;
-			}
+	// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
+	// The resolution depends on the device
+	result->timestamp *= timestampResolution;
+
+	switch(result->type) {
+		case Message::Type::Frame: {
+			CANMessage& can = *static_cast<CANMessage*>(result.get());
+			can.network = packet->network;
+			break;
+		}
+		case Message::Type::CANErrorCount: {
+			CANErrorCountMessage& can = *static_cast<CANErrorCountMessage*>(result.get());
+			can.network = packet->network;
+			break;
+		}
+		default: {
+			report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+			return false; // An unknown type was returned, the packet was malformed
 		}
 	}
 
-	// For the moment other types of messages will automatically be decoded as raw messages
+	return true;
+}
+
+bool Decoder::decodeFlexRay(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	if(packet->data.size() < 24) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	result = HardwareFlexRayPacket::DecodeToMessage(packet->data);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false; // A nullptr was returned, the packet was malformed
+	}
+
+	// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
+	// The resolution depends on the device
+	FlexRayMessage& fr = *static_cast<FlexRayMessage*>(result.get());
+	fr.timestamp *= timestampResolution;
+	fr.network = packet->network;
+	return true;
+}
+
+bool Decoder::decodeISO9141(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	if(packet->data.size() < sizeof(HardwareISO9141Packet)) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	result = iso9141decoder.decodeToMessage(packet->data);
+	if(!result)
+		return false; // A nullptr was returned, more data is required to decode this packet
+
+	// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
+	// The resolution depends on the device
+	ISO9141Message& iso = *static_cast<ISO9141Message*>(result.get());
+	iso.timestamp *= timestampResolution;
+	iso.network = packet->network;
+	return true;
+}
+
+bool Decoder::decodeLIN(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	if(!decodeLINMessages) {
+		result = std::make_shared<RawMessage>(packet->network, packet->data);
+		return true;
+	}
+
+	auto lin = HardwareLINPacket::DecodeToMessage(packet->data);
+	if(!lin) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false; // A nullptr was returned, the packet was not long enough to decode
+	}
+
+	// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
+	// The resolution depends on the device
+	lin->timestamp *= timestampResolution;
+	lin->network = packet->network;
+	result = std::move(lin);
+	return true;
+}
+
+bool Decoder::decodeResetStatus(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	// We can deal with not having the last two fields (voltage and temperature)
+	if(packet->data.size() < (sizeof(HardwareResetStatusPacket) - (sizeof(uint16_t) * 2))) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	HardwareResetStatusPacket* data = (HardwareResetStatusPacket*)packet->data.data();
+	auto msg = std::make_shared<ResetStatusMessage>();
+	msg->mainLoopTime = data->main_loop_time_25ns * 25;
+	msg->maxMainLoopTime = data->max_main_loop_time_25ns * 25;
+	msg->justReset = data->status.just_reset;
+	msg->comEnabled = data->status.com_enabled;
+	msg->cmRunning = data->status.cm_is_running;
+	msg->cmChecksumFailed = data->status.cm_checksum_failed;
+	msg->cmLicenseFailed = data->status.cm_license_failed;
+	msg->cmVersionMismatch = data->status.cm_version_mismatch;
+	msg->cmBootOff = data->status.cm_boot_off;
+	msg->hardwareFailure = data->status.hardware_failure;
+	msg->usbComEnabled = data->status.usbComEnabled;
+	msg->linuxComEnabled = data->status.linuxComEnabled;
+	msg->cmTooBig = data->status.cm_too_big;
+	msg->hidUsbState = data->status.hidUsbState;
+	msg->fpgaUsbState = data->status.fpgaUsbState;
+	if(packet->data.size() >= sizeof(HardwareResetStatusPacket)) {
+		msg->busVoltage = data->busVoltage;
+		msg->deviceTemperature = data->deviceTemperature;
+	}
+	result = msg;
+	return true;
+}
+
+bool Decoder::decodeDevice(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	// These are neoVI network messages
+	// They come in as CAN but we will handle them in the device rather than
+	// passing them onto the user.
+	if(packet->data.size() < 24) {
+		auto rawmsg = std::make_shared<RawMessage>(Network::NetID::Device);
+		result = rawmsg;
+		rawmsg->data = packet->data;
+		return true;
+	}
+
+	result = HardwareCANPacket::DecodeToMessage(packet->data);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false; // A nullptr was returned, the packet was malformed
+	}
+
+	// Timestamps are in (resolution) ns increments since 1/1/2007 GMT 00:00:00.0000
+	// The resolution depends on the device
+	auto* raw = dynamic_cast<RawMessage*>(result.get());
+	if(raw == nullptr) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false; // A nullptr was returned, the packet was malformed
+	}
+	raw->timestamp *= timestampResolution;
+	raw->network = packet->network;
+	return true;
+}
+
+bool Decoder::decodeDeviceStatus(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	// Just pass along the data, the device needs to handle this itself
 	result = std::make_shared<RawMessage>(packet->network, packet->data);
 	return true;
-}
\ No newline at end of file
+}
+
+bool Decoder::decodeNeoMemorySDRead(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	if(packet->data.size() != 512 + sizeof(uint32_t)) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false; // Should get enough data for a start address and sector
+	}
+
+	const auto msg = std::make_shared<NeoReadMemorySDMessage>();
+	result = msg;
+	msg->startAddress = *reinterpret_cast<uint32_t*>(packet->data.data());
+	msg->data.insert(msg->data.end(), packet->data.begin() + 4, packet->data.end());
+	return true;
+}
+
+bool Decoder::decodeFlexRayControl(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	auto frResult = std::make_shared<FlexRayControlMessage>(*packet);
+	if(!frResult->decoded) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+	result = frResult;
+	return true;
+}
+
+bool Decoder::decodeMain51(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	if(packet->data.empty()) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	const DecodeEntry& entry = tables.main51[packet->data[0]];
+	if(entry.custom)
+		return entry.custom(*this, result, packet);
+	if(entry.builtin)
+		return (this->*entry.builtin)(result, packet);
+
+	auto msg = std::make_shared<Main51Message>();
+	msg->command = Command(packet->data[0]);
+	msg->data.insert(msg->data.begin(), packet->data.begin() + 1, packet->data.end());
+	result = msg;
+	return true;
+}
+
+bool Decoder::decodeSerialNumber(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	auto msg = std::make_shared<SerialNumberMessage>();
+	uint64_t serial = GetUInt64FromLEBytes(packet->data.data() + 1);
+	// The device sends 64-bits of serial number, but we never use more than 32-bits.
+	msg->deviceSerial = Device::SerialNumToString((uint32_t)serial);
+	msg->hasMacAddress = packet->data.size() >= 15;
+	if(msg->hasMacAddress)
+		memcpy(msg->macAddress, packet->data.data() + 9, sizeof(msg->macAddress));
+	msg->hasPCBSerial = packet->data.size() >= 31;
+	if(msg->hasPCBSerial)
+		memcpy(msg->pcbSerial, packet->data.data() + 15, sizeof(msg->pcbSerial));
+	result = msg;
+	return true;
+}
+
+bool Decoder::decodeMainVersion(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	result = HardwareVersionPacket::DecodeMainToMessage(packet->data);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	return true;
+}
+
+bool Decoder::decodeSecondaryVersions(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	result = HardwareVersionPacket::DecodeSecondaryToMessage(packet->data);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	return true;
+}
+
+bool Decoder::decodeOldFormat(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	/* So-called "old format" messages are a "new style, long format" wrapper around the old short messages.
+	 * They consist of a 16-bit LE length first, then the 8-bit length and netid combo byte, then the payload
+	 * with no checksum. The upper-nibble length of the combo byte should be ignored completely, using the
+	 * length from the first two bytes in its place. Ideally, we never actually send the oldformat messages
+	 * out to the rest of the application as they can recursively get decoded to another message type here.
+	 * Feed the result back into the decoder in case we do something special with the resultant netid.
+	 *
+	 * The Packetizer unwraps these as it reads them, so this is only reached for packets from elsewhere.
+	 */
+	if(packet->data.size() < 3) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	uint16_t length = packet->data[0] | (packet->data[1] << 8);
+	packet->network = Network(packet->data[2] & 0xF);
+	packet->data.erase(packet->data.begin(), packet->data.begin() + 3);
+	if(packet->data.size() != length)
+		packet->data.resize(length);
+	return decode(result, packet);
+}
+
+bool Decoder::decodeReadSettings(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	auto msg = std::make_shared<ReadSettingsMessage>();
+	msg->response = ReadSettingsMessage::Response(packet->data[0]);
+
+	if(msg->response == ReadSettingsMessage::Response::OK) {
+		// The global settings structure is the payload of the message in this case
+		msg->data.insert(msg->data.begin(), packet->data.begin() + 10, packet->data.end());
+		uint16_t resp_len = msg->data[8] | (msg->data[9] << 8);
+		if(msg->data.size() - 1 == resp_len) // There is a padding byte at the end
+			msg->data.pop_back();
+		result = msg;
+		return true;
+	}
+
+	// We did not get a successful response, so the payload is all of the data
+	msg->data.insert(msg->data.begin(), packet->data.begin(), packet->data.end());
+	result = msg;
+	return true;
+}
+
+bool Decoder::decodeLogicalDiskInfo(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	result = LogicalDiskInfoPacket::DecodeToMessage(packet->data);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::EventWarning);
+		return false;
+	}
+	return true;
+}
+
+bool Decoder::decodeEthPHYControl(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+	result = HardwareEthernetPhyRegisterPacket::DecodeToMessage(packet->data, report);
+	if(!result) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::EventWarning);
+		return false;
+	}
+	return true;
+}
@@ -56,7 +56,7 @@ bool Driver::readWait(std::vector<uint8_t>& bytes, std::chrono::milliseconds tim
 	return actuallyRead > 0;
 }
 
-bool Driver::write(const std::vector<uint8_t>& bytes) {
+bool Driver::write(const uint8_t* bytes, size_t size) {
 	if(!isOpen()) {
 		report(APIEvent::Type::DeviceCurrentlyClosed, APIEvent::Severity::Error);
 		return false;
@@ -74,7 +74,7 @@ bool Driver::write(const std::vector<uint8_t>& bytes) {
 		}
 	}
 
-	const bool ret = writeInternal(bytes);
+	const bool ret = writeInternal(bytes, size);
 	if(!ret)
 		report(APIEvent::Type::Unknown, APIEvent::Severity::Error);
 
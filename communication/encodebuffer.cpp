@@ -0,0 +1,47 @@
+#include "icsneo/communication/encodebuffer.h"
+
+using namespace icsneo;
+
+// 1 byte for the packetizer, 5 for the long format header, 3 for the multichannel header
+const size_t EncodeBuffer::DefaultHeadroom = 16;
+
+const size_t EncodeBufferPool::MaxPooledBuffers = 8;
+const size_t EncodeBufferPool::MaxPooledCapacity = 64 * 1024;
+
+void EncodeBufferPool::Releaser::operator()(EncodeBuffer* buffer) const {
+	if(pool)
+		pool->release(buffer);
+	else
+		delete buffer;
+}
+
+EncodeBufferPool::Lease EncodeBufferPool::acquire() {
+	std::unique_ptr<EncodeBuffer> buffer;
+	{
+		std::lock_guard<std::mutex> lk(mutex);
+		if(!buffers.empty()) {
+			buffer = std::move(buffers.back());
+			buffers.pop_back();
+		}
+	}
+	if(buffer)
+		buffer->clear();
+	else
+		buffer.reset(new EncodeBuffer());
+	return Lease(buffer.release(), Releaser(this));
+}
+
+size_t EncodeBufferPool::getPooledCount() const {
+	std::lock_guard<std::mutex> lk(mutex);
+	return buffers.size();
+}
+
+void EncodeBufferPool::release(EncodeBuffer* buffer) {
+	std::unique_ptr<EncodeBuffer> owned(buffer);
+	if(owned->getStorage().capacity() > MaxPooledCapacity)
+		return;
+
+	std::lock_guard<std::mutex> lk(mutex);
+	if(buffers.size() < MaxPooledBuffers)
+		buffers.push_back(std::move(owned));
+}
@@ -4,23 +4,30 @@
 #include "icsneo/communication/packet/ethernetpacket.h"
 #include "icsneo/communication/packet/iso9141packet.h"
 #include "icsneo/communication/packet/canpacket.h"
+#include "icsneo/communication/packet/flexraypacket.h"
+#include "icsneo/communication/packet/linpacket.h"
 #include "icsneo/communication/packet/ethphyregpacket.h"
 #include "icsneo/communication/message/ethphymessage.h"
+#include <algorithm>
 
 using namespace icsneo;
 
 bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result, const std::shared_ptr<Message>& message) {
+	EncodeBuffer buffer;
+	if(!encode(packetizer, buffer, message))
+		return false;
+	result = buffer.toVector();
+	return true;
+}
+
+bool Encoder::encode(const Packetizer& packetizer, EncodeBuffer& result, const std::shared_ptr<Message>& message) {
 	bool shortFormat = false;
-	std::vector<uint8_t>* buffer = &result;
 	uint16_t netid = 0;
 	result.clear();
 
 	switch(message->type) {
 		case Message::Type::Frame: {
 			auto frame = std::dynamic_pointer_cast<Frame>(message);
-
-			// Frame uses frame->data as the buffer unless directed otherwise
-			buffer = &frame->data;
 			netid = uint16_t(frame->network.getNetID());
 
 			switch(frame->network.getType()) {
@@ -31,8 +38,7 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 						return false; // The message was not a properly formed EthernetMessage
 					}
 
-					buffer = &result;
-					if(!HardwareEthernetPacket::EncodeFromMessage(*ethmsg, result, report))
+					if(!HardwareEthernetPacket::EncodeFromMessage(*ethmsg, result.getStorage(), report))
 						return false;
 
 					break;
@@ -51,12 +57,40 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 						return false; // This device does not support CAN FD
 					}
 
-					buffer = &result;
-					if(!HardwareCANPacket::EncodeFromMessage(*canmsg, result, report))
+					if(!HardwareCANPacket::EncodeFromMessage(*canmsg, result.getStorage(), report))
 						return false; // The CANMessage was malformed
 
 					break;
 				} // End of Network::Type::CAN
+				case Network::Type::FlexRay: {
+					auto frmsg = std::dynamic_pointer_cast<FlexRayMessage>(message);
+					if(!frmsg) {
+						report(APIEvent::Type::MessageFormattingError, APIEvent::Severity::Error);
+						return false; // The message was not a properly formed FlexRayMessage
+					}
+
+					if(!HardwareFlexRayPacket::EncodeFromMessage(*frmsg, result.getStorage(), report))
+						return false;
+
+					break;
+				} // End of Network::Type::FlexRay
+				case Network::Type::LIN: {
+					if(!encodeLINMessages) {
+						report(APIEvent::Type::UnexpectedNetworkType, APIEvent::Severity::Error);
+						return false;
+					}
+
+					auto linmsg = std::dynamic_pointer_cast<LINMessage>(message);
+					if(!linmsg) {
+						report(APIEvent::Type::MessageFormattingError, APIEvent::Severity::Error);
+						return false; // The message was not a properly formed LINMessage
+					}
+
+					if(!HardwareLINPacket::EncodeFromMessage(*linmsg, result.getStorage(), report))
+						return false;
+
+					break;
+				} // End of Network::Type::LIN
 				case Network::Type::ISO9141: {
 					auto isomsg = std::dynamic_pointer_cast<ISO9141Message>(message);
 					if(!isomsg) {
@@ -65,8 +99,12 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 					}
 
 					// Skip the normal message wrapping at the bottom since we need to send multiple
-					// packets to the device. This function just encodes them back to back into `result`
-					return HardwareISO9141Packet::EncodeFromMessage(*isomsg, result, report, packetizer);
+					// packets to the device. This function just encodes them back to back into `packets`
+					std::vector<uint8_t> packets;
+					if(!HardwareISO9141Packet::EncodeFromMessage(*isomsg, packets, report, packetizer))
+						return false;
+					result.append(packets);
+					return true;
 				} // End of Network::Type::ISO9141
 				default:
 					report(APIEvent::Type::UnexpectedNetworkType, APIEvent::Severity::Error);
@@ -77,9 +115,7 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 		}
 		case Message::Type::RawMessage: {
 			auto raw = std::dynamic_pointer_cast<RawMessage>(message);
-
-			// Raw message uses raw->data as the buffer unless directed otherwise
-			buffer = &raw->data;
+			result.append(raw->data);
 			netid = uint16_t(raw->network.getNetID());
 
 			switch(raw->network.getNetID()) {
@@ -90,7 +126,7 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 					// See the decoder for an explanation
 					// We expect the network byte to be populated already in data, but not the length
 					uint16_t length = uint16_t(raw->data.size()) - 1;
-					raw->data.insert(raw->data.begin(), {(uint8_t)length, (uint8_t)(length >> 8)});
+					result.prepend({(uint8_t)length, (uint8_t)(length >> 8)});
 					break;
 				}
 				default:
@@ -106,7 +142,7 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 				return false; // The message was not a properly formed Main51Message
 			}
 
-			buffer = &m51msg->data;
+			result.append(m51msg->data);
 			netid = uint16_t(Network::NetID::Main51);
 
 			if(!m51msg->forceShortFormat) {
@@ -116,16 +152,16 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 				uint16_t size = uint16_t(m51msg->data.size()) + 1 + 1 + 2;
 				size += 1; // Even though we are not including the NetID bytes, the device expects them to be counted in the length
 				size += 1; // Main51 Command
-				m51msg->data.insert(m51msg->data.begin(), {
+				result.prepend({
 					(uint8_t)Network::NetID::Main51, // 0x0B for long message
 					(uint8_t)size, // Size, little endian 16-bit
 					(uint8_t)(size >> 8),
 					(uint8_t)m51msg->command
 				});
-				result = packetizer.packetWrap(m51msg->data, shortFormat);
+				packetizer.packetWrap(result, shortFormat);
 				return true;
 			} else {
-				m51msg->data.insert(m51msg->data.begin(), { uint8_t(m51msg->command) });
+				result.prepend({ uint8_t(m51msg->command) });
 				shortFormat = true;
 			}
 			break;
@@ -140,7 +176,7 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 				report(APIEvent::Type::MessageFormattingError, APIEvent::Severity::Error);
 				return false;
 			}
-			if(!HardwareEthernetPhyRegisterPacket::EncodeFromMessage(*ethPhyMessage, result, report))
+			if(!HardwareEthernetPhyRegisterPacket::EncodeFromMessage(*ethPhyMessage, result.getStorage(), report))
 				return false;
 			break;
 		}
@@ -149,13 +185,13 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 
 	// Early returns may mean we don't reach this far, check the type you're concerned with
 	if(shortFormat) {
-		buffer->insert(buffer->begin(), (uint8_t(buffer->size()) << 4) | uint8_t(netid));
+		result.prepend({ uint8_t((uint8_t(result.size()) << 4) | uint8_t(netid)) });
 	} else {
 		// Size for the host-to-device long format is the size of the entire packet + 1
 		// So +1 for AA header, +1 for short format header, +2 for long format size, and +2 for long format NetID
 		// Then an extra +1, due to a firmware idiosyncrasy
-		uint16_t size = uint16_t(buffer->size()) + 1 + 1 + 2 + 2 + 1;
-		buffer->insert(buffer->begin(), {
+		uint16_t size = uint16_t(result.size()) + 1 + 1 + 2 + 2 + 1;
+		result.prepend({
 			(uint8_t)Network::NetID::RED, // 0x0C for long message
 			(uint8_t)size, // Size, little endian 16-bit
 			(uint8_t)(size >> 8),
@@ -164,11 +200,64 @@ bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result,
 		});
 	}
 
-	result = packetizer.packetWrap(*buffer, shortFormat);
+	packetizer.packetWrap(result, shortFormat);
 	return true;
 }
 
+std::shared_ptr<PreparedFrame> Encoder::prepare(const Packetizer& packetizer, const std::shared_ptr<Frame>& frame) {
+	// Frames are sent in the long format, so the payload comes after
+	// the packetizer's 0xAA, the long format header, and the packet header
+	size_t dataOffset = 1 + 5;
+	switch(frame->network.getType()) {
+		case Network::Type::CAN:
+		case Network::Type::SWCAN:
+		case Network::Type::LSFTCAN: {
+			auto canmsg = std::dynamic_pointer_cast<CANMessage>(frame);
+			if(!canmsg)
+				break;
+			// Length and NetID, Description ID, ArbID, then status and DLC
+			dataOffset += 1 + 2 + (canmsg->isExtended ? 4 : 2) + (canmsg->isCANFD ? 2 : 1);
+			break;
+		}
+		case Network::Type::Ethernet: {
+			auto ethmsg = std::dynamic_pointer_cast<EthernetMessage>(frame);
+			if(!ethmsg)
+				break;
+			// Padded size and Description ID, then the preemption flags if enabled
+			dataOffset += 4 + (ethmsg->preemptionEnabled ? 1 : 0);
+			break;
+		}
+		default:
+			report(APIEvent::Type::PreparedTransmitNotSupported, APIEvent::Severity::Error);
+			return nullptr;
+	}
+
+	std::shared_ptr<PreparedFrame> prepared(new PreparedFrame());
+	if(!encode(packetizer, prepared->packet, frame))
+		return nullptr;
+
+	// The payload must be where we expect it, otherwise setData() would corrupt the packet
+	if(prepared->packet.size() < dataOffset + frame->data.size() ||
+		!std::equal(frame->data.begin(), frame->data.end(), prepared->packet.begin() + dataOffset)) {
+		report(APIEvent::Type::PreparedTransmitNotSupported, APIEvent::Severity::Error);
+		return nullptr;
+	}
+
+	prepared->frame = frame;
+	prepared->dataOffset = dataOffset;
+	prepared->dataSize = frame->data.size();
+	return prepared;
+}
+
 bool Encoder::encode(const Packetizer& packetizer, std::vector<uint8_t>& result, Command cmd, std::vector<uint8_t> arguments) {
+	EncodeBuffer buffer;
+	if(!encode(packetizer, buffer, cmd, std::move(arguments)))
+		return false;
+	result = buffer.toVector();
+	return true;
+}
+
+bool Encoder::encode(const Packetizer& packetizer, EncodeBuffer& result, Command cmd, std::vector<uint8_t> arguments) {
 	std::shared_ptr<Message> msg;
 	if(cmd == Command::UpdateLEDState) {
 		/* NetID::Device is a super old command type.
@@ -7,9 +7,25 @@
 
 using namespace icsneo;
 
-const size_t EthernetPacketizer::MaxPacketLength = 1490; // MTU - overhead
+const size_t EthernetPacketizer::HeaderLength = 10;
+const size_t EthernetPacketizer::StandardMTU = 1500;
+const size_t EthernetPacketizer::MaxMTU = 9000;
+const size_t EthernetPacketizer::DefaultMaxPacketLength = StandardMTU - HeaderLength;
 static const uint8_t BROADCAST_MAC[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
 
+size_t EthernetPacketizer::MaxPacketLengthForMTU(size_t mtu) {
+	if(mtu <= HeaderLength || mtu > MaxMTU)
+		return 0;
+	return mtu - HeaderLength;
+}
+
+bool EthernetPacketizer::setMaxPacketLength(size_t length) {
+	if(length == 0 || length > MaxPacketLengthForMTU(MaxMTU))
+		return false;
+	maxPacketLength = length;
+	return true;
+}
+
 EthernetPacketizer::EthernetPacket& EthernetPacketizer::newSendPacket(bool first) {
 	processedDownPackets.emplace_back();
 	EthernetPacket& ret = processedDownPackets.back();
@@ -31,7 +47,7 @@ void EthernetPacketizer::inputDown(std::vector<uint8_t> bytes, bool first) {
 	EthernetPacket* sendPacket = nullptr;
 	if(first && !processedDownPackets.empty()) {
 		// We have some packets already, let's see if we can add this to the last one
-		if(processedDownPackets.back().payload.size() + bytes.size() <= MaxPacketLength)
+		if(processedDownPackets.back().payload.size() + bytes.size() <= maxPacketLength)
 			sendPacket = &processedDownPackets.back();
 	}
 
@@ -45,9 +61,9 @@ void EthernetPacketizer::inputDown(std::vector<uint8_t> bytes, bool first) {
 
 	// Split packets larger than MTU
 	std::vector<uint8_t> extraData;
-	if(sendPacket->payload.size() > MaxPacketLength) {
-		extraData.insert(extraData.end(), sendPacket->payload.begin() + MaxPacketLength, sendPacket->payload.end());
-		sendPacket->payload.resize(MaxPacketLength);
+	if(sendPacket->payload.size() > maxPacketLength) {
+		extraData.insert(extraData.end(), sendPacket->payload.begin() + maxPacketLength, sendPacket->payload.end());
+		sendPacket->payload.resize(maxPacketLength);
 		sendPacket->lastPiece = false;
 		inputDown(std::move(extraData), false);
 	}
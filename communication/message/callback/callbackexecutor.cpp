@@ -0,0 +1,138 @@
+#include "icsneo/communication/message/callback/callbackexecutor.h"
+#include "icsneo/communication/message/callback/messagecallback.h"
+
+using namespace icsneo;
+
+const size_t MessageCallback::DefaultAsyncQueueSize = 4096;
+
+const size_t CallbackExecutor::MaxMessagesPerTurn = 64;
+
+CallbackExecutor::CallbackExecutor(size_t threadCount) : workers(std::make_shared<Workers>()) {
+	if(threadCount == 0)
+		threadCount = 1;
+	for(size_t i = 0; i < threadCount; i++)
+		threads.emplace_back(&Workers::Run, workers);
+}
+
+CallbackExecutor::~CallbackExecutor() {
+	{
+		std::lock_guard<std::mutex> lk(workers->mutex);
+		workers->stopping = true;
+		workers->ready.clear();
+	}
+	workers->readyAvailable.notify_all();
+	for(auto& thread : threads) {
+		if(thread.get_id() == std::this_thread::get_id())
+			thread.detach(); // Released from within a callback, it will exit once the callback returns
+		else
+			thread.join();
+	}
+}
+
+void CallbackExecutor::Workers::schedule(std::shared_ptr<AsyncCallbackQueue> queue) {
+	{
+		std::lock_guard<std::mutex> lk(mutex);
+		if(stopping)
+			return;
+		ready.push_back(std::move(queue));
+	}
+	readyAvailable.notify_one();
+}
+
+void CallbackExecutor::Workers::Run(std::shared_ptr<Workers> workers) {
+	std::unique_lock<std::mutex> lk(workers->mutex);
+	while(true) {
+		workers->readyAvailable.wait(lk, [&workers]() { return workers->stopping || !workers->ready.empty(); });
+		if(workers->stopping)
+			return;
+
+		std::shared_ptr<AsyncCallbackQueue> queue = std::move(workers->ready.front());
+		workers->ready.pop_front();
+		lk.unlock();
+
+		// Take turns so that one busy callback does not starve the others sharing this executor
+		if(queue->run(MaxMessagesPerTurn))
+			workers->schedule(queue);
+		queue.reset();
+
+		lk.lock();
+	}
+}
+
+void AsyncCallbackQueue::post(const std::shared_ptr<Message>& message) {
+	std::unique_lock<std::mutex> lk(mutex);
+	if(stopped)
+		return;
+
+	if(queue.size() >= capacity) {
+		switch(policy) {
+			case CallbackExecutor::QueueFullPolicy::Block:
+				spaceAvailable.wait(lk, [this]() { return stopped || queue.size() < capacity; });
+				if(stopped)
+					return;
+				break;
+			case CallbackExecutor::QueueFullPolicy::DropOldest:
+				queue.pop_front();
+				stats.dropped++;
+				break;
+			case CallbackExecutor::QueueFullPolicy::DropNewest:
+				stats.dropped++;
+				return;
+		}
+	}
+
+	queue.push_back(message);
+	if(queue.size() > stats.maxQueueDepth)
+		stats.maxQueueDepth = queue.size();
+
+	if(scheduled)
+		return; // The worker will get to it
+	scheduled = true;
+	lk.unlock();
+	workers->schedule(shared_from_this());
+}
+
+void AsyncCallbackQueue::stop() {
+	std::unique_lock<std::mutex> lk(mutex);
+	stopped = true;
+	queue.clear();
+	spaceAvailable.notify_all();
+
+	if(running && runningOn == std::this_thread::get_id())
+		return; // Removing ourselves from within the callback, waiting would deadlock
+
+	idle.wait(lk, [this]() { return !running; });
+}
+
+CallbackExecutor::Stats AsyncCallbackQueue::getStats() const {
+	std::lock_guard<std::mutex> lk(mutex);
+	CallbackExecutor::Stats ret = stats;
+	ret.queueDepth = queue.size();
+	return ret;
+}
+
+bool AsyncCallbackQueue::run(size_t maxMessages) {
+	std::unique_lock<std::mutex> lk(mutex);
+	for(size_t i = 0; i < maxMessages && !stopped && !queue.empty(); i++) {
+		std::shared_ptr<Message> message = std::move(queue.front());
+		queue.pop_front();
+		running = true;
+		runningOn = std::this_thread::get_id();
+		lk.unlock();
+		spaceAvailable.notify_one();
+
+		callback(message);
+		message.reset();
+
+		lk.lock();
+		running = false;
+		stats.delivered++;
+		idle.notify_all();
+	}
+
+	if(stopped || queue.empty()) {
+		scheduled = false;
+		return false;
+	}
+	return true;
+}
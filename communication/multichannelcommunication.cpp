@@ -38,6 +38,11 @@ bool MultiChannelCommunication::sendPacket(std::vector<uint8_t>& bytes) {
 	return rawWrite(bytes);
 }
 
+bool MultiChannelCommunication::sendPacket(EncodeBuffer& bytes) {
+	bytes.prepend({(uint8_t)CommandType::HostPC_to_Vnet1, (uint8_t)bytes.size(), (uint8_t)(bytes.size() >> 8)});
+	return rawWrite(bytes.data(), bytes.size());
+}
+
 void MultiChannelCommunication::hidReadTask() {
 	bool readMore = true;
 	bool gotPacket = false; // Have we got the first valid packet (don't flag errors otherwise)
@@ -179,6 +184,8 @@ void MultiChannelCommunication::vnetReadTask(size_t vnetIndex) {
 				break;
 			
 			handleInput(*vnetPacketizer, payloadBytes);
+		} else {
+			flushBatchMessageCallbacks(false);
 		}
 	}
 }
\ No newline at end of file
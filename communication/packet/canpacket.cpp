@@ -163,8 +163,11 @@ bool HardwareCANPacket::EncodeFromMessage(const CANMessage& message, std::vector
 	const uint8_t paddedLength = CAN_DLCToLength(*dlc, message.isCANFD).value_or(8);
 	const uint8_t paddingBytes = uint8_t(paddedLength - dataSize);
 
+	// The packet is appended, as the result may already hold headroom for the headers
+	const size_t start = result.size();
+
 	// Pre-allocate as much memory as we will possibly need for speed
-	result.reserve(16 + dataSize + paddingBytes);
+	result.reserve(start + 16 + dataSize + paddingBytes);
 
 	result.push_back(0 /* byte count here later */ << 4 | (uint8_t(message.network.getNetID()) & 0xF));
 
@@ -215,7 +218,7 @@ bool HardwareCANPacket::EncodeFromMessage(const CANMessage& message, std::vector
 	result.resize(result.size() + paddingBytes);
 
 	// Fill in the length byte from earlier
-	result[0] |= result.size() << 4;
+	result[start] |= (result.size() - start) << 4;
 
 	return true;
 }
\ No newline at end of file
@@ -75,9 +75,10 @@ bool HardwareEthernetPacket::EncodeFromMessage(const EthernetMessage& message, s
 		description |= 0x8000;
 	}
 	
-	bytestream.reserve(sizeWithHeader + 8); // Also reserve space for the bytes we'll use later on
-	bytestream.resize(sizeWithHeader);
-	size_t index = 0;
+	// The packet is appended, as the bytestream may already hold headroom for the headers
+	size_t index = bytestream.size();
+	bytestream.reserve(index + sizeWithHeader + 8); // Also reserve space for the bytes we'll use later on
+	bytestream.resize(index + sizeWithHeader);
 
 	// Padded size, little endian
 	bytestream[index++] = uint8_t(paddedSize);
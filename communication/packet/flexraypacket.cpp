@@ -1,4 +1,5 @@
 #include "icsneo/communication/packet/flexraypacket.h"
+#include <algorithm>
 
 using namespace icsneo;
 
@@ -56,7 +57,7 @@ std::shared_ptr<FlexRayMessage> HardwareFlexRayPacket::DecodeToMessage(const std
 				msg->slotid = data->slotid;
 				msg->cycle = data->cycle;
 				msg->dynamic = data->statusBits.bits.dynamic;
-				if(int64_t(numBytes) != int64_t(data->Length) - 4) {
+				if(int64_t(numBytes) != int64_t(data->Length) - 4 || bytestream.size() < sizeof(HardwareFlexRayPacket) - 4 + numBytes) {
 					// This is an error, probably need to flag it
 				} else {
 					const uint8_t* dataStart = (const uint8_t*)(data) - 4 + sizeof(HardwareFlexRayPacket);
@@ -69,8 +70,63 @@ std::shared_ptr<FlexRayMessage> HardwareFlexRayPacket::DecodeToMessage(const std
 }
 
 bool HardwareFlexRayPacket::EncodeFromMessage(const FlexRayMessage& message, std::vector<uint8_t>& bytestream, const device_eventhandler_t& report) {
-	(void)message;
-	(void)bytestream;
-	(void)report;
-	return false;
+	if(message.slotid == 0 || message.slotid > 2047 || message.cycle > 63) {
+		report(APIEvent::Type::MessageFormattingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	// The record names one channel and one cycle, the same as a received frame. Transmitting
+	// on both channels or repeating across cycles needs the controller's message buffers.
+	if((message.channel != FlexRay::Channel::A && message.channel != FlexRay::Channel::B) || message.cycleRepetition > 1) {
+		report(APIEvent::Type::MessageFormattingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	// Sync and startup frames may only be sent in the static segment
+	if(message.dynamic && (message.sync || message.startup)) {
+		report(APIEvent::Type::MessageFormattingError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	if(message.data.size() > 254) {
+		report(APIEvent::Type::MessageMaxLengthExceeded, APIEvent::Severity::Error);
+		return false;
+	}
+
+	// The payload is sent in 16-bit words, odd lengths are padded
+	const uint8_t payloadWords = uint8_t((message.data.size() + 1) / 2);
+	const size_t numBytes = payloadWords * 2;
+
+	// The packet is appended, as the bytestream may already hold headroom for the headers
+	// The data follows the header, overlapping the padding at the end of the struct (see DecodeToMessage)
+	const size_t headerSize = sizeof(HardwareFlexRayPacket) - 4;
+	const size_t start = bytestream.size();
+	bytestream.resize(start + headerSize + numBytes);
+	HardwareFlexRayPacket packet = {};
+
+	packet.slotid = message.slotid;
+	packet.startup = message.startup;
+	packet.sync = message.sync;
+	packet.null_frame = !message.nullFrame; // The indicator is active low
+	packet.payload_preamble = message.payloadPreamble;
+	packet.payload_len = payloadWords;
+	packet.txmsg = 1;
+	packet.cycle = message.cycle;
+
+	const uint16_t headerCRC = FlexRayMessage::CalcHeaderCRC(message.sync, message.startup, message.slotid, payloadWords);
+	packet.hdr_crc_10 = (headerCRC >> 10) & 0x1;
+	packet.hdr_crc_9_0 = headerCRC & 0x3FF;
+
+	packet.statusBits.bits.bytesRxed = uint16_t(5 + numBytes + 3); // Header, payload, and frame CRC
+	packet.statusBits.bits.dynamic = message.dynamic;
+	packet.statusBits.bits.chb = message.channel == FlexRay::Channel::B;
+
+	packet.timestamp.IsExtended = 1;
+	packet.NetworkID = uint16_t(message.network.getNetID());
+	packet.Length = uint16_t(numBytes + 4);
+
+	uint8_t* out = bytestream.data() + start;
+	std::copy((const uint8_t*)&packet, (const uint8_t*)&packet + headerSize, out);
+	std::copy(message.data.begin(), message.data.end(), out + headerSize);
+	return true;
 }
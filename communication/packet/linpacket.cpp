@@ -0,0 +1,105 @@
+#include "icsneo/communication/packet/linpacket.h"
+#include <algorithm>
+
+using namespace icsneo;
+
+std::shared_ptr<LINMessage> HardwareLINPacket::DecodeToMessage(const std::vector<uint8_t>& bytestream) {
+	if(bytestream.size() < sizeof(HardwareLINPacket))
+		return nullptr;
+
+	const HardwareLINPacket* packet = (const HardwareLINPacket*)bytestream.data();
+	auto msg = std::make_shared<LINMessage>();
+
+	msg->protectedID = uint8_t(packet->CoreMiniBitsLIN.ID);
+	msg->ID = msg->protectedID & 0x3F;
+
+	// The data is copied once, straight from the packet
+	const uint8_t length = std::min<uint8_t>(uint8_t(packet->status.len), 8);
+	msg->data.assign(packet->data, packet->data + length);
+	msg->checksum = uint8_t(packet->flags.checksum);
+
+	LINErrorFlags& err = msg->errFlags;
+	err.rxBreakOnly = packet->CoreMiniBitsLIN.errRxOnlyBreak;
+	err.rxBreakSyncOnly = packet->CoreMiniBitsLIN.errRxOnlyBreakSync;
+	err.rxBreakNotZero = packet->flags.errRxBreakNotZero;
+	err.rxBreakTooShort = packet->flags.errRxBreakTooShort;
+	err.rxSyncNot55 = packet->flags.errRxSyncNot55;
+	err.rxDataLenOver8 = packet->flags.errRxDataLenOver8 || packet->status.len > 8;
+	err.syncFramingError = packet->status.syncFerr;
+	err.idFramingError = packet->status.midFerr;
+	err.responderByteFramingError = packet->status.responderByteFerr;
+
+	LINStatusFlags& status = msg->statusFlags;
+	status.txChecksumEnhanced = packet->flags.txChecksumEnhanced;
+	status.txCommander = packet->flags.txCommander;
+	status.txResponder = packet->flags.txResponder;
+	status.txAborted = packet->status.txAborted;
+	status.updateResponderOnce = packet->status.updateResponderOnce;
+	status.hasUpdatedResponderOnce = packet->status.hasUpdatedResponderOnce;
+	status.busRecovered = packet->status.busRecovered;
+	status.breakOnly = packet->status.breakOnly;
+
+	const bool headerReceived = !err.rxBreakOnly && !err.rxBreakSyncOnly && !status.breakOnly;
+	msg->isHeaderOnly = packet->flags.headerOnly;
+	if(headerReceived)
+		err.idParityError = LINMessage::CalcProtectedID(msg->ID) != msg->protectedID;
+
+	// Work out which checksum model the frame used, so that applications do not have to
+	if(headerReceived && !msg->isHeaderOnly) {
+		const uint8_t* data = msg->data.data();
+		if(msg->checksum == LINMessage::CalcChecksum(data, length, msg->protectedID, true)) {
+			msg->isEnhancedChecksum = true;
+		} else if(msg->checksum != LINMessage::CalcChecksum(data, length, msg->protectedID, false)) {
+			msg->isEnhancedChecksum = status.txChecksumEnhanced;
+			err.checksumError = true;
+		}
+	}
+
+	msg->transmitted = status.txCommander || status.txResponder;
+	msg->error = err.rxBreakOnly || err.rxBreakSyncOnly || err.rxBreakNotZero || err.rxBreakTooShort ||
+		err.rxSyncNot55 || err.rxDataLenOver8 || err.syncFramingError || err.idFramingError ||
+		err.responderByteFramingError || err.idParityError || err.checksumError || status.txAborted;
+	msg->description = packet->stats;
+
+	// This timestamp is raw off the device (in timestampResolution increments)
+	// Decoder will fix as it has information about the timestampResolution increments
+	msg->timestamp = packet->timestamp.TS;
+
+	return msg;
+}
+
+bool HardwareLINPacket::EncodeFromMessage(const LINMessage& message, std::vector<uint8_t>& bytestream, const device_eventhandler_t& report) {
+	if(message.ID > 0x3F) {
+		report(APIEvent::Type::MessageFormattingError, APIEvent::Severity::Error);
+		return false; // LIN IDs are 6 bits
+	}
+
+	if(message.data.size() > 8) {
+		report(APIEvent::Type::MessageMaxLengthExceeded, APIEvent::Severity::Error);
+		return false;
+	}
+
+	// The packet is appended, as the bytestream may already hold headroom for the headers
+	const size_t start = bytestream.size();
+	bytestream.resize(start + sizeof(HardwareLINPacket));
+	HardwareLINPacket& packet = *(HardwareLINPacket*)(bytestream.data() + start);
+
+	const uint8_t protectedID = LINMessage::CalcProtectedID(message.ID);
+	packet.CoreMiniBitsLIN.ID = protectedID;
+
+	if(!message.isHeaderOnly) {
+		packet.status.len = uint8_t(message.data.size());
+		std::copy(message.data.begin(), message.data.end(), packet.data);
+		packet.flags.checksum = LINMessage::CalcChecksum(message.data.data(), message.data.size(), protectedID, message.isEnhancedChecksum);
+	}
+	packet.flags.headerOnly = message.isHeaderOnly;
+	packet.flags.txChecksumEnhanced = message.isEnhancedChecksum;
+
+	// Unless set up as a responder, we send the header (and data) as the commander
+	packet.flags.txResponder = message.statusFlags.txResponder;
+	packet.flags.txCommander = !message.statusFlags.txResponder;
+	packet.status.updateResponderOnce = message.statusFlags.updateResponderOnce;
+	packet.status.breakOnly = message.statusFlags.breakOnly;
+	packet.stats = message.description;
+	return true;
+}
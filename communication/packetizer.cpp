@@ -1,12 +1,17 @@
 #include "icsneo/communication/packetizer.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 using namespace icsneo;
 
 uint8_t Packetizer::ICSChecksum(const std::vector<uint8_t>& data) {
+	return ICSChecksum(data.data(), data.size());
+}
+
+uint8_t Packetizer::ICSChecksum(const uint8_t* data, size_t size) {
 	uint32_t checksum = 0;
-	for(size_t i = 0; i < data.size(); i++)
+	for(size_t i = 0; i < size; i++)
 		checksum += data[i];
 	checksum = ~checksum;
 	checksum++;
@@ -25,33 +30,50 @@ std::vector<uint8_t>& Packetizer::packetWrap(std::vector<uint8_t>& data, bool sh
 	return data;
 }
 
+EncodeBuffer& Packetizer::packetWrap(EncodeBuffer& data, bool shortFormat) const {
+	if(shortFormat)
+		data.push_back(disableChecksum ? 0x00 : ICSChecksum(data.data(), data.size()));
+	data.prepend({ 0xAA });
+	if(align16bit && data.size() % 2 == 1)
+		data.push_back('A');
+	return data;
+}
+
 bool Packetizer::input(const std::vector<uint8_t>& inputBytes) {
 	bool haveEnoughData = true;
+	if(bytesStart == bytes.size()) {
+		bytes.clear();
+		bytesStart = 0;
+	} else if(bytesStart >= bytes.size() / 2) {
+		// Reclaim the consumed bytes once they are most of the buffer
+		bytes.erase(bytes.begin(), bytes.begin() + bytesStart);
+		bytesStart = 0;
+	}
 	bytes.insert(bytes.end(), inputBytes.begin(), inputBytes.end());
 
 	while(haveEnoughData) {
 		switch(state) {
 			case ReadState::SearchForHeader:
-				if(bytes.size() < 1) {
+				if(available() < 1) {
 					haveEnoughData = false;
 					break;
 				}
 
-				if(bytes[0] == 0xAA) { // 0xAA denotes the beginning of a packet
+				if(bytes[bytesStart] == 0xAA) { // 0xAA denotes the beginning of a packet
 					state = ReadState::ParseHeader;
 					currentIndex = 1;
 				} else {
-					bytes.pop_front(); // Discard
+					bytesStart++; // Discard
 				}
 				break;
 			case ReadState::ParseHeader:
-				if(bytes.size() < 2) {
+				if(available() < 2) {
 					haveEnoughData = false;
 					break;
 				}
 
-				packetLength = bytes[1] >> 4 & 0xf; // Upper nibble of the second byte denotes the packet length
-				packet.network = Network(bytes[1] & 0xf); // Lower nibble of the second byte is the network ID
+				packetLength = bytes[bytesStart + 1] >> 4 & 0xf; // Upper nibble of the second byte denotes the packet length
+				packet.network = Network(bytes[bytesStart + 1] & 0xf); // Lower nibble of the second byte is the network ID
 				if(packetLength == 0) { // A length of zero denotes a long style packet
 					state = ReadState::ParseLongStylePacketHeader;
 					checksum = false;
@@ -65,14 +87,14 @@ bool Packetizer::input(const std::vector<uint8_t>& inputBytes) {
 				currentIndex++;
 				break;
 			case ReadState::ParseLongStylePacketHeader:
-				if(bytes.size() < 6) {
+				if(available() < 6) {
 					haveEnoughData = false;
 					break;
 				}
 
-				packetLength = bytes[2]; // Long packets have a little endian length on bytes 3 and 4
-				packetLength |= bytes[3] << 8;
-				packet.network = Network((bytes[5] << 8) | bytes[4]); // Long packets have their netid stored as little endian on bytes 5 and 6
+				packetLength = bytes[bytesStart + 2]; // Long packets have a little endian length on bytes 3 and 4
+				packetLength |= bytes[bytesStart + 3] << 8;
+				packet.network = Network((bytes[bytesStart + 5] << 8) | bytes[bytesStart + 4]); // Long packets have their netid stored as little endian on bytes 5 and 6
 				currentIndex += 4;
 
 				/* Long packets can't have a length less than 6, because that would indicate a negative payload size.
@@ -81,7 +103,7 @@ bool Packetizer::input(const std::vector<uint8_t>& inputBytes) {
 				 * payload, and not the header or checksum.
 				 */
 				if(packetLength < 6 || packetLength > 4000) {
-					bytes.pop_front();
+					bytesStart++;
 					EventManager::GetInstance().add(APIEvent::Type::FailedToRead, APIEvent::Severity::Error);
 					state = ReadState::SearchForHeader;
 				} else {
@@ -90,29 +112,35 @@ bool Packetizer::input(const std::vector<uint8_t>& inputBytes) {
 				break;
 			case ReadState::GetData:
 				// We do not include the checksum in packetLength so it doesn't get copied into the payload buffer
-				if(bytes.size() < (size_t)(packetLength + (checksum ? 1 : 0))) { // Read until we have the rest of the packet
+				if(available() < (size_t)(packetLength + (checksum ? 1 : 0))) { // Read until we have the rest of the packet
 					haveEnoughData = false;
 					break;
 				}
 
-				packet.data.clear();
-				if(packetLength > 0)
-					packet.data.resize(packetLength - headerSize);
-				
-				auto i = 0;
-				while(currentIndex < packetLength)
-					packet.data[i++] = bytes[currentIndex++];
+				if(packet.network.getNetID() == Network::NetID::RED_OLDFORMAT && packetLength - currentIndex >= 3) {
+					/* Old format packets wrap a short packet, see Decoder::decodeOldFormat. The wrapper is removed here,
+					 * while the payload is being copied anyway, so that the short packet is decoded directly.
+					 */
+					const size_t payload = bytesStart + currentIndex;
+					const uint16_t length = uint16_t(bytes[payload] | (bytes[payload + 1] << 8));
+					packet.network = Network(bytes[payload + 2] & 0xF);
+					const size_t copy = std::min<size_t>(length, packetLength - currentIndex - 3);
+					packet.data.assign(bytes.begin() + payload + 3, bytes.begin() + payload + 3 + copy);
+					packet.data.resize(length); // A longer length is zero filled, as the decoder would do
+				} else {
+					packet.data.assign(bytes.begin() + bytesStart + currentIndex, bytes.begin() + bytesStart + packetLength);
+				}
+				currentIndex = packetLength;
 
-				if(disableChecksum || !checksum || bytes[currentIndex] == ICSChecksum(packet.data)) {
+				if(disableChecksum || !checksum || bytes[bytesStart + currentIndex] == ICSChecksum(packet.data)) {
 					// Got a good packet
 					gotGoodPackets = true;
-					processedPackets.push_back(std::make_shared<Packet>(packet));
-					for (auto a = 0; a < packetLength; a++)
-						bytes.pop_front();
+					processedPackets.push_back(std::make_shared<Packet>(std::move(packet)));
+					bytesStart += packetLength;
 				} else {
 					if(gotGoodPackets) // Don't complain unless we've already gotten a good packet, in case we started in the middle of a stream
 						report(APIEvent::Type::PacketChecksumError, APIEvent::Severity::Error);
-					bytes.pop_front(); // Drop the first byte so it doesn't get picked up again
+					bytesStart++; // Drop the first byte so it doesn't get picked up again
 				}
 				
 				// Reset for the next packet
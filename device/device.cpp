@@ -12,6 +12,37 @@
 
 using namespace icsneo;
 
+class Device::ExtensionHooks {
+public:
+	class Hook {
+	public:
+		DeviceExtension::HookFilter filter;
+		std::shared_ptr<DeviceExtension> extension;
+	};
+
+	std::vector<Hook> message;
+	std::vector<Hook> transmit;
+};
+
+class Device::InternalMessageFilter : public MessageFilter {
+public:
+	InternalMessageFilter(const Device& device) : device(device) { includeInternalInAny = true; }
+
+	bool mayMatchNetwork(const Network& network) const override {
+		const ExtensionHooks* hooks = device.extensionHooks;
+		if(!hooks)
+			return false;
+		for(const auto& hook : hooks->message) {
+			if(hook.filter.mayMatchNetwork(network.getType()))
+				return true;
+		}
+		return false;
+	}
+
+private:
+	const Device& device;
+};
+
 static const uint8_t fromBase36Table[256] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0, 0, 0, 0, 0, 0, 10, 11, 12,
 	13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 0, 0, 0, 0, 0, 0, 10, 11, 12, 13, 14, 15,
@@ -73,6 +104,7 @@ bool Device::SerialStringIsNumeric(const std::string& serial) {
 }
 
 Device::~Device() {
+	asyncDiskQueue.stop(); // Before anything the operations use is torn down
 	if(isMessagePollingEnabled())
 		disableMessagePolling();
 	close();
@@ -218,21 +250,22 @@ bool Device::open(OpenFlags flags, OpenStatusHandler handler) {
 			EventManager::GetInstance().cancelErrorDowngradingOnCurrentThread();
 	}
 
-	MessageFilter filter;
-	filter.includeInternalInAny = true;
-	internalHandlerCallbackID = com->addMessageCallback(MessageCallback(filter, [this](std::shared_ptr<Message> message) {
+	internalHandlerCallbackID = com->addMessageCallback(MessageCallback(std::make_shared<InternalMessageFilter>(*this), [this](std::shared_ptr<Message> message) {
 		handleInternalMessage(message);
 	}));
 
 	heartbeatThread = std::thread([this]() {
 		EventManager::GetInstance().downgradeErrorsOnCurrentThread();
 
-		MessageFilter filter;
-		filter.includeInternalInAny = true;
-		std::atomic<bool> receivedMessage{false};
-		auto messageReceivedCallbackID = com->addMessageCallback(MessageCallback(filter, [&receivedMessage](std::shared_ptr<Message> message) {
-			receivedMessage = true;
-		}));
+		// Any packet counts, even if it is not decoded because nothing is subscribed to it
+		uint64_t lastReceived = com->getReceivedPacketCount();
+		const auto receivedMessage = [this, &lastReceived]() {
+			const uint64_t received = com->getReceivedPacketCount();
+			if(received == lastReceived)
+				return false;
+			lastReceived = received;
+			return true;
+		};
 
 		// Give the device time to get situated
 		auto i = 150;
@@ -244,9 +277,7 @@ bool Device::open(OpenFlags flags, OpenStatusHandler handler) {
 		while(!stopHeartbeatThread) {
 			// Wait for 110ms for a possible heartbeat
 			std::this_thread::sleep_for(std::chrono::milliseconds(110));
-			if(receivedMessage) {
-				receivedMessage = false;
-			} else {
+			if(!receivedMessage()) {
 				// Some communication, such as the bootloader and extractor interfaces, must
 				// redirect the input stream from the device as it will no longer be in the
 				// packet format we expect here. As a result, status updates will not reach
@@ -264,17 +295,13 @@ bool Device::open(OpenFlags flags, OpenStatusHandler handler) {
 				// The response should come back quickly if the com is quiet
 				std::this_thread::sleep_for(std::chrono::milliseconds(50));
 				// Check if we got a message, and if not, if settings are being applied
-				if(receivedMessage) {
-					receivedMessage = false;
-				} else {
+				if(!receivedMessage()) {
 					if(!stopHeartbeatThread && !isDisconnected())
 						report(APIEvent::Type::DeviceDisconnected, APIEvent::Severity::Error);
 					break;
 				}
 			}
 		}
-
-		com->removeMessageCallback(messageReceivedCallbackID);
 	});
 
 	return true;
@@ -320,6 +347,7 @@ bool Device::close() {
 	}
 
 	stopHeartbeatThread = true;
+	asyncDiskQueue.cancelAll();
 
 	if(isOnline())
 		goOffline();
@@ -333,6 +361,12 @@ bool Device::close() {
 		heartbeatThread.join();
 	stopHeartbeatThread = false;
 
+	{
+		// The disk may be changed while the device is closed
+		std::lock_guard<std::mutex> lk(diskLock);
+		vsaExtent.reset();
+	}
+
 	forEachExtension([](const std::shared_ptr<DeviceExtension>& ext) { ext->onDeviceClose(); return true; });
 	return com->close();
 }
@@ -425,21 +459,67 @@ bool Device::transmit(std::shared_ptr<Frame> frame) {
 		return false;
 	}
 
-	bool extensionHookedTransmit = false;
-	bool transmitStatusFromExtension = false;
-	forEachExtension([&](const std::shared_ptr<DeviceExtension>& ext) {
-		if(!ext->transmitHook(frame, transmitStatusFromExtension))
-			extensionHookedTransmit = true;
-		return !extensionHookedTransmit; // false breaks out of the loop early
-	});
-	if(extensionHookedTransmit)
-		return transmitStatusFromExtension;
+	if(const ExtensionHooks* hooks = extensionHooks) {
+		for(const auto& hook : hooks->transmit) {
+			if(!hook.filter.match(*frame))
+				continue;
+			bool transmitStatusFromExtension = false;
+			if(!hook.extension->transmitHook(frame, transmitStatusFromExtension))
+				return transmitStatusFromExtension; // The extension has taken care of it
+		}
+	}
+
+	auto packet = com->encodeBuffers.acquire();
+	if(!com->encoder->encode(*com->packetizer, *packet, frame))
+		return false;
+
+	return com->sendPacket(*packet);
+}
+
+std::shared_ptr<PreparedFrame> Device::prepareTransmit(std::shared_ptr<Frame> frame) {
+	if(!isSupportedTXNetwork(frame->network)) {
+		report(APIEvent::Type::UnsupportedTXNetwork, APIEvent::Severity::Error);
+		return nullptr;
+	}
+
+	if(transmitIsHooked(*frame)) {
+		report(APIEvent::Type::PreparedTransmitNotSupported, APIEvent::Severity::Error);
+		return nullptr;
+	}
+
+	return com->encoder->prepare(*com->packetizer, frame);
+}
+
+bool Device::transmit(const PreparedFrame& frame) {
+	if(!isOpen()) {
+		report(APIEvent::Type::DeviceCurrentlyClosed, APIEvent::Severity::Error);
+		return false;
+	}
 
-	std::vector<uint8_t> packet;
-	if(!com->encoder->encode(*com->packetizer, packet, frame))
+	if(!isOnline()) {
+		report(APIEvent::Type::DeviceCurrentlyOffline, APIEvent::Severity::Error);
+		return false;
+	}
+
+	// An extension may have been added since the frame was prepared
+	if(transmitIsHooked(*frame.getFrame())) {
+		report(APIEvent::Type::PreparedTransmitNotSupported, APIEvent::Severity::Error);
 		return false;
+	}
 
-	return com->sendPacket(packet);
+	auto packet = com->encodeBuffers.acquire();
+	packet->append(frame.getPacket().data(), frame.getPacket().size());
+	return com->sendPacket(*packet);
+}
+
+bool Device::transmitIsHooked(const Frame& frame) const {
+	if(const ExtensionHooks* hooks = extensionHooks) {
+		for(const auto& hook : hooks->transmit) {
+			if(hook.filter.match(frame))
+				return true;
+		}
+	}
+	return false;
 }
 
 bool Device::transmit(std::vector<std::shared_ptr<Frame>> frames) {
@@ -490,15 +570,15 @@ optional<uint64_t> Device::readLogicalDisk(uint64_t pos, uint8_t* into, uint64_t
 
 	if(diskReadDriver->getAccess() == Disk::Access::EntireCard && diskWriteDriver->getAccess() == Disk::Access::VSA) {
 		// We have mismatched drivers, we need to add an offset to the diskReadDriver
-		const auto offset = Disk::FindVSAInFAT([this, &timeout](uint64_t pos, uint8_t *into, uint64_t amount) {
+		const auto extent = findVSAExtent([this, &timeout](uint64_t pos, uint8_t *into, uint64_t amount) {
 			const auto start = std::chrono::steady_clock::now();
 			auto ret = diskReadDriver->readLogicalDisk(*com, report, pos, into, amount, timeout);
 			timeout -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
 			return ret;
 		});
-		if(!offset.has_value())
+		if(!extent.has_value())
 			return nullopt;
-		diskReadDriver->setVSAOffset(*offset);
+		diskReadDriver->setVSAOffset(extent->offset);
 	}
 
 	// This is needed for certain read drivers which take over the communication stream
@@ -519,9 +599,44 @@ optional<uint64_t> Device::writeLogicalDisk(uint64_t pos, const uint8_t* from, u
 	}
 
 	std::lock_guard<std::mutex> lk(diskLock);
+	vsaExtent.reset(); // The write may have moved or resized it
 	return diskWriteDriver->writeLogicalDisk(*com, report, *diskReadDriver, pos, from, amount, timeout);
 }
 
+std::shared_ptr<Disk::AsyncOperation> Device::readLogicalDiskAsync(uint64_t pos, uint8_t* into, uint64_t amount,
+	Disk::AsyncOperation::CompletionFn onComplete) {
+	if(!into) {
+		report(APIEvent::Type::RequiredParameterNull, APIEvent::Severity::Error);
+		return nullptr;
+	}
+
+	if(!isOpen()) {
+		report(APIEvent::Type::DeviceCurrentlyClosed, APIEvent::Severity::Error);
+		return nullptr;
+	}
+
+	return asyncDiskQueue.enqueue([this, pos, into](uint64_t offset, uint64_t amount) {
+		return readLogicalDisk(pos + offset, into + offset, amount);
+	}, amount, onComplete);
+}
+
+std::shared_ptr<Disk::AsyncOperation> Device::writeLogicalDiskAsync(uint64_t pos, const uint8_t* from, uint64_t amount,
+	Disk::AsyncOperation::CompletionFn onComplete) {
+	if(!from) {
+		report(APIEvent::Type::RequiredParameterNull, APIEvent::Severity::Error);
+		return nullptr;
+	}
+
+	if(!isOpen()) {
+		report(APIEvent::Type::DeviceCurrentlyClosed, APIEvent::Severity::Error);
+		return nullptr;
+	}
+
+	return asyncDiskQueue.enqueue([this, pos, from](uint64_t offset, uint64_t amount) {
+		return writeLogicalDisk(pos + offset, from + offset, amount);
+	}, amount, onComplete);
+}
+
 optional<bool> Device::isLogicalDiskConnected() {
 	if(!isOpen()) {
 		report(APIEvent::Type::DeviceCurrentlyClosed, APIEvent::Severity::Error);
@@ -563,18 +678,89 @@ optional<uint64_t> Device::getVSAOffsetInLogicalDisk() {
 	if (diskReadDriver->getAccess() == Disk::Access::VSA || diskReadDriver->getAccess() == Disk::Access::None)
 		return 0ull;
 	
-	auto offset = Disk::FindVSAInFAT([this](uint64_t pos, uint8_t *into, uint64_t amount) {
+	const auto extent = findVSAExtent([this](uint64_t pos, uint8_t *into, uint64_t amount) {
 		return diskReadDriver->readLogicalDisk(*com, report, pos, into, amount);
 	});
-	if(!offset.has_value())
+	if(!extent.has_value())
 		return nullopt;
 
 	if(diskReadDriver->getAccess() == Disk::Access::EntireCard && diskWriteDriver->getAccess() == Disk::Access::VSA) {
 		// We have mismatched drivers, we need to add an offset to the diskReadDriver
-		diskReadDriver->setVSAOffset(*offset);
+		diskReadDriver->setVSAOffset(extent->offset);
 		return 0ull;
 	}
-	return *offset;
+	return extent->offset;
+}
+
+optional<Disk::VSAExtent> Device::findVSAExtent(const Disk::DiskReadFn& diskRead) {
+	if(!vsaExtent.has_value())
+		vsaExtent = Disk::FindVSAExtentInFAT(diskRead);
+	return vsaExtent;
+}
+
+Disk::ReadDriver::CacheStats Device::getLogicalDiskCacheStats() const {
+	std::lock_guard<std::mutex> lk(diskLock);
+	if(!diskReadDriver)
+		return {};
+	return diskReadDriver->getCacheStats();
+}
+
+bool Device::extractLogicalDisk(const std::string& path, uint64_t pos, uint64_t amount,
+	std::function<void(const Disk::FileExtractor::Progress&)> onProgress) {
+	// A chunk may take many round trips to the device, so it is read a block at a time, each with the usual
+	// timeout. A lost response fails the chunk quickly, and the extraction can be resumed. Reading on from
+	// where the last block ended keeps the driver's readahead going, so the blocks are still pipelined.
+	const uint64_t blockSize = diskReadDriver->getBlockSizeBounds().second;
+	Disk::FileExtractor extractor([this, blockSize](uint64_t pos, uint8_t* into, uint64_t amount) -> optional<uint64_t> {
+		uint64_t vsaOffset;
+		{
+			std::lock_guard<std::mutex> lk(diskLock);
+			vsaOffset = diskReadDriver->getVSAOffset();
+		}
+
+		uint64_t done = 0;
+		while(done < amount) {
+			const uint64_t blockEnd = ((pos + done + vsaOffset) / blockSize + 1) * blockSize - vsaOffset;
+			const uint64_t size = std::min(blockEnd - (pos + done), amount - done);
+			const auto read = readLogicalDisk(pos + done, into + done, size);
+			if(!read.has_value())
+				return done ? optional<uint64_t>(done) : nullopt;
+			done += *read;
+			if(*read < size)
+				break;
+		}
+		return done;
+	}, report);
+	extractor.onProgress = onProgress;
+	return extractor.extract(pos, amount, path);
+}
+
+bool Device::extractVSA(const std::string& path, std::function<void(const Disk::FileExtractor::Progress&)> onProgress) {
+	const auto offset = getVSAOffsetInLogicalDisk();
+	if(!offset.has_value())
+		return false;
+
+	optional<uint64_t> vsaSize;
+	uint64_t start = *offset;
+	{
+		std::lock_guard<std::mutex> lk(diskLock);
+		if(vsaExtent.has_value())
+			vsaSize = vsaExtent->size;
+		start += diskReadDriver->getVSAOffset(); // If reads are already relative to the VSA, the disk ends that much sooner
+	}
+
+	if(!vsaSize.has_value()) {
+		// The FAT is not visible to us, so the VSA is taken to run to the end of the disk
+		const auto size = getLogicalDiskSize();
+		if(!size.has_value())
+			return false;
+		if(start >= *size) {
+			report(APIEvent::Type::ParameterOutOfRange, APIEvent::Severity::Error);
+			return false;
+		}
+		vsaSize = *size - start;
+	}
+	return extractLogicalDisk(path, *offset, *vsaSize, onProgress);
 }
 
 optional<bool> Device::getDigitalIO(IO type, size_t number /* = 1 */) {
@@ -790,6 +976,22 @@ Lifetime Device::suppressDisconnects() {
 void Device::addExtension(std::shared_ptr<DeviceExtension>&& extension) {
 	std::lock_guard<std::mutex> lk(extensionsLock);
 	extensions.push_back(extension);
+
+	auto hooks = std::make_shared<ExtensionHooks>();
+	for(const auto& ext : extensions) {
+		auto filter = ext->getMessageHookFilter();
+		if(!filter.empty())
+			hooks->message.push_back({ std::move(filter), ext });
+		filter = ext->getTransmitHookFilter();
+		if(!filter.empty())
+			hooks->transmit.push_back({ std::move(filter), ext });
+	}
+	extensionHooksVersions.push_back(hooks);
+	extensionHooks = hooks.get();
+
+	// The internal message handler may now want more frame traffic
+	if(com)
+		com->refreshSubscriptions();
 }
 
 void Device::forEachExtension(std::function<bool(const std::shared_ptr<DeviceExtension>&)> fn) {
@@ -834,10 +1036,12 @@ void Device::handleInternalMessage(std::shared_ptr<Message> message) {
 		}
 		default: break;
 	}
-	forEachExtension([&](const std::shared_ptr<DeviceExtension>& ext) {
-		ext->handleMessage(message);
-		return true; // false breaks out early
-	});
+	if(const ExtensionHooks* hooks = extensionHooks) {
+		for(const auto& hook : hooks->message) {
+			if(hook.filter.match(*message))
+				hook.extension->handleMessage(message);
+		}
+	}
 }
 
 void Device::handleNeoVIMessage(std::shared_ptr<CANMessage> message) {
@@ -565,34 +565,8 @@ bool FlexRay::Controller::enterConfig(std::chrono::milliseconds timeout) {
 }
 
 uint16_t FlexRay::Controller::CalculateHCRC(const MessageBuffer& buf) {
-	uint16_t ret = 0x1A;
-
-	auto addBit = [&ret](uint8_t bit) {
-		bit = bit ? 1 : 0;
-
-		int crcNxt; //CRCNXT = NXTBIT EXOR CRC_RG(14);
-		if (ret & (1<<10))
-			crcNxt = bit ^ 1;
-		else
-			crcNxt = bit ^ 0;
-		crcNxt &= 0x01;
-
-		// CRC_RG(14:1) = CRC_RG(13:0); // shift left by
-		ret <<= 1;
-		ret &= 0x7FE; // clear first bit
-
-		if (crcNxt) //CRC_RG(14:0) = CRC_RG(14:0) EXOR (4599hex);
-			ret ^= 0x385;
-	};
-
-	addBit(buf.isStartup);
-	addBit(buf.isSync);
-	for(auto i = 0; i < 11; i++)
-		addBit(buf.frameID & (1 << (10 - i)));
-	for(auto i = 0; i < 7; i++)
-		addBit(((buf.frameLengthBytes + 1) / 2) & (1 << (6 - i)));
-
-	return ret;
+	// The sync indicator comes before the startup indicator on the wire, and so in the CRC
+	return FlexRayMessage::CalcHeaderCRC(buf.isSync, buf.isStartup, buf.frameID, uint8_t((buf.frameLengthBytes + 1) / 2));
 }
 
 uint16_t FlexRay::Controller::CalculateCycleFilter(uint8_t baseCycle, uint8_t cycleRepetition) {
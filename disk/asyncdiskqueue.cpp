@@ -0,0 +1,94 @@
+#include "icsneo/disk/asyncdiskqueue.h"
+#include <algorithm>
+
+using namespace icsneo;
+using namespace icsneo::Disk;
+
+std::shared_ptr<AsyncOperation> AsyncQueue::enqueue(AsyncOperation::TransferFn transfer, uint64_t amount,
+	AsyncOperation::CompletionFn onComplete) {
+	std::shared_ptr<AsyncOperation> operation(new AsyncOperation(transfer, amount, onComplete));
+	std::lock_guard<std::mutex> lk(mutex);
+	queue.push_back(operation);
+	if(!thread.joinable())
+		thread = std::thread(&AsyncQueue::run, this);
+	queueChanged.notify_one();
+	return operation;
+}
+
+void AsyncQueue::cancelAll() {
+	std::lock_guard<std::mutex> lk(mutex);
+	for(const auto& operation : queue)
+		operation->cancel();
+	if(running)
+		running->cancel();
+}
+
+void AsyncQueue::stop() {
+	{
+		std::lock_guard<std::mutex> lk(mutex);
+		stopping = true;
+	}
+	queueChanged.notify_one();
+	if(thread.joinable())
+		thread.join();
+
+	std::lock_guard<std::mutex> lk(mutex);
+	stopping = false;
+}
+
+void AsyncQueue::run() {
+	std::unique_lock<std::mutex> lk(mutex);
+	while(true) {
+		queueChanged.wait(lk, [this]() { return stopping || !queue.empty(); });
+		if(stopping)
+			break;
+
+		const auto operation = queue.front();
+		queue.pop_front();
+		if(operation->cancelRequested) {
+			lk.unlock();
+			Finish(*operation, AsyncOperation::State::Cancelled, uint64_t(operation->transferred));
+			lk.lock();
+			continue;
+		}
+
+		// The lock is not held during the transfer, so that more can be queued or cancelled
+		running = operation;
+		operation->state = AsyncOperation::State::Running;
+		const uint64_t done = operation->transferred;
+		const uint64_t slice = std::min(sliceSize, operation->amount - done);
+		lk.unlock();
+		const auto result = slice ? operation->transfer(done, slice) : optional<uint64_t>(0);
+		operation->transferred += result.value_or(0);
+
+		if(result != slice) {
+			Finish(*operation, AsyncOperation::State::Failed,
+				operation->transferred ? optional<uint64_t>(uint64_t(operation->transferred)) : nullopt);
+		} else if(operation->transferred == operation->amount) {
+			Finish(*operation, AsyncOperation::State::Completed, uint64_t(operation->transferred));
+		} else {
+			// Back of the line, so every operation gets its turn
+			operation->state = AsyncOperation::State::Queued;
+			lk.lock();
+			queue.push_back(operation);
+			running.reset();
+			continue;
+		}
+		lk.lock();
+		running.reset();
+	}
+
+	// Anything left over will never run
+	std::deque< std::shared_ptr<AsyncOperation> > leftover;
+	leftover.swap(queue);
+	lk.unlock();
+	for(const auto& operation : leftover)
+		Finish(*operation, AsyncOperation::State::Cancelled, uint64_t(operation->transferred));
+}
+
+void AsyncQueue::Finish(AsyncOperation& operation, AsyncOperation::State state, optional<uint64_t> result) {
+	operation.state = state;
+	operation.promise.set_value(result);
+	if(operation.onComplete)
+		operation.onComplete(operation);
+}
@@ -1,5 +1,7 @@
 #include "icsneo/disk/diskreaddriver.h"
 #include <cstring>
+#include <algorithm>
+#include <iterator>
 
 using namespace icsneo;
 using namespace icsneo::Disk;
@@ -17,6 +19,9 @@ optional<uint64_t> ReadDriver::readLogicalDisk(Communication& com, device_eventh
 	std::vector<uint8_t> alignedReadBuffer;
 
 	pos += vsaOffset;
+	if(supportsPipelinedReads() && maxOutstandingReads > 1)
+		return readLogicalDiskPipelined(com, report, pos, into, amount, timeout);
+
 	const uint32_t idealBlockSize = getBlockSizeBounds().second;
 	const uint64_t startBlock = pos / idealBlockSize;
 	const uint32_t posWithinFirstBlock = static_cast<uint32_t>(pos % idealBlockSize);
@@ -24,6 +29,7 @@ optional<uint64_t> ReadDriver::readLogicalDisk(Communication& com, device_eventh
 	if(blocks * idealBlockSize - posWithinFirstBlock < amount)
 		blocks++; // We need one more block to get the last partial block's worth
 	uint64_t blocksProcessed = 0;
+	const bool cacheable = (amount <= cacheMaxReadSize);
 
 	while(blocksProcessed < blocks && timeout >= std::chrono::milliseconds::zero()) {
 		const uint64_t currentBlock = startBlock + blocksProcessed;
@@ -40,6 +46,15 @@ optional<uint64_t> ReadDriver::readLogicalDisk(Communication& com, device_eventh
 		if(curAmt > amountLeft)
 			curAmt = static_cast<uint32_t>(amountLeft);
 
+		if(const CachedBlock* cached = findCachedBlock(currentBlock * idealBlockSize)) {
+			memcpy(into + intoOffset, cached->data.data() + posWithinCurrentBlock, curAmt);
+			if(!ret)
+				ret.emplace();
+			*ret += curAmt;
+			blocksProcessed++;
+			continue;
+		}
+
 		const bool useAlignedReadBuffer = (posWithinCurrentBlock != 0 || curAmt != idealBlockSize);
 		if(useAlignedReadBuffer && alignedReadBuffer.size() < idealBlockSize)
 			alignedReadBuffer.resize(idealBlockSize);
@@ -58,6 +73,9 @@ optional<uint64_t> ReadDriver::readLogicalDisk(Communication& com, device_eventh
 			break;
 		}
 
+		if(cacheable && *readAmount == idealBlockSize)
+			cacheBlock(currentBlock * idealBlockSize, useAlignedReadBuffer ? alignedReadBuffer.data() : (into + intoOffset), idealBlockSize);
+
 		if(useAlignedReadBuffer)
 			memcpy(into + intoOffset, alignedReadBuffer.data() + posWithinCurrentBlock, curAmt);
 
@@ -68,4 +86,273 @@ optional<uint64_t> ReadDriver::readLogicalDisk(Communication& com, device_eventh
 	}
 
 	return ret;
-}
\ No newline at end of file
+}
+
+void ReadDriver::discardReadahead() {
+	for(auto it = pipelinedBlocks.begin(); it != pipelinedBlocks.end();) {
+		if(it->second.finished) {
+			it = pipelinedBlocks.erase(it);
+		} else {
+			it->second.discard = true; // Still in flight, so the buffer must stay around until it finishes
+			++it;
+		}
+	}
+}
+
+ReadDriver::CacheStats ReadDriver::getCacheStats() const {
+	CacheStats stats = cacheStats;
+	stats.cachedBlocks = cache.size();
+	stats.cachedBytes = cachedBytes;
+	return stats;
+}
+
+void ReadDriver::resetCacheStats() {
+	cacheStats = CacheStats();
+}
+
+void ReadDriver::invalidateCache(uint64_t pos, uint64_t amount) {
+	discardReadahead();
+
+	pos += vsaOffset;
+	for(auto it = cache.begin(); it != cache.end();) {
+		const auto current = it++;
+		if(current->pos < pos + amount && pos < current->pos + current->data.size())
+			eraseCachedBlock(current);
+	}
+}
+
+void ReadDriver::invalidateCache() {
+	discardReadahead();
+	cache.clear();
+	cacheIndex.clear();
+	cachedBytes = 0;
+}
+
+const ReadDriver::CachedBlock* ReadDriver::findCachedBlock(uint64_t pos) {
+	if(cacheMaxBytes == 0)
+		return nullptr;
+
+	const auto found = cacheIndex.find(pos);
+	if(found == cacheIndex.end()) {
+		cacheStats.misses++;
+		return nullptr;
+	}
+
+	const auto it = found->second;
+	if(std::chrono::steady_clock::now() - it->cachedAt > cacheLifetime) {
+		eraseCachedBlock(it);
+		cacheStats.misses++;
+		return nullptr;
+	}
+
+	cache.splice(cache.begin(), cache, it); // Now the most recently used
+	cacheStats.hits++;
+	return &*it;
+}
+
+bool ReadDriver::isCached(uint64_t pos) const {
+	const auto found = cacheIndex.find(pos);
+	return found != cacheIndex.end() && std::chrono::steady_clock::now() - found->second->cachedAt <= cacheLifetime;
+}
+
+void ReadDriver::cacheBlock(uint64_t pos, const uint8_t* data, size_t size) {
+	if(size > cacheMaxBytes)
+		return;
+
+	const auto found = cacheIndex.find(pos);
+	if(found != cacheIndex.end())
+		eraseCachedBlock(found->second);
+
+	while(cachedBytes + size > cacheMaxBytes) {
+		eraseCachedBlock(std::prev(cache.end()));
+		cacheStats.evictions++;
+	}
+
+	cache.emplace_front();
+	CachedBlock& block = cache.front();
+	block.pos = pos;
+	block.data.assign(data, data + size);
+	block.cachedAt = std::chrono::steady_clock::now();
+	cacheIndex[pos] = cache.begin();
+	cachedBytes += size;
+}
+
+void ReadDriver::eraseCachedBlock(std::list<CachedBlock>::iterator it) {
+	cachedBytes -= it->data.size();
+	cacheIndex.erase(it->pos);
+	cache.erase(it);
+}
+
+bool ReadDriver::beginReadLogicalDiskAligned(Communication&, device_eventhandler_t, uint64_t, uint8_t*, uint64_t) {
+	return false;
+}
+
+bool ReadDriver::finishReadLogicalDiskAligned(Communication&, uint64_t&, optional<uint64_t>&, std::chrono::milliseconds) {
+	return false;
+}
+
+void ReadDriver::cancelPipelinedReads(Communication&) {}
+
+optional<uint64_t> ReadDriver::readLogicalDiskPipelined(Communication& com, device_eventhandler_t report,
+	uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout) {
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	const auto timeLeft = [&deadline]() {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+	};
+
+	const uint32_t idealBlockSize = getBlockSizeBounds().second;
+	const uint64_t startBlock = pos / idealBlockSize;
+	const uint32_t posWithinFirstBlock = static_cast<uint32_t>(pos % idealBlockSize);
+	uint64_t blocks = amount / idealBlockSize + (amount % idealBlockSize ? 1 : 0);
+	if(blocks * idealBlockSize - posWithinFirstBlock < amount)
+		blocks++; // We need one more block to get the last partial block's worth
+
+	// Drop blocks read ahead which we have since passed, or which are too old to trust
+	const auto now = std::chrono::steady_clock::now();
+	for(auto it = pipelinedBlocks.begin(); it != pipelinedBlocks.end();) {
+		const PipelinedBlock& block = it->second;
+		if(block.finished && (it->first < startBlock * idealBlockSize || now - block.finishedAt > readaheadLifetime))
+			it = pipelinedBlocks.erase(it);
+		else
+			++it;
+	}
+
+	const bool streaming = (pos == streamingPos);
+	streamingPos = pos + amount;
+	const bool cacheable = (!streaming && amount <= cacheMaxReadSize);
+	const uint64_t endBlock = startBlock + blocks;
+	const uint64_t requestEndBlock = endBlock + (streaming ? readaheadBlocks : 0);
+	uint64_t nextRequest = startBlock;
+
+	// Failures reading ahead are not errors, the blocks may never be wanted
+	const device_eventhandler_t quiet = [](APIEvent::Type, APIEvent::Severity) {};
+
+	optional<uint64_t> ret;
+	std::vector<uint8_t> directReadBuffer;
+	uint64_t blocksProcessed = 0;
+	while(blocksProcessed < blocks) {
+		const uint64_t currentBlock = startBlock + blocksProcessed;
+
+		// The block we need may have been dropped after being requested, if readahead was discarded
+		if(!pipelinedBlocks.count(currentBlock * idealBlockSize) && !isCached(currentBlock * idealBlockSize))
+			nextRequest = std::min(nextRequest, currentBlock);
+
+		// Keep as many reads in flight as we're allowed
+		while(readsInFlight < maxOutstandingReads && nextRequest < requestEndBlock) {
+			const uint64_t blockPos = nextRequest * idealBlockSize;
+			if(pipelinedBlocks.count(blockPos) || isCached(blockPos)) {
+				nextRequest++;
+				continue; // Already in flight, read ahead, or cached
+			}
+
+			PipelinedBlock& block = pipelinedBlocks[blockPos];
+			block.data.resize(idealBlockSize);
+			if(!beginReadLogicalDiskAligned(com, nextRequest < endBlock ? report : quiet, blockPos, block.data.data(), idealBlockSize)) {
+				pipelinedBlocks.erase(blockPos);
+				break; // Try again once something has finished
+			}
+			readsInFlight++;
+			nextRequest++;
+		}
+
+		uint64_t intoOffset = blocksProcessed * idealBlockSize;
+		if(intoOffset < posWithinFirstBlock)
+			intoOffset = 0;
+		else
+			intoOffset -= posWithinFirstBlock;
+
+		const uint32_t posWithinCurrentBlock = (blocksProcessed ? 0 : posWithinFirstBlock);
+		uint32_t curAmt = idealBlockSize - posWithinCurrentBlock;
+		const auto amountLeft = amount - ret.value_or(0);
+		if(curAmt > amountLeft)
+			curAmt = static_cast<uint32_t>(amountLeft);
+
+		auto it = pipelinedBlocks.find(currentBlock * idealBlockSize);
+		if(it == pipelinedBlocks.end()) {
+			if(const CachedBlock* cached = findCachedBlock(currentBlock * idealBlockSize)) {
+				memcpy(into + intoOffset, cached->data.data() + posWithinCurrentBlock, curAmt);
+				if(!ret)
+					ret.emplace();
+				*ret += curAmt;
+				blocksProcessed++;
+				continue;
+			}
+		}
+
+		if((it != pipelinedBlocks.end() && !it->second.finished) || (it == pipelinedBlocks.end() && readsInFlight)) {
+			// Not here yet, wait for the next response
+			const auto left = timeLeft();
+			if(left <= std::chrono::milliseconds::zero() || !finishPipelinedRead(com, left)) {
+				report(APIEvent::Type::Timeout, APIEvent::Severity::Error);
+				abandonPipeline(com); // Otherwise a lost response would keep its block, and its slot, in flight forever
+				break;
+			}
+			continue;
+		}
+
+		optional<uint64_t> readAmount;
+		const uint8_t* readData;
+		if(it != pipelinedBlocks.end()) {
+			readAmount = it->second.result;
+			readData = it->second.data.data();
+		} else {
+			// The driver could not start this read with nothing else in flight, read it directly
+			if(directReadBuffer.size() < idealBlockSize)
+				directReadBuffer.resize(idealBlockSize);
+			readAmount = readLogicalDiskAligned(com, report, currentBlock * idealBlockSize, directReadBuffer.data(), idealBlockSize, timeLeft());
+			readData = directReadBuffer.data();
+			nextRequest = std::max(nextRequest, currentBlock + 1);
+		}
+
+		if(!readAmount.has_value() || *readAmount < curAmt) {
+			if(timeLeft() < std::chrono::milliseconds::zero())
+				report(APIEvent::Type::Timeout, APIEvent::Severity::Error);
+			else
+				report((blocksProcessed || readAmount.value_or(0u) != 0u) ? APIEvent::Type::EOFReached :
+					APIEvent::Type::ParameterOutOfRange, APIEvent::Severity::Error);
+			if(it != pipelinedBlocks.end())
+				pipelinedBlocks.erase(it);
+			break;
+		}
+
+		if(cacheable && *readAmount == idealBlockSize)
+			cacheBlock(currentBlock * idealBlockSize, readData, idealBlockSize);
+
+		memcpy(into + intoOffset, readData + posWithinCurrentBlock, curAmt);
+		if(it != pipelinedBlocks.end())
+			pipelinedBlocks.erase(it); // Each block is only used once
+
+		if(!ret)
+			ret.emplace();
+		*ret += std::min<uint64_t>(*readAmount, curAmt);
+		blocksProcessed++;
+	}
+
+	return ret;
+}
+
+bool ReadDriver::finishPipelinedRead(Communication& com, std::chrono::milliseconds timeout) {
+	uint64_t pos = 0;
+	optional<uint64_t> result;
+	if(!finishReadLogicalDiskAligned(com, pos, result, timeout))
+		return false;
+
+	readsInFlight--;
+	auto it = pipelinedBlocks.find(pos);
+	if(it == pipelinedBlocks.end())
+		return true;
+	if(it->second.discard) {
+		pipelinedBlocks.erase(it);
+		return true;
+	}
+	it->second.finished = true;
+	it->second.result = result;
+	it->second.finishedAt = std::chrono::steady_clock::now();
+	return true;
+}
+
+void ReadDriver::abandonPipeline(Communication& com) {
+	cancelPipelinedReads(com);
+	pipelinedBlocks.clear();
+	readsInFlight = 0;
+}
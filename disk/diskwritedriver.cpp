@@ -1,5 +1,6 @@
 #include "icsneo/disk/diskwritedriver.h"
 #include <cstring>
+#include <algorithm>
 
 using namespace icsneo;
 using namespace icsneo::Disk;
@@ -14,84 +15,83 @@ optional<uint64_t> WriteDriver::writeLogicalDisk(Communication& com, device_even
 
 	optional<uint64_t> ret;
 
+	const uint32_t sectorSize = getBlockSizeBounds().first;
 	const uint32_t idealBlockSize = getBlockSizeBounds().second;
 
-	// Write from here if we need to read-modify-write a block
-	// That would be the case either if we don't want some at the
-	// beginning or end of the block.
-	std::vector<uint8_t> alignedWriteBuffer;
-
+	// Only chunks with a partial sector at either end need to be
+	// read first, so the data we don't want to change is written back.
 	// Read to here, ideally this can be sent back to the device to
 	// ensure an operation is atomic
-	std::vector<uint8_t> atomicBuffer(idealBlockSize);
+	std::vector<uint8_t> atomicBuffer;
 
-	pos += vsaOffset;
-	const uint64_t startBlock = pos / idealBlockSize;
-	const uint32_t posWithinFirstBlock = static_cast<uint32_t>(pos % idealBlockSize);
-	uint64_t blocks = amount / idealBlockSize + (amount % idealBlockSize ? 1 : 0);
-	if(blocks * idealBlockSize - posWithinFirstBlock < amount)
-		blocks++; // We need one more block to get the last partial block's worth
-	uint64_t blocksProcessed = 0;
-
-	while(blocksProcessed < blocks && timeout >= std::chrono::milliseconds::zero()) {
-		const uint64_t currentBlock = startBlock + blocksProcessed;
-
-		uint64_t fromOffset = blocksProcessed * idealBlockSize;
-		if(fromOffset < posWithinFirstBlock)
-			fromOffset = 0;
-		else
-			fromOffset -= posWithinFirstBlock;
-
-		const uint32_t posWithinCurrentBlock = (blocksProcessed ? 0 : posWithinFirstBlock);
-		uint32_t curAmt = idealBlockSize - posWithinCurrentBlock;
-		const auto amountLeft = amount - ret.value_or(0);
-		if(curAmt > amountLeft)
-			curAmt = static_cast<uint32_t>(amountLeft);
-
-		auto start = std::chrono::high_resolution_clock::now();
-		const auto reportFromRead = [&report, &blocksProcessed](APIEvent::Type t, APIEvent::Severity s) {
-			if(t == APIEvent::Type::ParameterOutOfRange && blocksProcessed)
-				t = APIEvent::Type::EOFReached;
-			report(t, s);
-		};
-		auto bytesTransferred = readDriver.readLogicalDisk(com, reportFromRead, currentBlock * idealBlockSize,
-			atomicBuffer.data(), idealBlockSize, timeout);
-		timeout -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+	// Write from here if we need to read-modify-write a chunk
+	std::vector<uint8_t> alignedWriteBuffer;
 
-		if(bytesTransferred != idealBlockSize)
-			break; // readLogicalDisk reports its own errors
+	pos += vsaOffset;
+	const uint64_t end = pos + amount;
+	const uint64_t alignedStart = pos - (pos % sectorSize);
+	const uint64_t alignedEnd = end + (end % sectorSize ? sectorSize - (end % sectorSize) : 0);
+	uint64_t chunkStart = alignedStart;
+
+	// Any reads below for the read-modify-write must come from the disk rather than the cache
+	readDriver.invalidateCache(alignedStart, alignedEnd - alignedStart);
+
+	while(chunkStart < alignedEnd && timeout >= std::chrono::milliseconds::zero()) {
+		// Whole sectors are written together, up to the ideal block boundary
+		const uint64_t chunkEnd = std::min((chunkStart / idealBlockSize + 1) * idealBlockSize, alignedEnd);
+		const uint32_t chunkSize = static_cast<uint32_t>(chunkEnd - chunkStart);
+		const uint64_t dataStart = std::max(chunkStart, pos);
+		const uint64_t dataEnd = std::min(chunkEnd, end);
+		const uint32_t curAmt = static_cast<uint32_t>(dataEnd - dataStart);
+		const uint8_t* const chunkFrom = from + (dataStart - pos);
+		const bool readModifyWrite = (dataStart != chunkStart || dataEnd != chunkEnd);
+
+		optional<uint64_t> bytesTransferred;
+		if(readModifyWrite) {
+			auto start = std::chrono::high_resolution_clock::now();
+			const auto reportFromRead = [&report, &ret](APIEvent::Type t, APIEvent::Severity s) {
+				if(t == APIEvent::Type::ParameterOutOfRange && ret)
+					t = APIEvent::Type::EOFReached;
+				report(t, s);
+			};
+			atomicBuffer.resize(chunkSize);
+			bytesTransferred = readDriver.readLogicalDisk(com, reportFromRead, chunkStart, atomicBuffer.data(), chunkSize, timeout);
+			timeout -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+			if(bytesTransferred != chunkSize)
+				break; // readLogicalDisk reports its own errors
 
-		const bool useAlignedWriteBuffer = (posWithinCurrentBlock != 0 || curAmt != idealBlockSize);
-		if(useAlignedWriteBuffer) {
 			alignedWriteBuffer = atomicBuffer;
-			memcpy(alignedWriteBuffer.data() + posWithinCurrentBlock, from + fromOffset, curAmt);
+			memcpy(alignedWriteBuffer.data() + (dataStart - chunkStart), chunkFrom, curAmt);
 		}
 
-		start = std::chrono::high_resolution_clock::now();
-		bytesTransferred = writeLogicalDiskAligned(com, report, currentBlock * idealBlockSize, atomicBuffer.data(),
-			useAlignedWriteBuffer ? alignedWriteBuffer.data() : (from + fromOffset), idealBlockSize, timeout);
+		auto start = std::chrono::high_resolution_clock::now();
+		bytesTransferred = writeLogicalDiskAligned(com, report, chunkStart, readModifyWrite ? atomicBuffer.data() : nullptr,
+			readModifyWrite ? alignedWriteBuffer.data() : chunkFrom, chunkSize, timeout);
 		timeout -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
 
 		if(bytesTransferred == RetryAtomic) {
 			// The user may want to log these events in order to see how many atomic misses they are getting
 			report(APIEvent::Type::AtomicOperationRetried, APIEvent::Severity::EventInfo);
+			readDriver.invalidateCache(chunkStart, chunkSize);
 			continue;
 		}
 
-		if(!bytesTransferred.has_value() || *bytesTransferred < curAmt) {
+		if(!bytesTransferred.has_value() || *bytesTransferred < dataEnd - chunkStart) {
 			if(timeout < std::chrono::milliseconds::zero())
 				report(APIEvent::Type::Timeout, APIEvent::Severity::Error);
 			else
-				report((blocksProcessed || bytesTransferred.value_or(0u) != 0u) ? APIEvent::Type::EOFReached :
+				report((ret || bytesTransferred.value_or(0u) != 0u) ? APIEvent::Type::EOFReached :
 					APIEvent::Type::ParameterOutOfRange, APIEvent::Severity::Error);
 			break;
 		}
 
 		if(!ret)
 			ret.emplace();
-		*ret += std::min<uint64_t>(*bytesTransferred, curAmt);
-		blocksProcessed++;
+		*ret += curAmt;
+		chunkStart = chunkEnd;
 	}
 
+	readDriver.invalidateCache(alignedStart, alignedEnd - alignedStart);
 	return ret;
 }
\ No newline at end of file
@@ -3,18 +3,84 @@
 #include "ff.h"
 #include "diskio.h"
 #include <mutex>
+#include <condition_variable>
+#include <string>
 
 using namespace icsneo;
 
-// The FAT driver can only be accessed by one caller at a time, since it relies on globals
-static std::mutex fatDriverMutex;
-static std::function< optional<uint64_t>(uint64_t pos, uint8_t* into, uint64_t amount) > diskReadFn;
+namespace {
 
-extern "C" DRESULT disk_read(BYTE, BYTE* buff, LBA_t sector, UINT count) {
+/**
+ * FatFs keeps its state in globals, but separate volumes can be used
+ * from separate threads at the same time. Each lookup borrows a volume
+ * for the duration, so that lookups for different devices run in
+ * parallel, and only wait on each other if every volume is in use.
+ *
+ * Mounting and unmounting change the globals shared by every volume,
+ * and FatFs is built without FF_FS_REENTRANT, so those are done under
+ * volumesMutex. Only the lookup itself runs in parallel.
+ */
+class Volume {
+public:
+	Volume(Disk::DiskReadFn diskRead) {
+		std::unique_lock<std::mutex> lk(volumesMutex);
+		volumeFreed.wait(lk, [this] {
+			for(pdrv = 0; pdrv < FF_VOLUMES; pdrv++) {
+				if(!inUse[pdrv])
+					return true;
+			}
+			return false;
+		});
+		inUse[pdrv] = true;
+		diskReadFns[pdrv] = diskRead;
+	}
+
+	~Volume() {
+		{
+			std::lock_guard<std::mutex> lk(volumesMutex);
+			f_mount(nullptr, (const TCHAR*)path("").c_str(), 0); // The FATFS object is about to go away
+			diskReadFns[pdrv] = nullptr;
+			inUse[pdrv] = false;
+		}
+		volumeFreed.notify_one();
+	}
+
+	// Mounted right away, rather than on first use, so that it happens under the lock
+	bool mount() {
+		std::lock_guard<std::mutex> lk(volumesMutex);
+		return f_mount(&fs, (const TCHAR*)path("").c_str(), 1) == FR_OK;
+	}
+
+	std::string path(const char* file) const { return std::to_string(pdrv) + ":" + file; }
+
+	static optional<uint64_t> Read(BYTE pdrv, uint64_t pos, uint8_t* into, uint64_t amount) {
+		// Only the thread which holds this volume calls in for it, no lock required
+		return pdrv < FF_VOLUMES ? diskReadFns[pdrv](pos, into, amount) : nullopt;
+	}
+
+	FATFS fs = {};
+
+private:
+	static std::mutex volumesMutex;
+	static std::condition_variable volumeFreed;
+	static bool inUse[FF_VOLUMES];
+	static Disk::DiskReadFn diskReadFns[FF_VOLUMES];
+
+	BYTE pdrv;
+};
+
+std::mutex Volume::volumesMutex;
+std::condition_variable Volume::volumeFreed;
+bool Volume::inUse[FF_VOLUMES] = {};
+Disk::DiskReadFn Volume::diskReadFns[FF_VOLUMES];
+
+} // namespace
+
+extern "C" DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count) {
 	static_assert(Disk::SectorSize == 512, "FatFs expects 512 byte sectors");
 
 	const uint64_t expected = count * uint64_t(Disk::SectorSize);
-	const auto res = diskReadFn(sector * uint64_t(Disk::SectorSize), buff, expected);
+	const auto res = Volume::Read(pdrv, sector * uint64_t(Disk::SectorSize), buff, expected);
 	if (!res.has_value())
 		return RES_NOTRDY;
 	return res == expected ? RES_OK : RES_ERROR;
@@ -32,17 +98,24 @@ static uint64_t ClusterToSector(const FATFS& fs, DWORD cluster) {
 	return fs.database + (LBA_t)fs.csize * (cluster - 2);
 }
 
-optional<uint64_t> Disk::FindVSAInFAT(std::function< optional<uint64_t>(uint64_t pos, uint8_t* into, uint64_t amount) > diskRead) {
-	std::lock_guard<std::mutex> lk(fatDriverMutex);
-	diskReadFn = diskRead;
-
-	FATFS fs = {};
-	if (f_mount(&fs, (const TCHAR*)_TEXT(""), 0) != FR_OK)
+optional<Disk::VSAExtent> Disk::FindVSAExtentInFAT(DiskReadFn diskRead) {
+	Volume volume(diskRead);
+	if (!volume.mount())
 		return nullopt;
 
 	FIL logData = {};
-	if (f_open(&logData, (const TCHAR*)_TEXT("0:\\LOG_DATA.VSA"), FA_READ) != FR_OK)
+	if (f_open(&logData, (const TCHAR*)volume.path("\\LOG_DATA.VSA").c_str(), FA_READ) != FR_OK)
 		return nullopt;
 
-	return ClusterToSector(fs, logData.obj.sclust) * uint64_t(Disk::SectorSize);
-}
\ No newline at end of file
+	VSAExtent extent;
+	extent.offset = ClusterToSector(volume.fs, logData.obj.sclust) * uint64_t(Disk::SectorSize);
+	extent.size = logData.obj.objsize;
+	return extent;
+}
+
+optional<uint64_t> Disk::FindVSAInFAT(DiskReadFn diskRead) {
+	const auto extent = FindVSAExtentInFAT(diskRead);
+	if(!extent.has_value())
+		return nullopt;
+	return extent->offset;
+}
@@ -0,0 +1,201 @@
+#include "icsneo/disk/fileextractor.h"
+#include "icsneo/platform/renamefile.h"
+#include <fstream>
+#include <future>
+#include <algorithm>
+#include <cstdio>
+
+using namespace icsneo;
+using namespace icsneo::Disk;
+
+static constexpr const char* CheckpointMagic = "icsneo-extraction";
+static constexpr const unsigned CheckpointVersion = 1;
+
+uint32_t FileExtractor::CRC32(const uint8_t* data, size_t size, uint32_t crc) {
+	static const auto table = []() {
+		std::vector<uint32_t> t(256);
+		for(uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for(int bit = 0; bit < 8; bit++)
+				c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+			t[i] = c;
+		}
+		return t;
+	}();
+
+	crc = ~crc;
+	for(size_t i = 0; i < size; i++)
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+bool FileExtractor::extract(uint64_t pos, uint64_t amount, const std::string& path) {
+	if(chunkSize == 0 || checkpointInterval == 0) {
+		report(APIEvent::Type::ParameterOutOfRange, APIEvent::Severity::Error);
+		return false;
+	}
+
+	std::vector<Segment> segments = loadCheckpoint(pos, amount, path);
+	const uint64_t resumedAt = std::min<uint64_t>(segments.size() * checkpointInterval, amount);
+	checksum = segments.empty() ? 0 : segments.back().runningCrc;
+
+	std::fstream file;
+	if(segments.empty())
+		file.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+	else
+		file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+	if(!file.is_open() || !file.seekp(std::streamoff(resumedAt))) {
+		report(APIEvent::Type::ExtractionFileError, APIEvent::Severity::Error);
+		return false;
+	}
+
+	// Only touched by the write task while it is running
+	uint32_t segmentCrc = 0;
+	const auto writeChunk = [&](const std::vector<uint8_t>& chunk, uint64_t chunkPos) {
+		if(!file.write(reinterpret_cast<const char*>(chunk.data()), std::streamsize(chunk.size()))) {
+			report(APIEvent::Type::ExtractionFileError, APIEvent::Severity::Error);
+			return false;
+		}
+		segmentCrc = CRC32(chunk.data(), chunk.size(), segmentCrc);
+		checksum = CRC32(chunk.data(), chunk.size(), checksum);
+
+		const uint64_t end = chunkPos + chunk.size();
+		if(end % checkpointInterval == 0 || end == amount) {
+			segments.push_back({ segmentCrc, checksum });
+			segmentCrc = 0;
+			// The data must reach the file before the checkpoint claims it has
+			if(!file.flush()) {
+				report(APIEvent::Type::ExtractionFileError, APIEvent::Severity::Error);
+				return false;
+			}
+			return saveCheckpoint(pos, amount, path, segments);
+		}
+		return true;
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	auto lastProgress = start;
+	const auto sendProgress = [&](uint64_t extracted, bool force) {
+		const auto now = std::chrono::steady_clock::now();
+		if(!onProgress || (!force && now - lastProgress < progressInterval))
+			return;
+		lastProgress = now;
+
+		Progress progress;
+		progress.extracted = extracted;
+		progress.total = amount;
+		const double seconds = std::chrono::duration<double>(now - start).count();
+		if(seconds > 0)
+			progress.megabytesPerSecond = double(extracted - resumedAt) / (1024 * 1024) / seconds;
+		onProgress(progress);
+	};
+
+	// The disk is read into one buffer while the other is written out
+	std::vector<uint8_t> buffers[2];
+	size_t current = 0;
+	std::future<bool> writing;
+	bool ok = true;
+	uint64_t readPos = resumedAt;
+	sendProgress(readPos, true);
+	while(readPos < amount) {
+		// Reads never cross a checkpoint, so each segment's checksum is complete before the next starts
+		const uint64_t segmentEnd = (readPos / checkpointInterval + 1) * checkpointInterval;
+		const uint64_t size = std::min(std::min(chunkSize, segmentEnd - readPos), amount - readPos);
+		std::vector<uint8_t>& buffer = buffers[current];
+		buffer.resize(size_t(size));
+		const auto readAmount = diskRead(pos + readPos, buffer.data(), size);
+
+		if(writing.valid() && !writing.get()) {
+			ok = false;
+			break;
+		}
+		sendProgress(readPos, false);
+
+		if(readAmount != size) {
+			// The read reports its own errors, we'll pick up from the last checkpoint next time
+			ok = false;
+			break;
+		}
+
+		writing = std::async(std::launch::async, writeChunk, std::cref(buffer), readPos);
+		readPos += size;
+		current ^= 1;
+	}
+	if(writing.valid() && !writing.get())
+		ok = false;
+	if(!ok)
+		return false;
+
+	file.close();
+	std::remove(CheckpointPath(path).c_str());
+	sendProgress(amount, true);
+	return true;
+}
+
+std::vector<FileExtractor::Segment> FileExtractor::loadCheckpoint(uint64_t pos, uint64_t amount, const std::string& path) {
+	std::vector<Segment> segments;
+	std::ifstream checkpoint(CheckpointPath(path));
+	if(!checkpoint.is_open())
+		return segments; // Nothing to resume
+
+	std::string magic;
+	unsigned version = 0;
+	uint64_t checkpointPos = 0, checkpointAmount = 0, interval = 0;
+	checkpoint >> magic >> version >> checkpointPos >> checkpointAmount >> interval;
+	if(!checkpoint || magic != CheckpointMagic || version != CheckpointVersion ||
+		checkpointPos != pos || checkpointAmount != amount || interval != checkpointInterval) {
+		// This checkpoint is for a different extraction
+		report(APIEvent::Type::ExtractionRestarted, APIEvent::Severity::EventWarning);
+		return segments;
+	}
+
+	Segment segment;
+	while(segments.size() * checkpointInterval < amount && checkpoint >> std::hex >> segment.crc >> segment.runningCrc)
+		segments.push_back(segment);
+
+	// Make sure that what the checkpoint says was written is still there, as it was
+	std::ifstream file(path, std::ios::binary);
+	std::vector<uint8_t> buffer(size_t(std::min<uint64_t>(checkpointInterval, 4 * 1024 * 1024)));
+	uint32_t runningCrc = 0;
+	for(size_t i = 0; i < segments.size(); i++) {
+		uint64_t left = std::min<uint64_t>(checkpointInterval, amount - i * checkpointInterval);
+		uint32_t crc = 0;
+		while(left && file) {
+			const auto size = size_t(std::min<uint64_t>(left, buffer.size()));
+			file.read(reinterpret_cast<char*>(buffer.data()), std::streamsize(size));
+			crc = CRC32(buffer.data(), size, crc);
+			runningCrc = CRC32(buffer.data(), size, runningCrc);
+			left -= size;
+		}
+
+		if(!file || crc != segments[i].crc || runningCrc != segments[i].runningCrc) {
+			report(APIEvent::Type::ExtractionRestarted, APIEvent::Severity::EventWarning);
+			segments.resize(i);
+			break;
+		}
+	}
+	return segments;
+}
+
+bool FileExtractor::saveCheckpoint(uint64_t pos, uint64_t amount, const std::string& path, const std::vector<Segment>& segments) {
+	// Written alongside and then moved into place, so an interruption never leaves a partial checkpoint
+	const std::string checkpointPath = CheckpointPath(path);
+	const std::string temporaryPath = checkpointPath + ".tmp";
+	{
+		std::ofstream checkpoint(temporaryPath, std::ios::trunc);
+		checkpoint << CheckpointMagic << ' ' << CheckpointVersion << '\n'
+			<< pos << ' ' << amount << ' ' << checkpointInterval << '\n' << std::hex;
+		for(const auto& segment : segments)
+			checkpoint << segment.crc << ' ' << segment.runningCrc << '\n';
+		if(!checkpoint.flush()) {
+			report(APIEvent::Type::ExtractionFileError, APIEvent::Severity::Error);
+			return false;
+		}
+	}
+
+	if(!RenameFileReplacing(temporaryPath, checkpointPath)) {
+		report(APIEvent::Type::ExtractionFileError, APIEvent::Severity::Error);
+		return false;
+	}
+	return true;
+}
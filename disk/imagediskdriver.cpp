@@ -0,0 +1,105 @@
+#include "icsneo/disk/imagediskdriver.h"
+#include "icsneo/communication/driver.h"
+#include <cstring>
+#include <algorithm>
+#include <thread>
+
+using namespace icsneo;
+using namespace icsneo::Disk;
+
+namespace {
+
+// Stands in for the device's driver, the image is never actually communicated with
+class OfflineDriver : public icsneo::Driver {
+public:
+	using Driver::Driver;
+	bool open() override { return false; }
+	bool isOpen() override { return false; }
+	bool close() override { return true; }
+private:
+	void readTask() override {}
+	void writeTask() override {}
+};
+
+} // namespace
+
+ImageDiskDriver::ImageDiskDriver(device_eventhandler_t report) : report(report) {
+	const device_eventhandler_t ignore = [](APIEvent::Type, APIEvent::Severity) {};
+	offlineCom.reset(new Communication(ignore, std::unique_ptr<icsneo::Driver>(new OfflineDriver(ignore)), {}, nullptr, nullptr));
+}
+
+ImageDiskDriver::~ImageDiskDriver() {
+	close();
+}
+
+bool ImageDiskDriver::open(const std::string& path, bool writable) {
+	close();
+	if(!image.open(path, writable)) {
+		report(APIEvent::Type::DiskImageError, APIEvent::Severity::Error);
+		return false;
+	}
+	return true;
+}
+
+void ImageDiskDriver::close() {
+	flush();
+	image.close();
+	invalidateCache();
+}
+
+bool ImageDiskDriver::flush() {
+	return image.isOpen() && image.flush();
+}
+
+optional<uint64_t> ImageDiskDriver::readLogicalDisk(uint64_t pos, uint8_t* into, uint64_t amount) {
+	return ReadDriver::readLogicalDisk(*offlineCom, report, pos, into, amount);
+}
+
+optional<uint64_t> ImageDiskDriver::writeLogicalDisk(uint64_t pos, const uint8_t* from, uint64_t amount) {
+	return WriteDriver::writeLogicalDisk(*offlineCom, report, *this, pos, from, amount);
+}
+
+optional<uint64_t> ImageDiskDriver::readLogicalDiskAligned(Communication&, device_eventhandler_t report,
+	uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds) {
+	if(!image.isOpen()) {
+		report(APIEvent::Type::DiskImageError, APIEvent::Severity::Error);
+		return nullopt;
+	}
+
+	if(pos % SectorSize != 0 || amount > maxBlockSize || pos >= image.getSize())
+		return nullopt;
+
+	if(latency.count())
+		std::this_thread::sleep_for(latency);
+
+	const uint64_t readAmount = std::min(amount, image.getSize() - pos);
+	memcpy(into, image.getData() + pos, size_t(readAmount));
+	return readAmount;
+}
+
+optional<uint64_t> ImageDiskDriver::writeLogicalDiskAligned(Communication&, device_eventhandler_t report,
+	uint64_t pos, const uint8_t* atomicBuf, const uint8_t* from, uint64_t amount, std::chrono::milliseconds) {
+	if(!image.isOpen()) {
+		report(APIEvent::Type::DiskImageError, APIEvent::Severity::Error);
+		return nullopt;
+	}
+
+	if(!image.isWritable()) {
+		report(APIEvent::Type::DiskNotSupported, APIEvent::Severity::Error);
+		return nullopt;
+	}
+
+	if(pos % SectorSize != 0 || amount > maxBlockSize || pos >= image.getSize())
+		return nullopt;
+
+	if(latency.count())
+		std::this_thread::sleep_for(latency);
+
+	const uint64_t writeAmount = std::min(amount, image.getSize() - pos);
+	uint8_t* const at = image.getData() + pos;
+	if(atomicBuf && memcmp(at, atomicBuf, size_t(writeAmount)) != 0)
+		return RetryAtomic;
+
+	memcpy(at, from, size_t(writeAmount));
+	return writeAmount;
+}
@@ -5,49 +5,130 @@
 using namespace icsneo;
 using namespace icsneo::Disk;
 
+static std::shared_ptr<MessageFilter> NeoMemorySDRead = std::make_shared<MessageFilter>(Network::NetID::NeoMemorySDRead);
+
+bool NeoMemoryDiskDriver::SendReadCommand(Communication& com, uint64_t sector) {
+	return com.sendCommand(Command::NeoReadMemory, {
+		MemoryTypeSD,
+		uint8_t(sector & 0xFF),
+		uint8_t((sector >> 8) & 0xFF),
+		uint8_t((sector >> 16) & 0xFF),
+		uint8_t((sector >> 24) & 0xFF),
+		uint8_t(SectorSize & 0xFF),
+		uint8_t((SectorSize >> 8) & 0xFF),
+		uint8_t((SectorSize >> 16) & 0xFF),
+		uint8_t((SectorSize >> 24) & 0xFF)
+	});
+}
+
 optional<uint64_t> NeoMemoryDiskDriver::readLogicalDiskAligned(Communication& com, device_eventhandler_t report,
 	uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout) {
-	static std::shared_ptr<MessageFilter> NeoMemorySDRead = std::make_shared<MessageFilter>(Network::NetID::NeoMemorySDRead);
-
 	if(pos % SectorSize != 0)
 		return nullopt;
 
 	if(amount != SectorSize)
 		return nullopt;
 
-	if(cachePos != pos || std::chrono::steady_clock::now() > cachedAt + CacheTime) {
-		// The cache does not have this data, go get it
-		const uint64_t currentSector = pos / SectorSize;
-		auto msg = com.waitForMessageSync([&currentSector, &com] {
-			return com.sendCommand(Command::NeoReadMemory, {
-				MemoryTypeSD,
-				uint8_t(currentSector & 0xFF),
-				uint8_t((currentSector >> 8) & 0xFF),
-				uint8_t((currentSector >> 16) & 0xFF),
-				uint8_t((currentSector >> 24) & 0xFF),
-				uint8_t(SectorSize & 0xFF),
-				uint8_t((SectorSize >> 8) & 0xFF),
-				uint8_t((SectorSize >> 16) & 0xFF),
-				uint8_t((SectorSize >> 24) & 0xFF)
-			});
-		}, NeoMemorySDRead, timeout);
-
-		if(!msg)
-			return 0;
+	const uint64_t currentSector = pos / SectorSize;
+	auto msg = com.waitForMessageSync([&currentSector, &com] {
+		return SendReadCommand(com, currentSector);
+	}, NeoMemorySDRead, timeout);
+
+	if(!msg)
+		return 0;
+
+	const auto sdmsg = std::dynamic_pointer_cast<NeoReadMemorySDMessage>(msg);
+	if(!sdmsg || sdmsg->data.size() != SectorSize) {
+		report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+		return nullopt;
+	}
+
+	memcpy(into, sdmsg->data.data(), SectorSize);
+	return SectorSize;
+}
+
+bool NeoMemoryDiskDriver::beginReadLogicalDiskAligned(Communication& com, device_eventhandler_t report,
+	uint64_t pos, uint8_t* into, uint64_t amount) {
+	if(pos % SectorSize != 0)
+		return false;
+
+	if(amount != SectorSize)
+		return false;
+
+	const uint64_t sector = pos / SectorSize;
+	if(sector > std::numeric_limits<uint32_t>::max() || pendingReads.count(uint32_t(sector)))
+		return false;
+
+	if(pipelineCallback == -1) {
+		const auto responses = pipelineResponses;
+		pipelineCallback = com.addMessageCallback(MessageCallback([responses](std::shared_ptr<Message> msg) {
+			{
+				std::lock_guard<std::mutex> lk(responses->mutex);
+				responses->responses.push_back(msg);
+			}
+			responses->cv.notify_all();
+		}, NeoMemorySDRead));
+	}
+	pipelineReport = report;
+
+	pendingReads[uint32_t(sector)] = { pos, into };
+	if(!SendReadCommand(com, sector)) {
+		pendingReads.erase(uint32_t(sector));
+		return false;
+	}
+	return true;
+}
+
+bool NeoMemoryDiskDriver::finishReadLogicalDiskAligned(Communication& com, uint64_t& pos, optional<uint64_t>& result,
+	std::chrono::milliseconds timeout) {
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	while(!pendingReads.empty()) {
+		std::shared_ptr<Message> msg;
+		{
+			std::unique_lock<std::mutex> lk(pipelineResponses->mutex);
+			if(!pipelineResponses->cv.wait_until(lk, deadline, [this] { return !pipelineResponses->responses.empty(); }))
+				return false;
+			msg = std::move(pipelineResponses->responses.front());
+			pipelineResponses->responses.pop_front();
+		}
 
+		// Responses are matched by the sector they carry, as one may be lost, or come from a read since cancelled
 		const auto sdmsg = std::dynamic_pointer_cast<NeoReadMemorySDMessage>(msg);
-		if(!sdmsg || sdmsg->data.size() != SectorSize) {
-			report(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
-			return nullopt;
+		const auto it = sdmsg ? pendingReads.find(sdmsg->startAddress) : pendingReads.end();
+		if(it == pendingReads.end()) {
+			if(pipelineReport)
+				pipelineReport(APIEvent::Type::PacketDecodingError, APIEvent::Severity::Error);
+			continue;
 		}
 
-		memcpy(cache.data(), sdmsg->data.data(), SectorSize);
-		cachedAt = std::chrono::steady_clock::now();
-		cachePos = pos;
+		pos = it->second.pos;
+		if(sdmsg->data.size() != SectorSize) {
+			result = nullopt;
+		} else {
+			memcpy(it->second.into, sdmsg->data.data(), SectorSize);
+			result = SectorSize;
+		}
+		pendingReads.erase(it);
+
+		if(pendingReads.empty())
+			stopPipeline(com);
+		return true;
 	}
+	return false;
+}
 
-	memcpy(into, cache.data(), SectorSize);
-	return SectorSize;
+void NeoMemoryDiskDriver::cancelPipelinedReads(Communication& com) {
+	pendingReads.clear();
+	stopPipeline(com);
+}
+
+void NeoMemoryDiskDriver::stopPipeline(Communication& com) {
+	if(pipelineCallback != -1) {
+		com.removeMessageCallback(pipelineCallback);
+		pipelineCallback = -1;
+	}
+	std::lock_guard<std::mutex> lk(pipelineResponses->mutex);
+	pipelineResponses->responses.clear(); // Anything left over did not answer one of our requests
 }
 
 optional<uint64_t> NeoMemoryDiskDriver::writeLogicalDiskAligned(Communication& com, device_eventhandler_t report,
@@ -61,10 +142,6 @@ optional<uint64_t> NeoMemoryDiskDriver::writeLogicalDiskAligned(Communication& c
 	if(amount != SectorSize)
 		return nullopt;
 
-	// Clear the cache if we're writing to the cached sector
-	if(pos == cachePos)
-		cachedAt = std::chrono::time_point<std::chrono::steady_clock>();
-
 	// Requesting an atomic operation, but neoMemory does not support it
 	// Continue on anyway but warn the caller
 	if(atomicBuf != nullptr)
@@ -19,60 +19,51 @@ optional<uint64_t> PlasionDiskReadDriver::readLogicalDiskAligned(Communication&
 	if(pos % getBlockSizeBounds().first != 0)
 		return nullopt;
 
-	if(cachePos != pos || std::chrono::steady_clock::now() > cachedAt + CacheTime) {
-		uint64_t largeSector = pos / SectorSize;
-		uint32_t sector = uint32_t(largeSector);
-		if (largeSector != uint64_t(sector))
-			return nullopt;
+	uint64_t largeSector = pos / SectorSize;
+	uint32_t sector = uint32_t(largeSector);
+	if (largeSector != uint64_t(sector))
+		return nullopt;
 
-		// The cache does not have this data, go get it
-		std::mutex m;
-		std::condition_variable cv;
-		uint32_t copied = 0;
-		bool error = false;
+	std::mutex m;
+	std::condition_variable cv;
+	uint32_t copied = 0;
+	bool error = false;
+	std::unique_lock<std::mutex> lk(m);
+	auto cb = com.addMessageCallback(MessageCallback([&](std::shared_ptr<Message> msg) {
 		std::unique_lock<std::mutex> lk(m);
-		auto cb = com.addMessageCallback(MessageCallback([&](std::shared_ptr<Message> msg) {
-			std::unique_lock<std::mutex> lk(m);
-
-			const auto sdmsg = std::dynamic_pointer_cast<NeoReadMemorySDMessage>(msg);
-			if(!sdmsg || cache.size() < copied + sdmsg->data.size()) {
-				error = true;
-				lk.unlock();
-				cv.notify_all();
-				return;
-			}
 
-			// Invalidate the cache here in case we fail half-way through
-			cachedAt = std::chrono::steady_clock::time_point();
+		const auto sdmsg = std::dynamic_pointer_cast<NeoReadMemorySDMessage>(msg);
+		if(!sdmsg || readBuffer.size() < copied + sdmsg->data.size()) {
+			error = true;
+			lk.unlock();
+			cv.notify_all();
+			return;
+		}
 
-			memcpy(cache.data() + copied, sdmsg->data.data(), sdmsg->data.size());
-			copied += uint32_t(sdmsg->data.size());
-			if(copied == amount) {
-				lk.unlock();
-				cv.notify_all();
-			}
-		}, NeoMemorySDRead));
+		memcpy(readBuffer.data() + copied, sdmsg->data.data(), sdmsg->data.size());
+		copied += uint32_t(sdmsg->data.size());
+		if(copied == amount) {
+			lk.unlock();
+			cv.notify_all();
+		}
+	}, NeoMemorySDRead));
 
-		com.rawWrite({
-			uint8_t(MultiChannelCommunication::CommandType::HostPC_from_SDCC1),
-			uint8_t(sector & 0xFF),
-			uint8_t((sector >> 8) & 0xFF),
-			uint8_t((sector >> 16) & 0xFF),
-			uint8_t((sector >> 24) & 0xFF),
-			uint8_t(amount & 0xFF),
-			uint8_t((amount >> 8) & 0xFF),
-		});
+	com.rawWrite({
+		uint8_t(MultiChannelCommunication::CommandType::HostPC_from_SDCC1),
+		uint8_t(sector & 0xFF),
+		uint8_t((sector >> 8) & 0xFF),
+		uint8_t((sector >> 16) & 0xFF),
+		uint8_t((sector >> 24) & 0xFF),
+		uint8_t(amount & 0xFF),
+		uint8_t((amount >> 8) & 0xFF),
+	});
 
-		bool hitTimeout = !cv.wait_for(lk, timeout, [&copied, &error, &amount] { return error || copied == amount; });
-		com.removeMessageCallback(cb);
+	bool hitTimeout = !cv.wait_for(lk, timeout, [&copied, &error, &amount] { return error || copied == amount; });
+	com.removeMessageCallback(cb);
 
-		if(hitTimeout)
-			return nullopt;
-
-		cachedAt = std::chrono::steady_clock::now();
-		cachePos = pos;
-	}
+	if(hitTimeout)
+		return nullopt;
 
-	memcpy(into, cache.data(), size_t(amount));
+	memcpy(into, readBuffer.data(), size_t(amount));
 	return amount;
 }
\ No newline at end of file
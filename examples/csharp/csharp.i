@@ -41,6 +41,7 @@
 %apply int *INOUT {size_t *};
 
 %ignore icsneo_addMessageCallback;
+%ignore icsneo_addBatchMessageCallback;
 %ignore icsneo_removeMessageCallback;
 %ignore icsneo_addEventCallback;
 %ignore icsneo_removeEventCallback;
@@ -86,6 +86,10 @@ public:
 		SettingsDefaultsUsed = 0x2033,
 		AtomicOperationRetried = 0x2034,
 		AtomicOperationCompletedNonatomically = 0x2035,
+		PreparedTransmitNotSupported = 0x2036,
+		ExtractionFileError = 0x2037,
+		ExtractionRestarted = 0x2038,
+		DiskImageError = 0x2039,
 
 		// Transport Events
 		FailedToRead = 0x3000,
@@ -95,6 +99,8 @@ public:
 		PacketChecksumError = 0x3004,
 		TransmitBufferFull = 0x3005,
 		DeviceInUse = 0x3006,
+		MTUNotSupported = 0x3007,
+		DecodeQueueOverflow = 0x3008,
 		PCAPCouldNotStart = 0x3102,
 		PCAPCouldNotFindDevices = 0x3103,
 		PacketDecodingError = 0x3104,
@@ -8,6 +8,7 @@
 #include "icsneo/communication/network.h"
 #include "icsneo/communication/packet.h"
 #include "icsneo/communication/message/callback/messagecallback.h"
+#include "icsneo/communication/message/callback/batchmessagecallback.h"
 #include "icsneo/communication/message/serialnumbermessage.h"
 #include "icsneo/communication/message/logicaldiskinfomessage.h"
 #include "icsneo/device/deviceversion.h"
@@ -15,12 +16,14 @@
 #include "icsneo/communication/packetizer.h"
 #include "icsneo/communication/encoder.h"
 #include "icsneo/communication/decoder.h"
+#include "icsneo/third-party/readerwriterqueue/readerwriterqueue.h"
 #include <memory>
 #include <vector>
 #include <atomic>
 #include <thread>
 #include <queue>
 #include <map>
+#include <chrono>
 
 namespace icsneo {
 
@@ -45,7 +48,9 @@ public:
 	void modeChangeIncoming() { driver->modeChangeIncoming(); }
 	void awaitModeChangeComplete() { driver->awaitModeChangeComplete(); }
 	bool rawWrite(const std::vector<uint8_t>& bytes) { return driver->write(bytes); }
+	bool rawWrite(const uint8_t* bytes, size_t size) { return driver->write(bytes, size); }
 	virtual bool sendPacket(std::vector<uint8_t>& bytes);
+	virtual bool sendPacket(EncodeBuffer& bytes);
 	bool redirectRead(std::function<void(std::vector<uint8_t>&&)> redirectTo);
 	void clearRedirectRead();
 
@@ -60,7 +65,23 @@ public:
 	std::shared_ptr<LogicalDiskInfoMessage> getLogicalDiskInfoSync(std::chrono::milliseconds timeout = std::chrono::milliseconds(50));
 
 	int addMessageCallback(const MessageCallback& cb);
-	bool removeMessageCallback(int id);
+	int addMessageCallback(const BatchMessageCallback& cb);
+	bool removeMessageCallback(int id); // Removes either kind of callback
+
+	/**
+	 * Frame traffic (CAN, Ethernet, etc.) on a network which no message
+	 * callback could want is dropped right after packetizing, before it is
+	 * decoded. Internal traffic is always decoded.
+	 *
+	 * The subscribed networks are recalculated whenever a callback is added
+	 * or removed, see MessageFilter::mayMatchNetwork(). Call
+	 * refreshSubscriptions() if what an existing filter may match changes.
+	 */
+	bool isSubscribed(const Network& network) const;
+	void refreshSubscriptions();
+
+	// Every packet received, including those dropped as unsubscribed
+	uint64_t getReceivedPacketCount() const { return receivedPackets; }
 	std::shared_ptr<Message> waitForMessageSync(
 		const std::shared_ptr<MessageFilter>& f = {},
 		std::chrono::milliseconds timeout = std::chrono::milliseconds(50)) {
@@ -73,8 +94,49 @@ public:
 		const std::shared_ptr<MessageFilter>& f = {},
 		std::chrono::milliseconds timeout = std::chrono::milliseconds(50));
 
+	class PipelineStats {
+	public:
+		class Stage {
+		public:
+			size_t queueDepth = 0; // Currently waiting for this stage
+			size_t maxQueueDepth = 0;
+			uint64_t processed = 0;
+			std::chrono::nanoseconds totalProcessingTime{0};
+			std::chrono::nanoseconds maxProcessingTime{0};
+			std::chrono::nanoseconds totalQueueLatency{0}; // Time spent waiting for this stage
+			std::chrono::nanoseconds maxQueueLatency{0};
+		};
+
+		// Queue depth is in bytes waiting in the driver, processed counts driver reads.
+		// The driver does not timestamp its bytes, so queue latency is not tracked.
+		Stage packetizing;
+
+		// Queue depth is in packets waiting to be decoded, processed counts packets
+		Stage decoding;
+
+		uint64_t overflows = 0; // Packets dropped because the decode queue was full
+	};
+
+	/**
+	 * In pipelined mode, one thread packetizes the incoming bytes while
+	 * another decodes the packets and dispatches the resulting messages.
+	 * A slow message callback will then fill the decode queue rather than
+	 * holding up reads from the driver.
+	 *
+	 * The decode queue holds up to pipelineQueueSize packets. If it fills,
+	 * new packets are dropped and counted in the PipelineStats. A warning
+	 * is reported when it first fills, and again only once it has drained.
+	 *
+	 * Changes take effect the next time communication is opened.
+	 */
+	bool pipelined = false;
+	size_t pipelineQueueSize = 4096;
+	PipelineStats getPipelineStats() const;
+	void resetPipelineStats();
+
 	std::function<std::unique_ptr<Packetizer>()> makeConfiguredPacketizer;
 	std::unique_ptr<Packetizer> packetizer;
+	EncodeBufferPool encodeBuffers; // For outgoing packets, so their allocations are reused
 	std::unique_ptr<Encoder> encoder;
 	std::unique_ptr<Decoder> decoder;
 	std::unique_ptr<Driver> driver;
@@ -84,17 +146,57 @@ protected:
 	static int messageCallbackIDCounter;
 	std::mutex messageCallbacksLock;
 	std::map<int, MessageCallback> messageCallbacks;
+	std::map<int, BatchMessageCallback> batchMessageCallbacks;
 	std::atomic<bool> closing{false};
 	std::atomic<bool> redirectingRead{false};
 	std::function<void(std::vector<uint8_t>&&)> redirectionFn;
 	std::mutex redirectingReadMutex; // Don't allow read to be disabled while in the redirectionFn
 
+	// One bit per NetID, only the frame networks are ever set
+	static constexpr size_t SubscriptionWords = (Network::NetIDTableSize + 63) / 64;
+	std::atomic<uint64_t> subscribedNetworks[SubscriptionWords] = {};
+	std::atomic<uint64_t> receivedPackets{0};
+	void updateSubscriptions(); // Called with the messageCallbacksLock held
+
 	void dispatchMessage(const std::shared_ptr<Message>& msg);
+	// Deliver the batches which are ready, either at the end of a read or when idle
+	void flushBatchMessageCallbacks(bool endOfRead);
 	void handleInput(Packetizer& p, std::vector<uint8_t>& readBytes);
 
 private:
+	class PipelinedPacket {
+	public:
+		std::shared_ptr<Packet> packet;
+		std::chrono::steady_clock::time_point enqueued;
+	};
+
+	class StageCounters {
+	public:
+		std::atomic<size_t> maxQueueDepth{0};
+		std::atomic<uint64_t> processed{0};
+		std::atomic<int64_t> totalProcessingTime{0}; // In nanoseconds
+		std::atomic<int64_t> maxProcessingTime{0};
+		std::atomic<int64_t> totalQueueLatency{0};
+		std::atomic<int64_t> maxQueueLatency{0};
+
+		// Only ever called from the thread running the stage
+		void record(size_t queueDepth, std::chrono::nanoseconds processingTime, std::chrono::nanoseconds queueLatency);
+		void reset();
+		PipelineStats::Stage get() const;
+	};
+
 	std::thread readTaskThread;
 	void readTask();
+
+	std::atomic<bool> pipelineActive{false};
+	std::unique_ptr< moodycamel::BlockingReaderWriterQueue<PipelinedPacket> > pipelineQueue;
+	std::thread decodeTaskThread;
+	StageCounters packetizingCounters;
+	StageCounters decodingCounters;
+	std::atomic<uint64_t> pipelineOverflows{0};
+	bool pipelineOverflowing = false; // Only used by the read thread, so each overflow is only reported once
+	void decodeTask();
+	void decodeAndDispatch(const std::shared_ptr<Packet>& packet);
 };
 
 }
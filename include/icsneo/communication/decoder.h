@@ -8,10 +8,12 @@
 #include "icsneo/communication/packet.h"
 #include "icsneo/communication/network.h"
 #include "icsneo/communication/packet/iso9141packet.h"
+#include "icsneo/communication/command.h"
 #include "icsneo/api/eventmanager.h"
 #include <queue>
 #include <vector>
 #include <memory>
+#include <functional>
 
 namespace icsneo {
 
@@ -19,15 +21,72 @@ class Decoder {
 public:
 	static uint64_t GetUInt64FromLEBytes(const uint8_t* bytes);
 
-	Decoder(device_eventhandler_t report) : report(report) {}
+	// Returns false if no message should be produced for this packet
+	typedef std::function< bool(Decoder&, std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) > DecodeFunction;
+
+	Decoder(device_eventhandler_t report);
 	bool decode(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
 
+	/**
+	 * Packets are decoded by looking up their NetID in a table, and Main51
+	 * packets by looking up their command as well.
+	 *
+	 * Devices with their own packet formats can replace entries here, usually
+	 * from Device::setupDecoder(). Setting an empty function restores the default.
+	 * Packets on NetIDs without an entry are passed along as RawMessages.
+	 */
+	void setDecodeFunction(Network::NetID netid, DecodeFunction fn);
+	void setDecodeFunction(Command main51Command, DecodeFunction fn);
+
+	// The default handling for packets on this NetID, for custom decode functions to fall back on
+	bool decodeDefault(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+
 	uint16_t timestampResolution = 25;
+	device_eventhandler_t report;
+
+	/**
+	 * LIN frames are passed along as RawMessages, as they always have been,
+	 * unless this is set. The HardwareLINPacket layout behind LINMessage has
+	 * not yet been confirmed against records captured from a device.
+	 */
+	bool decodeLINMessages = false;
 
 private:
-	device_eventhandler_t report;
+	typedef bool (Decoder::*BuiltinDecodeFunction)(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	class DecodeEntry {
+	public:
+		BuiltinDecodeFunction builtin = nullptr;
+		DecodeFunction custom; // Takes precedence over the builtin if set
+	};
+	class DecodeTables {
+	public:
+		std::vector<DecodeEntry> netid; // Indexed by NetID
+		std::vector<DecodeEntry> main51; // Indexed by Command
+	};
+	static const DecodeTables& DefaultDecodeTables();
+	DecodeTables tables;
+
 	HardwareISO9141Packet::Decoder iso9141decoder;
 
+	bool decodeEthernet(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeCAN(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeFlexRay(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeISO9141(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeLIN(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeResetStatus(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeDevice(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeDeviceStatus(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeNeoMemorySDRead(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeFlexRayControl(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeMain51(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeSerialNumber(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeMainVersion(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeSecondaryVersions(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeOldFormat(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeReadSettings(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeLogicalDiskInfo(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+	bool decodeEthPHYControl(std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet);
+
 #pragma pack(push, 1)
 
 #ifdef _MSC_VER
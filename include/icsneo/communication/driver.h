@@ -26,9 +26,27 @@ public:
 	virtual bool close() = 0;
 	bool read(std::vector<uint8_t>& bytes, size_t limit = 0);
 	bool readWait(std::vector<uint8_t>& bytes, std::chrono::milliseconds timeout = std::chrono::milliseconds(100), size_t limit = 0);
-	bool write(const std::vector<uint8_t>& bytes);
+	bool write(const std::vector<uint8_t>& bytes) { return write(bytes.data(), bytes.size()); }
+	bool write(const uint8_t* bytes, size_t size);
+	size_t getReadQueueSize() const { return readQueue.size_approx(); }
 	virtual bool isEthernet() const { return false; }
 
+	/**
+	 * For drivers which frame their traffic in Ethernet packets, the MTU
+	 * currently in use. Zero is returned for other drivers.
+	 */
+	virtual size_t getMTU() const { return 0; }
+
+	/**
+	 * Request a larger or smaller MTU for Ethernet framing, such as 9000
+	 * for jumbo frames. The MTU will not exceed that of the interface,
+	 * and can only be changed while the driver is closed.
+	 */
+	virtual bool setMTU(size_t) {
+		report(APIEvent::Type::MTUNotSupported, APIEvent::Severity::Error);
+		return false;
+	}
+
 	device_eventhandler_t report;
 
 	size_t writeQueueSize = 50;
@@ -39,6 +57,7 @@ protected:
 	public:
 		WriteOperation() {}
 		WriteOperation(const std::vector<uint8_t>& b) : bytes(b) {}
+		WriteOperation(const uint8_t* b, size_t size) : bytes(b, b + size) {}
 		std::vector<uint8_t> bytes;
 	};
 	enum IOTaskState {
@@ -52,7 +71,7 @@ protected:
 	// Overridable in case the driver doesn't want to use writeTask and writeQueue
 	virtual bool writeQueueFull() { return writeQueue.size_approx() > writeQueueSize; }
 	virtual bool writeQueueAlmostFull() { return writeQueue.size_approx() > (writeQueueSize * 3 / 4); }
-	virtual bool writeInternal(const std::vector<uint8_t>& b) { return writeQueue.enqueue(WriteOperation(b)); }
+	virtual bool writeInternal(const uint8_t* b, size_t size) { return writeQueue.enqueue(WriteOperation(b, size)); }
 
 	moodycamel::BlockingConcurrentQueue<uint8_t> readQueue;
 	moodycamel::BlockingConcurrentQueue<WriteOperation> writeQueue;
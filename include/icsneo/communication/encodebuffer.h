@@ -0,0 +1,113 @@
+#ifndef __ENCODEBUFFER_H_
+#define __ENCODEBUFFER_H_
+
+#ifdef __cplusplus
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+namespace icsneo {
+
+/**
+ * A buffer for outgoing packets with space reserved in front of the data.
+ *
+ * The payload is encoded first, then each layer (the encoder, the packetizer,
+ * and the multichannel framing for some devices) prepends its header into the
+ * headroom rather than shifting the whole payload with an insert at the front.
+ */
+class EncodeBuffer {
+public:
+	// Enough for every header the encoding layers prepend
+	static const size_t DefaultHeadroom;
+
+	EncodeBuffer(size_t headroom = DefaultHeadroom) { clear(headroom); }
+
+	// Empty the buffer, keeping its allocation
+	void clear(size_t headroom = DefaultHeadroom) {
+		storage.resize(headroom);
+		offset = headroom;
+	}
+
+	/**
+	 * The vector the payload is appended to, for the packet encoders
+	 * which write into a std::vector. Everything before getOffset()
+	 * is headroom, so only append to it.
+	 */
+	std::vector<uint8_t>& getStorage() { return storage; }
+	size_t getOffset() const { return offset; }
+
+	void prepend(std::initializer_list<uint8_t> header) { prepend(header.begin(), header.size()); }
+	void prepend(const uint8_t* header, size_t length) {
+		if(length > offset) {
+			// Out of headroom, shift everything once to make more
+			const size_t grow = length - offset + DefaultHeadroom;
+			storage.insert(storage.begin(), grow, 0);
+			offset += grow;
+		}
+		offset -= length;
+		if(length)
+			memcpy(storage.data() + offset, header, length);
+	}
+
+	void push_back(uint8_t byte) { storage.push_back(byte); }
+	void append(const uint8_t* bytes, size_t length) { storage.insert(storage.end(), bytes, bytes + length); }
+	void append(const std::vector<uint8_t>& bytes) { append(bytes.data(), bytes.size()); }
+
+	uint8_t* data() { return storage.data() + offset; }
+	const uint8_t* data() const { return storage.data() + offset; }
+	size_t size() const { return storage.size() - offset; }
+	bool empty() const { return size() == 0; }
+	uint8_t& operator[](size_t i) { return storage[offset + i]; }
+	const uint8_t& operator[](size_t i) const { return storage[offset + i]; }
+	uint8_t* begin() { return data(); }
+	uint8_t* end() { return storage.data() + storage.size(); }
+	const uint8_t* begin() const { return data(); }
+	const uint8_t* end() const { return storage.data() + storage.size(); }
+
+	std::vector<uint8_t> toVector() const { return std::vector<uint8_t>(begin(), end()); }
+
+private:
+	std::vector<uint8_t> storage;
+	size_t offset = 0;
+};
+
+/**
+ * Keeps EncodeBuffers around between transmits so that their
+ * allocations can be reused. Each Communication has one.
+ */
+class EncodeBufferPool {
+public:
+	// Buffers beyond this many, or which have grown past MaxPooledCapacity, are freed when released
+	static const size_t MaxPooledBuffers;
+	static const size_t MaxPooledCapacity;
+
+	class Releaser {
+	public:
+		Releaser(EncodeBufferPool* p = nullptr) : pool(p) {}
+		void operator()(EncodeBuffer* buffer) const;
+	private:
+		EncodeBufferPool* pool;
+	};
+	// Returned to the pool when it goes out of scope, which must be before the pool is destroyed
+	typedef std::unique_ptr<EncodeBuffer, Releaser> Lease;
+
+	// The buffer returned is empty, with the default headroom
+	Lease acquire();
+	size_t getPooledCount() const;
+
+private:
+	void release(EncodeBuffer* buffer);
+
+	mutable std::mutex mutex;
+	std::vector<std::unique_ptr<EncodeBuffer>> buffers;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
@@ -9,6 +9,8 @@
 #include "icsneo/communication/command.h"
 #include "icsneo/communication/network.h"
 #include "icsneo/communication/packetizer.h"
+#include "icsneo/communication/encodebuffer.h"
+#include "icsneo/communication/preparedframe.h"
 #include <queue>
 #include <vector>
 #include <memory>
@@ -21,9 +23,23 @@ public:
 	bool encode(const Packetizer& packetizer, std::vector<uint8_t>& result, const std::shared_ptr<Message>& message);
 	bool encode(const Packetizer& packetizer, std::vector<uint8_t>& result, Command cmd, std::vector<uint8_t> arguments = {});
 
+	// As above, but leaving the packet in an EncodeBuffer so the headers are prepended in place
+	bool encode(const Packetizer& packetizer, EncodeBuffer& result, const std::shared_ptr<Message>& message);
+	bool encode(const Packetizer& packetizer, EncodeBuffer& result, Command cmd, std::vector<uint8_t> arguments = {});
+
+	// Encode a CAN or Ethernet frame once, to be sent many times, or nullptr on failure
+	std::shared_ptr<PreparedFrame> prepare(const Packetizer& packetizer, const std::shared_ptr<Frame>& frame);
+
 	bool supportCANFD = false;
 	bool supportEthPhy = false;
 
+	/**
+	 * LINMessages are not transmitted unless this is set. The
+	 * HardwareLINPacket layout they are encoded into has not yet been
+	 * confirmed against records captured from a device.
+	 */
+	bool encodeLINMessages = false;
+
 private:
 	device_eventhandler_t report;
 };
@@ -18,10 +18,29 @@ namespace icsneo {
  */
 class EthernetPacketizer {
 public:
-	static const size_t MaxPacketLength;
+	static const size_t HeaderLength; // The 0xAAAA5555 header, payload size, packet number and packet info
+	static const size_t StandardMTU;
+	static const size_t MaxMTU; // Jumbo frames
+	static const size_t DefaultMaxPacketLength;
+
+	/**
+	 * The largest payload which fits in a single packet on a link
+	 * with the given MTU, or 0 if the MTU is out of range.
+	 */
+	static size_t MaxPacketLengthForMTU(size_t mtu);
 
 	EthernetPacketizer(device_eventhandler_t report) : report(report) {}
 
+	/**
+	 * Set the largest payload placed in a single outgoing packet.
+	 * Larger inputs will be split across multiple packets.
+	 *
+	 * Returns false if the length is out of range, in which case
+	 * the previous value is kept.
+	 */
+	bool setMaxPacketLength(size_t length);
+	size_t getMaxPacketLength() const { return maxPacketLength; }
+
 	/**
 	 * Call with as many packets as desired before calling
 	 * outputDown to get the results. Passing in multiple
@@ -64,6 +83,8 @@ public:
 	bool allowInPacketsFromAnyMAC = false; // Used when discovering devices
 	
 private:
+	size_t maxPacketLength = DefaultMaxPacketLength;
+
 	bool reassembling = false;
 	uint16_t reassemblingId = 0;
 	std::vector<uint8_t> reassemblingData;
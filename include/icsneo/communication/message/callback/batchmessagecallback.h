@@ -0,0 +1,107 @@
+#ifndef __BATCHMESSAGECALLBACK_H_
+#define __BATCHMESSAGECALLBACK_H_
+
+#ifdef __cplusplus
+
+#include "icsneo/communication/message/message.h"
+#include "icsneo/communication/message/filter/messagefilter.h"
+#include <memory>
+#include <functional>
+#include <vector>
+#include <chrono>
+
+namespace icsneo {
+
+/**
+ * A callback which receives many messages per invocation, for subscribers
+ * where the cost of a call per message adds up.
+ *
+ * By default, a batch holds every matching message decoded from one read
+ * from the device. Setting maxMessages delivers a batch as soon as it holds
+ * that many messages. Setting maxLatency instead collects messages across
+ * reads, delivering once the oldest message in the batch has waited that
+ * long. The latency is checked as data arrives and whenever the device
+ * has been idle for a short while (100ms for most devices).
+ */
+class BatchMessageCallback {
+public:
+	typedef std::function< void( std::vector< std::shared_ptr<Message> > ) > fn_batchMessageCallback;
+
+	BatchMessageCallback(fn_batchMessageCallback cb, std::shared_ptr<MessageFilter> f,
+		size_t maxMsgs = 0, std::chrono::microseconds maxLat = std::chrono::microseconds(0))
+		: callback(cb), filter(f ? f : std::make_shared<MessageFilter>()), maxMessages(maxMsgs), maxLatency(maxLat) {
+		if(!cb)
+			throw std::bad_function_call();
+	}
+
+	BatchMessageCallback(fn_batchMessageCallback cb, MessageFilter f = MessageFilter(),
+		size_t maxMsgs = 0, std::chrono::microseconds maxLat = std::chrono::microseconds(0))
+		: BatchMessageCallback(cb, std::make_shared<MessageFilter>(f), maxMsgs, maxLat) {}
+
+	// Allow the filter to be placed first if the user wants (maybe in the case of a lambda)
+	BatchMessageCallback(std::shared_ptr<MessageFilter> f, fn_batchMessageCallback cb,
+		size_t maxMsgs = 0, std::chrono::microseconds maxLat = std::chrono::microseconds(0))
+		: BatchMessageCallback(cb, f, maxMsgs, maxLat) {}
+	BatchMessageCallback(MessageFilter f, fn_batchMessageCallback cb,
+		size_t maxMsgs = 0, std::chrono::microseconds maxLat = std::chrono::microseconds(0))
+		: BatchMessageCallback(cb, std::make_shared<MessageFilter>(f), maxMsgs, maxLat) {}
+
+	virtual ~BatchMessageCallback() = default;
+
+	// Returns true if the message matched the filter and was added to the batch
+	virtual bool addIfMatch(const std::shared_ptr<Message>& message) {
+		if(!filter->match(message))
+			return false;
+
+		if(pending.empty())
+			oldestPending = std::chrono::steady_clock::now();
+		pending.push_back(message);
+		if(maxMessages != 0 && pending.size() >= maxMessages)
+			flush();
+		return true;
+	}
+
+	// Everything from one read from the device has been added
+	void endOfRead() {
+		if(maxLatency.count() == 0)
+			flush();
+		else
+			flushIfExpired();
+	}
+
+	void flushIfExpired() {
+		if(maxLatency.count() != 0 && !pending.empty() && std::chrono::steady_clock::now() - oldestPending >= maxLatency)
+			flush();
+	}
+
+	void flush() {
+		if(pending.empty())
+			return;
+		std::vector< std::shared_ptr<Message> > batch;
+		batch.reserve(maxMessages ? maxMessages : pending.size());
+		batch.swap(pending); // The next batch gets the allocation we just made
+		callback(std::move(batch));
+	}
+
+	size_t getPendingCount() const { return pending.size(); }
+	const MessageFilter& getFilter() const { return *filter; }
+	const fn_batchMessageCallback& getCallback() const { return callback; }
+	size_t getMaxMessages() const { return maxMessages; }
+	std::chrono::microseconds getMaxLatency() const { return maxLatency; }
+
+protected:
+	const fn_batchMessageCallback callback;
+	const std::shared_ptr<MessageFilter> filter;
+	const size_t maxMessages;
+	const std::chrono::microseconds maxLatency;
+
+private:
+	std::vector< std::shared_ptr<Message> > pending;
+	std::chrono::steady_clock::time_point oldestPending;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
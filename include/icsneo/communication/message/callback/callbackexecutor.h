@@ -0,0 +1,119 @@
+#ifndef __CALLBACKEXECUTOR_H_
+#define __CALLBACKEXECUTOR_H_
+
+#ifdef __cplusplus
+
+#include "icsneo/communication/message/message.h"
+#include <memory>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace icsneo {
+
+class AsyncCallbackQueue;
+
+/**
+ * A pool of worker threads which run asynchronous message callbacks.
+ *
+ * Each callback keeps its own bounded queue, and only one worker runs
+ * a given callback at a time, so every callback still sees its messages
+ * in order. A single executor may be shared between many callbacks.
+ */
+class CallbackExecutor {
+public:
+	// What to do with a new message when a callback's queue is full
+	enum class QueueFullPolicy {
+		Block, // Hold up the library's read thread until there is room
+		DropOldest,
+		DropNewest
+	};
+
+	class Stats {
+	public:
+		uint64_t delivered = 0; // Callback invocations which have returned
+		uint64_t dropped = 0; // Messages discarded due to the QueueFullPolicy
+		size_t queueDepth = 0;
+		size_t maxQueueDepth = 0;
+	};
+
+	CallbackExecutor(size_t threads = 1);
+	~CallbackExecutor();
+	CallbackExecutor(const CallbackExecutor&) = delete;
+	CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+	size_t getThreadCount() const { return threads.size(); }
+
+private:
+	friend class AsyncCallbackQueue;
+
+	// Messages run for a callback before moving on to the next one that is waiting
+	static const size_t MaxMessagesPerTurn;
+
+	// Shared with the worker threads, in case the last reference to the
+	// executor is released from within a callback running on one of them
+	class Workers {
+	public:
+		void schedule(std::shared_ptr<AsyncCallbackQueue> queue);
+		static void Run(std::shared_ptr<Workers> workers);
+
+		std::mutex mutex;
+		std::condition_variable readyAvailable;
+		std::deque< std::shared_ptr<AsyncCallbackQueue> > ready;
+		bool stopping = false;
+	};
+
+	std::shared_ptr<Workers> workers;
+	std::vector<std::thread> threads;
+};
+
+// The bounded queue of messages waiting for one asynchronous callback
+class AsyncCallbackQueue : public std::enable_shared_from_this<AsyncCallbackQueue> {
+public:
+	typedef std::function< void( std::shared_ptr<Message> ) > fn_messageCallback;
+
+	AsyncCallbackQueue(fn_messageCallback cb, const CallbackExecutor& exec, size_t size, CallbackExecutor::QueueFullPolicy fullPolicy)
+		: callback(cb), workers(exec.workers), capacity(size ? size : 1), policy(fullPolicy) {}
+
+	void post(const std::shared_ptr<Message>& message);
+
+	/**
+	 * Discard any messages still waiting and wait for a running invocation
+	 * of the callback to return. Nothing will be delivered afterwards.
+	 *
+	 * If called from within the callback itself, it will not wait.
+	 */
+	void stop();
+
+	CallbackExecutor::Stats getStats() const;
+
+private:
+	friend class CallbackExecutor;
+
+	// Returns true if there are still messages waiting afterwards
+	bool run(size_t maxMessages);
+
+	const fn_messageCallback callback;
+	const std::shared_ptr<CallbackExecutor::Workers> workers;
+	const size_t capacity;
+	const CallbackExecutor::QueueFullPolicy policy;
+
+	mutable std::mutex mutex;
+	std::condition_variable spaceAvailable;
+	std::condition_variable idle;
+	std::deque< std::shared_ptr<Message> > queue;
+	bool scheduled = false; // Waiting for, or running on, a worker
+	bool running = false; // The callback is running right now
+	bool stopped = false;
+	std::thread::id runningOn;
+	CallbackExecutor::Stats stats;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
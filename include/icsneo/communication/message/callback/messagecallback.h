@@ -5,6 +5,7 @@
 
 #include "icsneo/communication/message/message.h"
 #include "icsneo/communication/message/filter/messagefilter.h"
+#include "icsneo/communication/message/callback/callbackexecutor.h"
 #include <memory>
 #include <functional>
 
@@ -29,18 +30,67 @@ public:
 	MessageCallback(MessageFilter f, fn_messageCallback cb)
 		: MessageCallback(cb, std::make_shared<MessageFilter>(f)) {}
 	
+	virtual ~MessageCallback() = default;
+
+	static const size_t DefaultAsyncQueueSize;
+
+	/**
+	 * By default, the callback runs on the library's read thread, and a slow
+	 * callback holds up every other callback and the device's connection.
+	 *
+	 * Once runAsync() is called, matching messages are instead queued for
+	 * a worker thread, either one dedicated to this callback or an executor
+	 * shared with other callbacks. When the queue is full, the policy
+	 * decides whether to wait for room or which message to drop.
+	 *
+	 * This must be called before the callback is added to a device. Copies
+	 * of the callback share the same queue, so getAsyncStats() can be called
+	 * on the original afterwards.
+	 */
+	MessageCallback& runAsync(size_t queueSize = DefaultAsyncQueueSize,
+		CallbackExecutor::QueueFullPolicy policy = CallbackExecutor::QueueFullPolicy::DropNewest) {
+		return runAsync(std::make_shared<CallbackExecutor>(), queueSize, policy);
+	}
+	MessageCallback& runAsync(std::shared_ptr<CallbackExecutor> exec, size_t queueSize = DefaultAsyncQueueSize,
+		CallbackExecutor::QueueFullPolicy policy = CallbackExecutor::QueueFullPolicy::DropNewest) {
+		if(!exec)
+			exec = std::make_shared<CallbackExecutor>();
+		asyncQueue = std::make_shared<AsyncCallbackQueue>(callback, *exec, queueSize, policy);
+		executor = std::move(exec);
+		return *this;
+	}
+	bool isAsync() const { return !!asyncQueue; }
+	CallbackExecutor::Stats getAsyncStats() const { return asyncQueue ? asyncQueue->getStats() : CallbackExecutor::Stats(); }
+
+	// Discard any queued messages and wait for the callback to finish running, if it is async
+	void stopAsync() const {
+		if(asyncQueue)
+			asyncQueue->stop();
+	}
+
 	virtual bool callIfMatch(const std::shared_ptr<Message>& message) const {
 		bool ret = filter->match(message);
-		if(ret)
-			callback(message);
+		if(ret) {
+			if(asyncQueue)
+				asyncQueue->post(message);
+			else
+				callback(message);
+		}
 		return ret;
 	}
+	// The queue an async callback's messages are posted to, or nullptr
+	const std::shared_ptr<AsyncCallbackQueue>& getAsyncQueue() const { return asyncQueue; }
 	const MessageFilter& getFilter() const { return *filter; }
 	const fn_messageCallback& getCallback() const { return callback; }
 
 protected:
 	const fn_messageCallback callback;
 	const std::shared_ptr<MessageFilter> filter;
+
+private:
+	// The executor is kept alive for as long as any copy of this callback is
+	std::shared_ptr<CallbackExecutor> executor;
+	std::shared_ptr<AsyncCallbackQueue> asyncQueue;
 };
 
 }
@@ -27,8 +27,7 @@ public:
 		if(!matchMessageType(message->type))
 			return false;
 
-		if(message->type == Message::Type::Frame || message->type == Message::Type::Main51 || 
-			message->type == Message::Type::RawMessage || message->type == Message::Type::ReadSettings) {
+		if(IsNetworkChecked(message->type)) {
 			RawMessage& frame = *static_cast<RawMessage*>(message.get());
 			if(!matchNetworkType(frame.network.getType()))
 				return false;
@@ -38,7 +37,50 @@ public:
 		return true;
 	}
 
+	/**
+	 * Whether a message decoded from frame traffic on this network could match.
+	 *
+	 * Frame traffic which no filter could match is dropped before it is decoded,
+	 * see Communication::isSubscribed(). Filters which override match() to accept
+	 * messages this base filter would not must override this as well.
+	 */
+	virtual bool mayMatchNetwork(const Network& network) const {
+		if(messageType != Message::Type::Invalid)
+			return mayMatchDecoded(messageType, network);
+		for(const auto type : { Message::Type::Frame, Message::Type::CANErrorCount, Message::Type::RawMessage }) {
+			if(mayMatchDecoded(type, network))
+				return true;
+		}
+		return false;
+	}
+
+	// Whether decoding frame traffic on this type of network may give a message of this type
+	static bool MayBeDecodedFrom(Message::Type type, Network::Type networkType) {
+		switch(type) {
+			case Message::Type::Frame:
+			case Message::Type::RawMessage: // Networks without a decoder of their own
+				return true;
+			case Message::Type::CANErrorCount:
+				return networkType == Network::Type::CAN || networkType == Network::Type::SWCAN || networkType == Network::Type::LSFTCAN;
+			default:
+				// Internal messages only come from internal traffic, anything else we don't know may come from anywhere
+				return (neomessagetype_t(type) & 0x8000) == 0;
+		}
+	}
+
+	// Messages of these types are only matched if their network matches as well
+	static bool IsNetworkChecked(Message::Type type) {
+		return type == Message::Type::Frame || type == Message::Type::Main51 ||
+			type == Message::Type::RawMessage || type == Message::Type::ReadSettings;
+	}
+
 protected:
+	bool mayMatchDecoded(Message::Type type, const Network& network) const {
+		if(!matchMessageType(type) || !MayBeDecodedFrom(type, network.getType()))
+			return false;
+		return !IsNetworkChecked(type) || (matchNetworkType(network.getType()) && matchNetID(network.getNetID()));
+	}
+
 	Message::Type messageType = Message::Type::Invalid; // Used here for "any"
 	bool matchMessageType(Message::Type mtype) const {
 		if(messageType == Message::Type::Invalid && ((neomessagetype_t(mtype) & 0x8000) == 0 || includeInternalInAny))
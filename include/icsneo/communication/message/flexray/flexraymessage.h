@@ -12,6 +12,25 @@ namespace icsneo {
 
 class FlexRayMessage : public Frame {
 public:
+	// The header CRC covers the sync and startup indicators, the slot ID, and the payload length in 16-bit words
+	static uint16_t CalcHeaderCRC(bool sync, bool startup, uint16_t slotid, uint8_t payloadWords) {
+		uint16_t crc = 0x1A;
+		const auto addBit = [&crc](bool bit) {
+			const bool crcNxt = bit != bool(crc & (1 << 10));
+			crc = (crc << 1) & 0x7FE;
+			if(crcNxt)
+				crc ^= 0x385;
+		};
+
+		addBit(sync);
+		addBit(startup);
+		for(int i = 10; i >= 0; i--)
+			addBit(slotid & (1 << i));
+		for(int i = 6; i >= 0; i--)
+			addBit(payloadWords & (1 << i));
+		return crc;
+	}
+
 	uint16_t slotid = 0;
 	double tsslen = 0;
 	double framelen = 0;
@@ -0,0 +1,72 @@
+#ifndef __LINMESSAGE_H_
+#define __LINMESSAGE_H_
+
+#ifdef __cplusplus
+
+#include "icsneo/communication/message/message.h"
+
+namespace icsneo {
+
+class LINErrorFlags {
+public:
+	bool rxBreakOnly = false; // Only a break was received
+	bool rxBreakSyncOnly = false; // Only a break and sync were received
+	bool rxBreakNotZero = false;
+	bool rxBreakTooShort = false;
+	bool rxSyncNot55 = false;
+	bool rxDataLenOver8 = false;
+	bool syncFramingError = false;
+	bool idFramingError = false;
+	bool responderByteFramingError = false;
+	bool idParityError = false; // The parity bits of the protected ID did not match the ID
+	bool checksumError = false; // The received checksum did not match the data
+};
+
+class LINStatusFlags {
+public:
+	bool txChecksumEnhanced = false;
+	bool txCommander = false;
+	bool txResponder = false;
+	bool txAborted = false;
+	bool updateResponderOnce = false;
+	bool hasUpdatedResponderOnce = false;
+	bool busRecovered = false;
+	bool breakOnly = false;
+};
+
+class LINMessage : public Frame {
+public:
+	// Frame IDs are 6 bits, the protected ID adds two parity bits on top
+	static uint8_t CalcProtectedID(uint8_t id) {
+		id &= 0x3F;
+		const auto bit = [id](int n) { return (id >> n) & 1; };
+		const uint8_t p0 = uint8_t(bit(0) ^ bit(1) ^ bit(2) ^ bit(4));
+		const uint8_t p1 = uint8_t(~(bit(1) ^ bit(3) ^ bit(4) ^ bit(5)) & 1);
+		return uint8_t(id | (p0 << 6) | (p1 << 7));
+	}
+
+	// The enhanced checksum covers the protected ID as well as the data, the classic checksum only the data
+	static uint8_t CalcChecksum(const uint8_t* data, size_t length, uint8_t protectedID, bool enhanced) {
+		uint16_t sum = enhanced ? protectedID : 0;
+		for(size_t i = 0; i < length; i++) {
+			sum += data[i];
+			if(sum > 0xFF)
+				sum -= 0xFF; // Sum with carry
+		}
+		return uint8_t(~sum);
+	}
+
+	uint8_t ID = 0; // 0 to 0x3F
+	uint8_t protectedID = 0; // Filled in when decoded, calculated from ID for transmit
+	uint8_t checksum = 0; // Filled in when decoded, calculated for transmit
+	bool isEnhancedChecksum = false;
+	bool isHeaderOnly = false; // For transmit, send only the header so that another node responds with the data
+	LINErrorFlags errFlags;
+	LINStatusFlags statusFlags;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
@@ -23,6 +23,7 @@ public:
 	void spawnThreads() override;
 	void joinThreads() override;
 	bool sendPacket(std::vector<uint8_t>& bytes) override;
+	bool sendPacket(EncodeBuffer& bytes) override;
 
 	enum class CommandType : uint8_t {
 		PlasmaReadRequest = 0x10, // Status read request to HSC
@@ -8,6 +8,7 @@ typedef uint8_t neonettype_t;
 #ifdef __cplusplus
 
 #include <ostream>
+#include <type_traits>
 #include "icsneo/platform/optional.h"
 
 namespace icsneo {
@@ -236,6 +237,18 @@ public:
 		}
 	}
 	static Type GetTypeOfNetID(NetID netid) {
+		if(neonetid_t(netid) < NetIDTableSize)
+			return GetNetIDTables().types[neonetid_t(netid)];
+		return ComputeTypeOfNetID(netid);
+	}
+	static const char* GetNetIDString(NetID netid) {
+		if(neonetid_t(netid) < NetIDTableSize)
+			return GetNetIDTables().strings[neonetid_t(netid)];
+		return ComputeNetIDString(netid);
+	}
+
+	// The lookups above are precomputed from these, use them instead
+	static constexpr Type ComputeTypeOfNetID(NetID netid) {
 		switch(netid) {
 			case NetID::HSCAN:
 			case NetID::MSCAN:
@@ -316,7 +329,7 @@ public:
 				return Type::Other;
 		}
 	}
-	static const char* GetNetIDString(NetID netid) {
+	static constexpr const char* ComputeNetIDString(NetID netid) {
 		switch(netid) {
 			case NetID::Device:
 				return "neoVI";
@@ -796,7 +809,30 @@ public:
 	friend bool operator==(const Network& net1, const Network& net2) { return net1.getNetID() == net2.getNetID(); }
 	friend bool operator!=(const Network& net1, const Network& net2) { return !(net1 == net2); }
 
+	// Every NetID in use is below this, other than Any and Invalid
+	static constexpr neonetid_t NetIDTableSize = neonetid_t(NetID::Ethernet2) + 1;
+
+	// The tables behind the lookups above, public so that they can be checked at compile time
+	struct NetIDTables {
+		Type types[NetIDTableSize];
+		const char* strings[NetIDTableSize];
+	};
+	static constexpr NetIDTables MakeNetIDTables() {
+		NetIDTables tables = {};
+		for(neonetid_t i = 0; i < NetIDTableSize; i++) {
+			tables.types[i] = ComputeTypeOfNetID(NetID(i));
+			tables.strings[i] = ComputeNetIDString(NetID(i));
+		}
+		return tables;
+	}
+
 private:
+	static const NetIDTables& GetNetIDTables() {
+		// Built at compile time, so there is no initialization guard to check
+		static constexpr NetIDTables tables = MakeNetIDTables();
+		return tables;
+	}
+
 	NetID value; // Always use setValue so that value and type stay in sync
 	Type type;
 	void setValue(NetID id) {
@@ -805,6 +841,8 @@ private:
 	}
 };
 
+static_assert(std::is_trivially_copyable<Network>::value, "Network is copied with every message, it must stay trivially copyable");
+
 }
 
 #endif // __cplusplus
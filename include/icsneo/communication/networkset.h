@@ -0,0 +1,58 @@
+#ifndef __NETWORKSET_H_
+#define __NETWORKSET_H_
+
+#ifdef __cplusplus
+
+#include "icsneo/communication/network.h"
+#include <bitset>
+#include <vector>
+#include <algorithm>
+
+namespace icsneo {
+
+/**
+ * A set of networks with constant time membership checks.
+ *
+ * NetIDs below Network::NetIDTableSize, which covers every NetID in use,
+ * are kept in a bitset. Anything else falls back to a (usually empty) list.
+ */
+class NetworkSet {
+public:
+	NetworkSet() = default;
+	NetworkSet(const std::vector<Network>& networks) {
+		for(const auto& net : networks)
+			insert(net);
+	}
+
+	void insert(const Network& net) {
+		const auto netid = neonetid_t(net.getNetID());
+		if(netid < Network::NetIDTableSize)
+			known.set(netid);
+		else if(!containsOther(net))
+			other.push_back(net);
+	}
+
+	bool contains(const Network& net) const {
+		const auto netid = neonetid_t(net.getNetID());
+		if(netid < Network::NetIDTableSize)
+			return known.test(netid);
+		return containsOther(net);
+	}
+
+	size_t size() const { return known.count() + other.size(); }
+	bool empty() const { return known.none() && other.empty(); }
+
+private:
+	bool containsOther(const Network& net) const {
+		return std::find(other.begin(), other.end(), net) != other.end();
+	}
+
+	std::bitset<Network::NetIDTableSize> known;
+	std::vector<Network> other;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
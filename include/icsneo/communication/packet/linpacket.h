@@ -0,0 +1,64 @@
+#ifndef __LINPACKET_H__
+#define __LINPACKET_H__
+
+#ifdef __cplusplus
+
+#include "icsneo/communication/message/linmessage.h"
+#include "icsneo/api/eventmanager.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace icsneo {
+
+typedef uint16_t icscm_bitfield;
+
+struct HardwareLINPacket {
+	static std::shared_ptr<LINMessage> DecodeToMessage(const std::vector<uint8_t>& bytestream);
+	static bool EncodeFromMessage(const LINMessage& message, std::vector<uint8_t>& bytestream, const device_eventhandler_t& report);
+
+	struct {
+		icscm_bitfield errRxOnlyBreak : 1;
+		icscm_bitfield errRxOnlyBreakSync : 1;
+		icscm_bitfield ID : 11; // The protected ID, parity bits included
+		icscm_bitfield networkIndex : 3; // DO NOT CLOBBER THIS
+	} CoreMiniBitsLIN;
+	struct {
+		icscm_bitfield len : 4; // Number of data bytes, not including the checksum
+		icscm_bitfield extendedNetworkIndexBit2 : 1; // DO NOT CLOBBER THIS
+		icscm_bitfield updateResponderOnce : 1;
+		icscm_bitfield hasUpdatedResponderOnce : 1;
+		icscm_bitfield extendedNetworkIndexBit : 1; // DO NOT CLOBBER THIS
+		icscm_bitfield busRecovered : 1;
+		icscm_bitfield syncFerr : 1; // Framing error in the sync byte
+		icscm_bitfield midFerr : 1; // Framing error in the protected ID
+		icscm_bitfield responderByteFerr : 1; // Framing error in one of the response bytes
+		icscm_bitfield txAborted : 1;
+		icscm_bitfield breakOnly : 1;
+		icscm_bitfield : 2;
+	} status;
+	struct {
+		icscm_bitfield checksum : 8;
+		icscm_bitfield txChecksumEnhanced : 1;
+		icscm_bitfield txCommander : 1;
+		icscm_bitfield txResponder : 1;
+		icscm_bitfield errRxBreakNotZero : 1;
+		icscm_bitfield errRxBreakTooShort : 1;
+		icscm_bitfield errRxSyncNot55 : 1;
+		icscm_bitfield errRxDataLenOver8 : 1;
+		icscm_bitfield headerOnly : 1; // No response followed the header
+	} flags;
+	unsigned char data[8];
+	uint16_t stats;
+	struct {
+		uint64_t TS : 60;
+		uint64_t : 3; // Reserved for future status bits
+		uint64_t IsExtended : 1;
+	} timestamp;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
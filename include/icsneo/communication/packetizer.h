@@ -4,6 +4,7 @@
 #ifdef __cplusplus
 
 #include "icsneo/communication/packet.h"
+#include "icsneo/communication/encodebuffer.h"
 #include "icsneo/api/eventmanager.h"
 #include <queue>
 #include <vector>
@@ -14,10 +15,12 @@ namespace icsneo {
 class Packetizer {
 public:
 	static uint8_t ICSChecksum(const std::vector<uint8_t>& data);
+	static uint8_t ICSChecksum(const uint8_t* data, size_t size);
 
 	Packetizer(device_eventhandler_t report) : report(report) {}
 
 	std::vector<uint8_t>& packetWrap(std::vector<uint8_t>& data, bool shortFormat) const;
+	EncodeBuffer& packetWrap(EncodeBuffer& data, bool shortFormat) const;
 
 	bool input(const std::vector<uint8_t>& bytes);
 	std::vector<std::shared_ptr<Packet>> output();
@@ -40,7 +43,10 @@ private:
 	bool checksum = false;
 	bool gotGoodPackets = false; // Tracks whether we've ever gotten a good packet
 	Packet packet;
-	std::deque<uint8_t> bytes;
+	// Bytes before bytesStart have already been consumed
+	std::vector<uint8_t> bytes;
+	size_t bytesStart = 0;
+	size_t available() const { return bytes.size() - bytesStart; }
 
 	std::vector<std::shared_ptr<Packet>> processedPackets;
 
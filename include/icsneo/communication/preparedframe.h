@@ -0,0 +1,58 @@
+#ifndef __PREPAREDFRAME_H_
+#define __PREPAREDFRAME_H_
+
+#ifdef __cplusplus
+
+#include "icsneo/communication/message/message.h"
+#include "icsneo/communication/encodebuffer.h"
+#include <memory>
+#include <cstring>
+
+namespace icsneo {
+
+/**
+ * A CAN or Ethernet frame which has already been encoded for the wire,
+ * for traffic which is sent over and over with few changes, such as
+ * residual bus simulation.
+ *
+ * Create one with Device::prepareTransmit(), change payload bytes with
+ * setData(), and send it with Device::transmit(). Sending copies the
+ * prepared packet to the driver without encoding the frame again.
+ *
+ * A PreparedFrame must not be modified while it is being transmitted
+ * from another thread.
+ */
+class PreparedFrame {
+public:
+	// The frame as it was prepared, changes made with setData() are not reflected here
+	const std::shared_ptr<Frame>& getFrame() const { return frame; }
+	size_t getDataSize() const { return dataSize; }
+
+	// Overwrite payload bytes starting at `index`, returning false if they do not fit in the frame
+	bool setData(size_t index, const uint8_t* data, size_t length) {
+		if(index > dataSize || length > dataSize - index)
+			return false;
+		memcpy(packet.data() + dataOffset + index, data, length);
+		return true;
+	}
+	bool setData(size_t index, uint8_t value) { return setData(index, &value, 1); }
+	uint8_t getData(size_t index) const { return index < dataSize ? packet[dataOffset + index] : 0; }
+
+	// The encoded packet, as it will be sent to the communication layer
+	const EncodeBuffer& getPacket() const { return packet; }
+
+private:
+	friend class Encoder;
+	PreparedFrame() = default;
+
+	std::shared_ptr<Frame> frame;
+	EncodeBuffer packet;
+	size_t dataOffset = 0; // Where the frame's payload starts in the packet
+	size_t dataSize = 0;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
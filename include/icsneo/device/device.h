@@ -21,8 +21,12 @@
 #include "icsneo/disk/diskreaddriver.h"
 #include "icsneo/disk/diskwritedriver.h"
 #include "icsneo/disk/nulldiskdriver.h"
+#include "icsneo/disk/fileextractor.h"
+#include "icsneo/disk/asyncdiskqueue.h"
+#include "icsneo/disk/fat.h"
 #include "icsneo/communication/communication.h"
 #include "icsneo/communication/packetizer.h"
+#include "icsneo/communication/networkset.h"
 #include "icsneo/communication/encoder.h"
 #include "icsneo/communication/decoder.h"
 #include "icsneo/communication/io.h"
@@ -138,20 +142,44 @@ public:
 	}
 
 	int addMessageCallback(const MessageCallback& cb) { return com->addMessageCallback(cb); }
+	int addMessageCallback(const BatchMessageCallback& cb) { return com->addMessageCallback(cb); }
 	bool removeMessageCallback(int id) { return com->removeMessageCallback(id); }
 
 	bool transmit(std::shared_ptr<Frame> frame);
 	bool transmit(std::vector<std::shared_ptr<Frame>> frames);
 
+	/**
+	 * Encode a CAN or Ethernet frame once, for traffic which is sent
+	 * repeatedly. Payload bytes, such as counters, can be changed with
+	 * PreparedFrame::setData() before each transmit(), which then only
+	 * copies the encoded packet to the driver.
+	 *
+	 * Frames on a network which a device extension handles transmits
+	 * for can not be prepared, nullptr is returned.
+	 */
+	std::shared_ptr<PreparedFrame> prepareTransmit(std::shared_ptr<Frame> frame);
+	bool transmit(const PreparedFrame& frame);
+
 	void setWriteBlocks(bool blocks);
 
+	/**
+	 * For devices connected over raw Ethernet, set the MTU used to frame
+	 * traffic to and from the device. Larger values, such as 9000 for
+	 * jumbo frames, allow large transfers to be sent in fewer frames.
+	 *
+	 * The MTU will be limited to that of the network interface, and
+	 * can only be changed while the device is closed.
+	 */
+	bool setEthernetMTU(size_t mtu) { return com->driver->setMTU(mtu); }
+	size_t getEthernetMTU() const { return com->driver->getMTU(); }
+
 	const std::vector<Network>& getSupportedRXNetworks() const { return supportedRXNetworks; }
 	const std::vector<Network>& getSupportedTXNetworks() const { return supportedTXNetworks; }
 	virtual bool isSupportedRXNetwork(const Network& net) const {
-		return std::find(supportedRXNetworks.begin(), supportedRXNetworks.end(), net) != supportedRXNetworks.end();
+		return supportedRXNetworkSet.contains(net);
 	}
 	virtual bool isSupportedTXNetwork(const Network& net) const {
-		return std::find(supportedTXNetworks.begin(), supportedTXNetworks.end(), net) != supportedTXNetworks.end();
+		return supportedTXNetworkSet.contains(net);
 	}
 
 	virtual size_t getNetworkCountByType(Network::Type) const;
@@ -191,6 +219,30 @@ public:
 	optional<uint64_t> writeLogicalDisk(uint64_t pos, const uint8_t* from, uint64_t amount,
 		std::chrono::milliseconds timeout = Disk::DefaultTimeout);
 
+	/**
+	 * Start reading from the logical disk in the background, as
+	 * readLogicalDisk() does. `into` must stay valid until the returned
+	 * operation is done.
+	 *
+	 * Operations on the same device are queued, and transferred a slice
+	 * at a time in turn, so that neither they nor other disk access and
+	 * device traffic hold each other up. `onComplete`, if given, is called
+	 * from the background thread once the operation is done.
+	 *
+	 * Upon failure to start the operation, nullptr will be returned and
+	 * an error will be set in icsneo::GetLastError().
+	 */
+	std::shared_ptr<Disk::AsyncOperation> readLogicalDiskAsync(uint64_t pos, uint8_t* into, uint64_t amount,
+		Disk::AsyncOperation::CompletionFn onComplete = {});
+
+	/**
+	 * Start writing to the logical disk in the background, as
+	 * writeLogicalDisk() does, queued along with readLogicalDiskAsync().
+	 * `from` must stay valid until the returned operation is done.
+	 */
+	std::shared_ptr<Disk::AsyncOperation> writeLogicalDiskAsync(uint64_t pos, const uint8_t* from, uint64_t amount,
+		Disk::AsyncOperation::CompletionFn onComplete = {});
+
 	/**
 	 * Check if the logical disk is connected. This means the disk is inserted,
 	 * and if required (for instance for multi-card configurations), configured
@@ -225,6 +277,36 @@ public:
 	 */
 	optional<uint64_t> getVSAOffsetInLogicalDisk();
 
+	/**
+	 * Get the hit and miss statistics of the cache of recently read
+	 * logical disk blocks, along with how much is currently cached.
+	 */
+	Disk::ReadDriver::CacheStats getLogicalDiskCacheStats() const;
+
+	/**
+	 * Copy `amount` bytes of the logical disk, starting from byte `pos`,
+	 * to the file at `path` on the host.
+	 *
+	 * Progress is checkpointed next to the file. If the extraction is
+	 * interrupted, for instance by the device disconnecting, calling this
+	 * again with the same arguments once the device is reopened verifies
+	 * what was already extracted and carries on from there.
+	 *
+	 * `onProgress`, if given, is called periodically with how far along
+	 * the extraction is and how quickly it is going.
+	 */
+	bool extractLogicalDisk(const std::string& path, uint64_t pos, uint64_t amount,
+		std::function<void(const Disk::FileExtractor::Progress&)> onProgress = {});
+
+	/**
+	 * Extract LOG_DATA.VSA, found through the FAT filesystem on the logical
+	 * disk, to the file at `path` on the host, as extractLogicalDisk() does.
+	 *
+	 * If the device only gives access to the VSA, and not the filesystem
+	 * around it, everything to the end of the logical disk is extracted.
+	 */
+	bool extractVSA(const std::string& path, std::function<void(const Disk::FileExtractor::Progress&)> onProgress = {});
+
 	/**
 	 * Retrieve the number of Ethernet (DoIP) Activation lines present
 	 * on this device.
@@ -361,6 +443,8 @@ protected:
 		diskWriteDriver = std::unique_ptr<DiskWrite>(new DiskWrite());
 		setupSupportedRXNetworks(supportedRXNetworks);
 		setupSupportedTXNetworks(supportedTXNetworks);
+		supportedRXNetworkSet = NetworkSet(supportedRXNetworks);
+		supportedTXNetworkSet = NetworkSet(supportedTXNetworks);
 		setupExtensions();
 	}
 
@@ -437,12 +521,31 @@ private:
 	std::unique_ptr<Disk::ReadDriver> diskReadDriver;
 	std::unique_ptr<Disk::WriteDriver> diskWriteDriver;
 
+	// Walking the FAT is slow, so this is kept until the disk is written to or the device is closed
+	optional<Disk::VSAExtent> vsaExtent;
+	optional<Disk::VSAExtent> findVSAExtent(const Disk::DiskReadFn& diskRead); // Requires the diskLock
+	Disk::AsyncQueue asyncDiskQueue;
+
 	mutable std::mutex extensionsLock;
 	std::vector<std::shared_ptr<DeviceExtension>> extensions;
 	void forEachExtension(std::function<bool(const std::shared_ptr<DeviceExtension>&)> fn);
 
+	// The extensions to call for each message, rebuilt when an extension is added
+	// so that the per-message paths do not need the extensionsLock
+	class ExtensionHooks;
+	std::atomic<const ExtensionHooks*> extensionHooks{nullptr};
+	bool transmitIsHooked(const Frame& frame) const;
+	// Every version is kept until destruction, as another thread may still be using an older one
+	std::vector<std::shared_ptr<const ExtensionHooks>> extensionHooksVersions;
+
+	// Matches what handleInternalMessage() needs, which is every internal message and whatever the extensions hook
+	class InternalMessageFilter;
+
 	std::vector<Network> supportedTXNetworks;
 	std::vector<Network> supportedRXNetworks;
+	// The same networks, for the checks made with every transmit
+	NetworkSet supportedTXNetworkSet;
+	NetworkSet supportedRXNetworkSet;
 	
 	APIEvent::Type attemptToBeginCommunication();
 
@@ -4,7 +4,10 @@
 #ifdef __cplusplus
 
 #include <memory>
+#include <vector>
+#include <algorithm>
 #include "icsneo/communication/message/message.h"
+#include "icsneo/communication/message/filter/messagefilter.h"
 #include "icsneo/api/eventmanager.h"
 #include "icsneo/device/device.h"
 
@@ -14,6 +17,53 @@ class Device;
 
 class DeviceExtension {
 public:
+	// Describes which messages one of the per-message hooks wants to see
+	class HookFilter {
+	public:
+		static HookFilter All() { HookFilter f; f.all = true; return f; }
+		static HookFilter None() { return HookFilter(); }
+
+		HookFilter& add(Message::Type type) { messageTypes.push_back(type); return *this; }
+		// Frames, or other raw messages, on this type of network
+		HookFilter& add(Network::Type type) { networkTypes.push_back(type); return *this; }
+
+		bool empty() const { return !all && messageTypes.empty() && networkTypes.empty(); }
+		bool match(const Message& message) const {
+			if(all)
+				return true;
+			for(const auto type : messageTypes) {
+				if(message.type == type)
+					return true;
+			}
+			if(networkTypes.empty())
+				return false;
+			const auto raw = dynamic_cast<const RawMessage*>(&message);
+			if(!raw)
+				return false;
+			for(const auto type : networkTypes) {
+				if(raw->network.getType() == type)
+					return true;
+			}
+			return false;
+		}
+
+		// Whether frames on this type of network could match, see MessageFilter::mayMatchNetwork()
+		bool mayMatchNetwork(Network::Type type) const {
+			if(all)
+				return true;
+			for(const auto mtype : messageTypes) {
+				if(MessageFilter::MayBeDecodedFrom(mtype, type))
+					return true;
+			}
+			return std::find(networkTypes.begin(), networkTypes.end(), type) != networkTypes.end();
+		}
+
+	private:
+		bool all = false;
+		std::vector<Message::Type> messageTypes;
+		std::vector<Network::Type> networkTypes;
+	};
+
 	DeviceExtension(Device& device) : device(device) {}
 	virtual ~DeviceExtension() = default;
 	virtual const char* getName() const = 0;
@@ -30,6 +80,18 @@ public:
 
 	virtual bool providesFirmware() const { return false; }
 
+	/**
+	 * Which messages handleMessage() and transmitHook() are called for.
+	 *
+	 * The device works these out once, when the extension is added, so that
+	 * traffic no extension is interested in skips the hooks entirely. The
+	 * filters must not change afterwards.
+	 *
+	 * Extensions see everything unless they override these.
+	 */
+	virtual HookFilter getMessageHookFilter() const { return HookFilter::All(); }
+	virtual HookFilter getTransmitHookFilter() const { return HookFilter::All(); }
+
 	virtual void handleMessage(const std::shared_ptr<Message>&) {}
 
 	// Return true to continue transmitting, success should be written to if false is returned
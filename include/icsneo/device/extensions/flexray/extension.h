@@ -24,6 +24,9 @@ public:
 	void onGoOnline() override;
 	void onGoOffline() override;
 
+	HookFilter getMessageHookFilter() const override { return HookFilter().add(Message::Type::FlexRayControl); }
+	HookFilter getTransmitHookFilter() const override { return HookFilter().add(Network::Type::FlexRay); }
+
 	void handleMessage(const std::shared_ptr<Message>& message) override;
 	bool transmitHook(const std::shared_ptr<Frame>& frame, bool& success) override;
 
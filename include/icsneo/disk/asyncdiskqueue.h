@@ -0,0 +1,128 @@
+#ifndef __ASYNCDISKQUEUE_H__
+#define __ASYNCDISKQUEUE_H__
+
+#ifdef __cplusplus
+
+#include "icsneo/platform/optional.h"
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace icsneo {
+
+namespace Disk {
+
+class AsyncQueue;
+
+/**
+ * A logical disk read or write running in the background,
+ * as returned by Device::readLogicalDiskAsync() and
+ * Device::writeLogicalDiskAsync()
+ */
+class AsyncOperation {
+public:
+	enum class State {
+		Queued,
+		Running,
+		Completed,
+		Failed, // Less than the full amount could be transferred, see the reported events
+		Cancelled
+	};
+
+	typedef std::function< void(const AsyncOperation& operation) > CompletionFn;
+
+	// Transfers one slice of the operation, `offset` bytes in, returning how much was transferred
+	typedef std::function< optional<uint64_t>(uint64_t offset, uint64_t amount) > TransferFn;
+
+	State getState() const { return state; }
+	bool isDone() const { return state == State::Completed || state == State::Failed || state == State::Cancelled; }
+
+	uint64_t getTransferred() const { return transferred; }
+	uint64_t getAmount() const { return amount; }
+
+	/**
+	 * Stop the operation before its next slice is transferred.
+	 *
+	 * A slice already in progress is allowed to finish, what was
+	 * transferred up to that point is left in place.
+	 */
+	void cancel() { cancelRequested = true; }
+
+	/**
+	 * Resolves once the operation is done, with the number of bytes
+	 * transferred, or nullopt if nothing could be transferred at all.
+	 */
+	std::shared_future< optional<uint64_t> > getFuture() const { return future; }
+
+	// Block until the operation is done, returning what getFuture() resolves to
+	optional<uint64_t> wait() const { return future.get(); }
+
+private:
+	friend class AsyncQueue;
+
+	AsyncOperation(TransferFn transfer, uint64_t amount, CompletionFn onComplete)
+		: transfer(transfer), onComplete(onComplete), amount(amount), future(promise.get_future().share()) {}
+
+	const TransferFn transfer;
+	const CompletionFn onComplete;
+	const uint64_t amount;
+	std::atomic<State> state{State::Queued};
+	std::atomic<uint64_t> transferred{0};
+	std::atomic<bool> cancelRequested{false};
+	std::promise< optional<uint64_t> > promise;
+	const std::shared_future< optional<uint64_t> > future;
+};
+
+/**
+ * Runs logical disk operations on a background thread
+ *
+ * Operations are transferred a slice at a time, taking turns with each
+ * other. The disk is free between slices, so synchronous disk access and
+ * other device traffic are never held up for longer than one slice.
+ */
+class AsyncQueue {
+public:
+	~AsyncQueue() { stop(); }
+
+	/**
+	 * Queue a transfer of `amount` bytes, which is carried out by calling
+	 * `transfer` for each slice in turn with the offset into the operation.
+	 */
+	std::shared_ptr<AsyncOperation> enqueue(AsyncOperation::TransferFn transfer, uint64_t amount,
+		AsyncOperation::CompletionFn onComplete);
+
+	// Cancel everything queued or running, as AsyncOperation::cancel() does
+	void cancelAll();
+
+	// Cancel everything and wait for the background thread to finish
+	void stop();
+
+	// Large enough that drivers which stream long reads still do so,
+	// small enough to transfer within the default disk timeout
+	uint64_t sliceSize = 256 * 1024;
+
+private:
+	std::mutex mutex;
+	std::condition_variable queueChanged;
+	std::deque< std::shared_ptr<AsyncOperation> > queue;
+	std::shared_ptr<AsyncOperation> running;
+	bool stopping = false;
+	std::thread thread;
+
+	void run();
+	static void Finish(AsyncOperation& operation, AsyncOperation::State state, optional<uint64_t> result);
+};
+
+} // namespace Disk
+
+} // namespace icsneo
+
+#endif // __cplusplus
+
+#endif // __ASYNCDISKQUEUE_H__
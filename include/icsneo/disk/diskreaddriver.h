@@ -9,6 +9,11 @@
 #include "icsneo/disk/diskdriver.h"
 #include <cstdint>
 #include <chrono>
+#include <vector>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <limits>
 
 namespace icsneo {
 
@@ -22,6 +27,56 @@ public:
 	virtual optional<uint64_t> readLogicalDisk(Communication& com, device_eventhandler_t report,
 		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout = DefaultTimeout);
 
+	/**
+	 * For drivers which support pipelined reads, the number of block reads
+	 * to keep in flight at once. Responses may arrive in any order.
+	 *
+	 * A read which starts where the last one ended is treated as streaming,
+	 * and readaheadBlocks blocks past its end are requested ahead of time.
+	 * Blocks read ahead are used once, and only within readaheadLifetime,
+	 * as the device may still be writing to the disk.
+	 */
+	size_t maxOutstandingReads = 8;
+	size_t readaheadBlocks = 8;
+	std::chrono::milliseconds readaheadLifetime = std::chrono::seconds(1);
+
+	// Forget any blocks read ahead, such as when the disk has been written to
+	void discardReadahead();
+
+	/**
+	 * Recently read blocks are kept, up to cacheMaxBytes, so that reading
+	 * the same area again (such as filesystem metadata) does not go back
+	 * to the device. The least recently used blocks are dropped first.
+	 *
+	 * Cached blocks are only trusted for cacheLifetime, as the device may
+	 * still be writing to the disk. A cacheMaxBytes of 0 disables the cache.
+	 *
+	 * Only reads of up to cacheMaxReadSize which are not streaming are
+	 * cached, so that bulk transfers do not push out the small areas which
+	 * are read again and again.
+	 */
+	size_t cacheMaxBytes = 4 * 1024 * 1024;
+	size_t cacheMaxReadSize = 64 * 1024;
+	std::chrono::milliseconds cacheLifetime = std::chrono::seconds(1);
+
+	struct CacheStats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+		size_t cachedBlocks = 0;
+		size_t cachedBytes = 0;
+	};
+	CacheStats getCacheStats() const;
+	void resetCacheStats();
+
+	/**
+	 * Forget anything cached or read ahead for this area of the disk,
+	 * given in the same terms as readLogicalDisk(), or for the whole
+	 * disk if no area is given.
+	 */
+	void invalidateCache(uint64_t pos, uint64_t amount);
+	void invalidateCache();
+
 protected:
 	/**
 	 * Perform a read which the driver can do in one shot.
@@ -31,6 +86,74 @@ protected:
 	 */
 	virtual optional<uint64_t> readLogicalDiskAligned(Communication& com, device_eventhandler_t report,
 		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout) = 0;
+
+	// Drivers which can have several reads outstanding at once return true and implement the functions below
+	virtual bool supportsPipelinedReads() const { return false; }
+
+	/**
+	 * Start a read which the driver can do in one shot, with the same rules
+	 * as readLogicalDiskAligned(). Returns false if it could not be started.
+	 *
+	 * The `into` buffer remains valid until the read is finished.
+	 */
+	virtual bool beginReadLogicalDiskAligned(Communication& com, device_eventhandler_t report,
+		uint64_t pos, uint8_t* into, uint64_t amount);
+
+	/**
+	 * Wait for any started read to finish, in whichever order the device
+	 * answers them. The position given to beginReadLogicalDiskAligned() is
+	 * written to `pos`, and the result as readLogicalDiskAligned() would
+	 * return it to `result`.
+	 *
+	 * Returns false if no read finished within the timeout.
+	 */
+	virtual bool finishReadLogicalDiskAligned(Communication& com, uint64_t& pos, optional<uint64_t>& result,
+		std::chrono::milliseconds timeout);
+
+	/**
+	 * Give up on every started read, such as when the device has stopped
+	 * answering. The `into` buffers given for them must not be written to
+	 * once this returns.
+	 */
+	virtual void cancelPipelinedReads(Communication& com);
+
+private:
+	class PipelinedBlock {
+	public:
+		std::vector<uint8_t> data;
+		bool finished = false;
+		bool discard = false; // Dropped as soon as it finishes
+		optional<uint64_t> result;
+		std::chrono::steady_clock::time_point finishedAt;
+	};
+
+	class CachedBlock {
+	public:
+		uint64_t pos;
+		std::vector<uint8_t> data;
+		std::chrono::steady_clock::time_point cachedAt;
+	};
+
+	std::list<CachedBlock> cache; // Most recently used first
+	std::unordered_map<uint64_t, std::list<CachedBlock>::iterator> cacheIndex;
+	size_t cachedBytes = 0;
+	CacheStats cacheStats;
+
+	// Returns nullptr on a miss, and counts it towards the stats
+	const CachedBlock* findCachedBlock(uint64_t pos);
+	bool isCached(uint64_t pos) const;
+	void cacheBlock(uint64_t pos, const uint8_t* data, size_t size);
+	void eraseCachedBlock(std::list<CachedBlock>::iterator it);
+
+	// Keyed by position, both those in flight and those finished but not yet used
+	std::map<uint64_t, PipelinedBlock> pipelinedBlocks;
+	size_t readsInFlight = 0;
+	uint64_t streamingPos = std::numeric_limits<uint64_t>::max(); // Where the last read ended
+
+	optional<uint64_t> readLogicalDiskPipelined(Communication& com, device_eventhandler_t report,
+		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout);
+	bool finishPipelinedRead(Communication& com, std::chrono::milliseconds timeout);
+	void abandonPipeline(Communication& com);
 };
 
 } // namespace Disk
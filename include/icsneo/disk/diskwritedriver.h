@@ -19,6 +19,14 @@ namespace Disk {
  */
 class WriteDriver : public virtual Driver {
 public:
+	/**
+	 * Write `amount` bytes to the logical disk at `pos`.
+	 *
+	 * Whole sectors are written straight out, as many at a time as the
+	 * driver's block size allows. Only a partial sector at either end of
+	 * the write requires its chunk to be read first and written back
+	 * atomically.
+	 */
 	virtual optional<uint64_t> writeLogicalDisk(Communication& com, device_eventhandler_t report, ReadDriver& readDriver,
 		uint64_t pos, const uint8_t* from, uint64_t amount, std::chrono::milliseconds timeout = DefaultTimeout);
 
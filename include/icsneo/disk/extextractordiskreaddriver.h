@@ -22,22 +22,34 @@ public:
 		return { static_cast<uint32_t>(SectorSize), static_cast<uint32_t>(MaxSize) };
 	}
 
+	/**
+	 * Reads of at least a block are made with a single Extract request,
+	 * with the response written directly to the caller's buffer as it
+	 * arrives, rather than one request per block.
+	 */
+	bool streamingExtraction = true;
+
+	optional<uint64_t> readLogicalDisk(Communication& com, device_eventhandler_t report,
+		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout = DefaultTimeout) override;
+
 private:
 	static constexpr const uint32_t MaxSize = Disk::SectorSize * 512;
-	static constexpr const std::chrono::seconds CacheTime = std::chrono::seconds(1);
 	static constexpr const uint8_t HeaderLength = 7;
 
-	std::array<uint8_t, MaxSize> cache;
-	uint64_t cachePos = 0;
-	std::chrono::time_point<std::chrono::steady_clock> cachedAt;
-
 	Access getPossibleAccess() const override { return Access::EntireCard; }
 
 	optional<uint64_t> readLogicalDiskAligned(Communication& com, device_eventhandler_t report,
 		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout) override;
 
-	optional<uint64_t> attemptReadLogicalDiskAligned(Communication& com, device_eventhandler_t report,
-		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout);
+	/**
+	 * Make one Extract request, writing the response to `into` as it arrives.
+	 *
+	 * Returns how much arrived before the transfer completed, stalled for
+	 * `stallTimeout`, or the deadline passed, or icsneo::nullopt if the
+	 * request could not be made.
+	 */
+	optional<uint64_t> extract(Communication& com, uint64_t sector, uint32_t sectorCount, uint8_t* into,
+		std::chrono::milliseconds stallTimeout, std::chrono::steady_clock::time_point deadline);
 };
 
 } // namespace Disk
@@ -11,7 +11,22 @@ namespace icsneo {
 
 namespace Disk {
 
-optional<uint64_t> FindVSAInFAT(std::function< optional<uint64_t>(uint64_t pos, uint8_t* into, uint64_t amount) > diskRead);
+typedef std::function< optional<uint64_t>(uint64_t pos, uint8_t* into, uint64_t amount) > DiskReadFn;
+
+// Where LOG_DATA.VSA lives on the logical disk, in bytes
+struct VSAExtent {
+	uint64_t offset;
+	uint64_t size;
+};
+
+/**
+ * Find LOG_DATA.VSA in the FAT filesystem read through `diskRead`
+ *
+ * Lookups for different disks (such as for different devices) may run
+ * in parallel from separate threads.
+ */
+optional<VSAExtent> FindVSAExtentInFAT(DiskReadFn diskRead);
+optional<uint64_t> FindVSAInFAT(DiskReadFn diskRead);
 
 } // namespace Disk
 
@@ -19,4 +34,4 @@ optional<uint64_t> FindVSAInFAT(std::function< optional<uint64_t>(uint64_t pos,
 
 #endif // __cplusplus
 
-#endif // __FAT_H__
\ No newline at end of file
+#endif // __FAT_H__
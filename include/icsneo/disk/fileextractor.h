@@ -0,0 +1,85 @@
+#ifndef __FILEEXTRACTOR_H__
+#define __FILEEXTRACTOR_H__
+
+#ifdef __cplusplus
+
+#include "icsneo/platform/optional.h"
+#include "icsneo/api/eventmanager.h"
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace icsneo {
+
+namespace Disk {
+
+/**
+ * Copies an area of the logical disk, usually the VSA filesystem, to a file on the host
+ *
+ * Progress is checkpointed next to the output file as the extraction goes.
+ * If the extraction is interrupted, for instance by the device disconnecting,
+ * calling extract() again with the same arguments verifies what was already
+ * written against the checkpoint's checksums and carries on from there.
+ */
+class FileExtractor {
+public:
+	typedef std::function< optional<uint64_t>(uint64_t pos, uint8_t* into, uint64_t amount) > DiskReadFn;
+
+	struct Progress {
+		uint64_t extracted = 0; // Including anything extracted before resuming
+		uint64_t total = 0;
+		double megabytesPerSecond = 0; // Since this call to extract() started
+	};
+
+	static std::string CheckpointPath(const std::string& path) { return path + ".checkpoint"; }
+
+	// CRC-32, as used by zlib, which can be continued by passing in the previous result
+	static uint32_t CRC32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+	FileExtractor(DiskReadFn diskRead, device_eventhandler_t report) : diskRead(diskRead), report(report) {}
+
+	/**
+	 * Extract `amount` bytes of the logical disk, starting at `pos`, to
+	 * the file at `path`. Returns true once all of it has been written.
+	 *
+	 * The checkpoint is removed once the extraction has completed.
+	 */
+	bool extract(uint64_t pos, uint64_t amount, const std::string& path);
+
+	// The CRC-32 of everything extracted, once extract() has returned true
+	uint32_t getChecksum() const { return checksum; }
+
+	// How much each read from the disk asks for, while the previous one is written out
+	uint64_t chunkSize = 4 * 1024 * 1024;
+
+	// The extraction resumes from the last multiple of this which was written
+	uint64_t checkpointInterval = 64 * 1024 * 1024;
+
+	std::function<void(const Progress&)> onProgress;
+	std::chrono::milliseconds progressInterval = std::chrono::milliseconds(500);
+
+private:
+	class Segment {
+	public:
+		uint32_t crc; // Of this segment alone
+		uint32_t runningCrc; // Of everything up to the end of this segment
+	};
+
+	const DiskReadFn diskRead;
+	const device_eventhandler_t report;
+	uint32_t checksum = 0;
+
+	// Returns the segments which were found to be intact in the output file
+	std::vector<Segment> loadCheckpoint(uint64_t pos, uint64_t amount, const std::string& path);
+	bool saveCheckpoint(uint64_t pos, uint64_t amount, const std::string& path, const std::vector<Segment>& segments);
+};
+
+} // namespace Disk
+
+} // namespace icsneo
+
+#endif // __cplusplus
+
+#endif // __FILEEXTRACTOR_H__
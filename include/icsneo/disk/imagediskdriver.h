@@ -0,0 +1,92 @@
+#ifndef __IMAGEDISKDRIVER_H__
+#define __IMAGEDISKDRIVER_H__
+
+#ifdef __cplusplus
+
+#include "icsneo/disk/diskreaddriver.h"
+#include "icsneo/disk/diskwritedriver.h"
+#include "icsneo/platform/mappedfile.h"
+#include <memory>
+#include <string>
+#include <chrono>
+
+namespace icsneo {
+
+namespace Disk {
+
+/**
+ * A disk driver backed by an image file on the host, such as a dd of
+ * a device's SD card, mapped into memory
+ *
+ * This allows the disk layer, including the FAT and VSA tooling built
+ * on it, to run against archived disks without a device. The block size
+ * and latency can be set to mimic the drivers which talk to devices.
+ */
+class ImageDiskDriver : public ReadDriver, public WriteDriver {
+public:
+	ImageDiskDriver(device_eventhandler_t report);
+	~ImageDiskDriver();
+
+	/**
+	 * Map the image at `path`, replacing any image already open.
+	 *
+	 * Unless `writable` is set, writes are refused and the file is
+	 * left untouched.
+	 */
+	bool open(const std::string& path, bool writable = false);
+	bool isOpen() const { return image.isOpen(); }
+	void close();
+
+	// Write any changes back to the image file, this also happens on close
+	bool flush();
+
+	uint64_t getSize() const { return image.getSize(); }
+
+	std::pair<uint32_t, uint32_t> getBlockSizeBounds() const override {
+		static_assert(SectorSize <= std::numeric_limits<uint32_t>::max(), "Incorrect sector size");
+		return { static_cast<uint32_t>(SectorSize), maxBlockSize };
+	}
+
+	/**
+	 * The most transferred by each block read or write, a multiple of the sector size.
+	 * One sector mimics the NeoMemoryDiskDriver, 512 the ExtExtractorDiskReadDriver.
+	 */
+	uint32_t maxBlockSize = SectorSize;
+
+	// Added to every block read or write, to mimic the round trip to a device
+	std::chrono::microseconds latency{0};
+
+	// An image of the entire card has the FAT filesystem around the VSA, otherwise it is the VSA alone
+	Access access = Access::EntireCard;
+
+	/**
+	 * Read or write the image as the Device does, through the block
+	 * handling and cache of the disk layer, without needing a device.
+	 */
+	optional<uint64_t> readLogicalDisk(uint64_t pos, uint8_t* into, uint64_t amount);
+	optional<uint64_t> writeLogicalDisk(uint64_t pos, const uint8_t* from, uint64_t amount);
+	using ReadDriver::readLogicalDisk;
+	using WriteDriver::writeLogicalDisk;
+
+private:
+	const device_eventhandler_t report;
+	MappedFile image;
+
+	// Never opened, the image has nothing to communicate with but the disk layer asks for one
+	std::unique_ptr<Communication> offlineCom;
+
+	Access getPossibleAccess() const override { return access; }
+
+	optional<uint64_t> readLogicalDiskAligned(Communication& com, device_eventhandler_t report,
+		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout) override;
+
+	optional<uint64_t> writeLogicalDiskAligned(Communication& com, device_eventhandler_t report,
+		uint64_t pos, const uint8_t* atomicBuf, const uint8_t* from, uint64_t amount, std::chrono::milliseconds timeout) override;
+};
+
+} // namespace Disk
+
+} // namespace icsneo
+
+#endif // __cplusplus
+#endif // __IMAGEDISKDRIVER_H__
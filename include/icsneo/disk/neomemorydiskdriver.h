@@ -7,6 +7,11 @@
 #include "icsneo/disk/diskwritedriver.h"
 #include <limits>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
 
 namespace icsneo {
 
@@ -15,7 +20,8 @@ namespace Disk {
 /**
  * A disk driver which uses the neoMemory command to read from or write to the disk
  * 
- * This can only make requests per sector, so it will be very slow, but is likely supported by any device with a disk
+ * This can only make requests per sector, so it will be very slow, but is likely supported by any device with a disk.
+ * Several requests are kept in flight at once to make up for it, see ReadDriver::maxOutstandingReads.
  */
 class NeoMemoryDiskDriver : public ReadDriver, public WriteDriver {
 public:
@@ -27,16 +33,44 @@ public:
 
 private:
 	static constexpr const uint8_t MemoryTypeSD = 0x01; // Logical Disk
-	static constexpr const std::chrono::seconds CacheTime = std::chrono::seconds(1);
 
-	std::array<uint8_t, SectorSize> cache;
-	uint64_t cachePos = 0;
-	std::chrono::time_point<std::chrono::steady_clock> cachedAt;
+	// Responses to pipelined reads, gathered by a message callback which may outlive the driver
+	class PipelineResponses {
+	public:
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::deque<std::shared_ptr<Message>> responses;
+	};
+
+	class PendingRead {
+	public:
+		uint64_t pos;
+		uint8_t* into;
+	};
+
+	std::shared_ptr<PipelineResponses> pipelineResponses = std::make_shared<PipelineResponses>();
+	std::map<uint32_t, PendingRead> pendingReads; // Keyed by sector, which each response carries as its startAddress
+	int pipelineCallback = -1;
+	device_eventhandler_t pipelineReport;
+
+	void stopPipeline(Communication& com);
+
+	static bool SendReadCommand(Communication& com, uint64_t sector);
 
 	Access getPossibleAccess() const override { return Access::VSA; }
 
 	optional<uint64_t> readLogicalDiskAligned(Communication& com, device_eventhandler_t report,
 		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds timeout) override;
+
+	bool supportsPipelinedReads() const override { return true; }
+
+	bool beginReadLogicalDiskAligned(Communication& com, device_eventhandler_t report,
+		uint64_t pos, uint8_t* into, uint64_t amount) override;
+
+	bool finishReadLogicalDiskAligned(Communication& com, uint64_t& pos, optional<uint64_t>& result,
+		std::chrono::milliseconds timeout) override;
+
+	void cancelPipelinedReads(Communication& com) override;
 	
 	optional<uint64_t> writeLogicalDiskAligned(Communication& com, device_eventhandler_t report,
 		uint64_t pos, const uint8_t* atomicBuf, const uint8_t* from, uint64_t amount, std::chrono::milliseconds timeout) override;
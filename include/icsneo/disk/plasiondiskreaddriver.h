@@ -24,11 +24,9 @@ public:
 
 private:
 	static constexpr const uint32_t MaxSize = 65024;
-	static constexpr const std::chrono::seconds CacheTime = std::chrono::seconds(1);
 
-	std::array<uint8_t, MaxSize> cache;
-	uint64_t cachePos = 0;
-	std::chrono::time_point<std::chrono::steady_clock> cachedAt;
+	// Received into here, rather than the caller's buffer, in case data arrives after we've given up
+	std::array<uint8_t, MaxSize> readBuffer;
 
 	Access getPossibleAccess() const override { return Access::EntireCard; }
 
@@ -294,6 +294,24 @@ extern bool DLLExport icsneo_setPollingMessageLimit(const neodevice_t* device, s
  */
 extern int DLLExport icsneo_addMessageCallback(const neodevice_t* device, void (*callback)(neomessage_t), void*);
 
+/**
+ * \brief Adds a message callback to the specified device which is called with many messages at once.
+ * \param[in] device A pointer to the neodevice_t structure specifying the device to operate on.
+ * \param[in] callback A function pointer with void return type, taking an array of neomessage_t and its length.
+ * \param[in] maxMessages Deliver the batch as soon as it holds this many messages, or 0 for no limit.
+ * \param[in] maxLatencyMicroseconds Collect messages until the oldest has waited this long, or 0 to deliver the messages from each read from the device.
+ * \param[in] filter Unused for now. Exists as a placeholder here for future backwards-compatibility.
+ * \returns The id of the callback added, or -1 if the operation failed.
+ *
+ * This avoids the overhead of a call per message for callbacks receiving messages at a high rate.
+ *
+ * The messages, including their data, are only valid until the callback returns.
+ *
+ * The callback is removed with icsneo_removeMessageCallback().
+ */
+extern int DLLExport icsneo_addBatchMessageCallback(const neodevice_t* device, void (*callback)(const neomessage_t* messages, size_t count),
+	size_t maxMessages, uint32_t maxLatencyMicroseconds, void*);
+
 /**
  * \brief Removes a message callback from the specified device.
  * \param[in] device A pointer to the neodevice_t structure specifying the device to operate on.
@@ -868,6 +886,10 @@ fn_icsneo_setPollingMessageLimit icsneo_setPollingMessageLimit;
 typedef int(*fn_icsneo_addMessageCallback)(const neodevice_t* device, void (*callback)(neomessage_t), void*);
 fn_icsneo_addMessageCallback icsneo_addMessageCallback;
 
+typedef int(*fn_icsneo_addBatchMessageCallback)(const neodevice_t* device, void (*callback)(const neomessage_t* messages, size_t count),
+	size_t maxMessages, uint32_t maxLatencyMicroseconds, void*);
+fn_icsneo_addBatchMessageCallback icsneo_addBatchMessageCallback;
+
 typedef bool(*fn_icsneo_removeMessageCallback)(const neodevice_t* device, int id);
 fn_icsneo_removeMessageCallback icsneo_removeMessageCallback;
 
@@ -1011,6 +1033,7 @@ int icsneo_init() {
 	ICSNEO_IMPORTASSERT(icsneo_getPollingMessageLimit);
 	ICSNEO_IMPORTASSERT(icsneo_setPollingMessageLimit);
 	ICSNEO_IMPORTASSERT(icsneo_addMessageCallback);
+	ICSNEO_IMPORTASSERT(icsneo_addBatchMessageCallback);
 	ICSNEO_IMPORTASSERT(icsneo_removeMessageCallback);
 	ICSNEO_IMPORTASSERT(icsneo_getNetworkByNumber);
 	ICSNEO_IMPORTASSERT(icsneo_getProductName);
@@ -0,0 +1,12 @@
+#ifndef __MAPPEDFILE_H_
+#define __MAPPEDFILE_H_
+
+#if defined _WIN32
+#include "icsneo/platform/windows/mappedfile.h"
+#elif defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+#include "icsneo/platform/posix/mappedfile.h"
+#else
+#warning "This platform is not supported by the mapped file driver"
+#endif
+
+#endif
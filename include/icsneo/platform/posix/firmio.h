@@ -29,7 +29,7 @@ private:
 	void writeTask() override;
 	bool writeQueueFull() override;
 	bool writeQueueAlmostFull() override;
-	bool writeInternal(const std::vector<uint8_t>& bytes) override;
+	bool writeInternal(const uint8_t* bytes, size_t size) override;
 
 	struct DataInfo {
 		uint32_t type;
@@ -24,11 +24,14 @@ public:
 	bool isOpen() override;
 	bool close() override;
 	bool isEthernet() const override { return true; }
+	size_t getMTU() const override;
+	bool setMTU(size_t mtu) override;
 private:
 	char errbuf[PCAP_ERRBUF_SIZE] = { 0 };
 	neodevice_t& device;
 	uint8_t deviceMAC[6];
 	bool openable = true;
+	size_t requestedMTU = EthernetPacketizer::StandardMTU;
 	EthernetPacketizer ethPacketizer;
 	void readTask() override;
 	void writeTask() override;
@@ -44,6 +47,7 @@ private:
 		pcap_stat stats;
 	};
 	static std::vector<NetworkInterface> knownInterfaces;
+	static size_t GetInterfaceMTU(const std::string& name);
 	NetworkInterface iface;
 };
 
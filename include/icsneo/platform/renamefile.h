@@ -0,0 +1,17 @@
+#ifndef __RENAMEFILE_H_
+#define __RENAMEFILE_H_
+
+#ifdef __cplusplus
+
+#include <string>
+
+namespace icsneo {
+
+// Move a file into place, replacing any file already at `to` in one step
+bool RenameFileReplacing(const std::string& from, const std::string& to);
+
+} // namespace icsneo
+
+#endif // __cplusplus
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __MAPPEDFILE_WINDOWS_H_
+#define __MAPPEDFILE_WINDOWS_H_
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <string>
+
+namespace icsneo {
+
+// A file on the host mapped into memory
+class MappedFile {
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() { close(); }
+
+	bool open(const std::string& path, bool writable);
+	bool isOpen() const { return data != nullptr; }
+	bool isWritable() const { return writable; }
+	void close();
+
+	// Write any changes made through getData() back to the file
+	bool flush();
+
+	uint8_t* getData() const { return data; }
+	uint64_t getSize() const { return size; }
+
+private:
+	void* file = nullptr; // HANDLE, kept out of this header as windows.h is not needed by users
+	void* mapping = nullptr;
+	uint8_t* data = nullptr;
+	uint64_t size = 0;
+	bool writable = false;
+};
+
+}
+
+#endif // __cplusplus
+
+#endif
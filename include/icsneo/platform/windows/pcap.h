@@ -24,12 +24,15 @@ public:
 	bool isOpen() override;
 	bool close() override;
 	bool isEthernet() const override { return true; }
+	size_t getMTU() const override;
+	bool setMTU(size_t mtu) override;
 private:
 	const PCAPDLL& pcap;
 	char errbuf[PCAP_ERRBUF_SIZE] = { 0 };
 	neodevice_t& device;
 	uint8_t deviceMAC[6];
 	bool openable = true;
+	size_t requestedMTU = EthernetPacketizer::StandardMTU;
 	EthernetPacketizer ethPacketizer;
 	
 	std::thread transmitThread;
@@ -51,6 +54,7 @@ private:
 		std::string descriptionFromWin32API;
 		std::string friendlyNameFromWin32API;
 		std::string fullName;
+		size_t mtu = EthernetPacketizer::StandardMTU;
 		pcap_t* fp = nullptr;
 		pcap_stat stats;
 	};
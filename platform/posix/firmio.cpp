@@ -271,21 +271,21 @@ bool FirmIO::writeQueueAlmostFull() {
 	return writeQueueFull();
 }
 
-bool FirmIO::writeInternal(const std::vector<uint8_t>& bytes) {
-	if(bytes.empty() || bytes.size() > Mempool::BlockSize)
+bool FirmIO::writeInternal(const uint8_t* bytes, size_t size) {
+	if(size == 0 || size > Mempool::BlockSize)
 		return false;
 
 	std::lock_guard<std::mutex> lk(outMutex);
-	uint8_t* sharedData = outMemory->alloc(bytes.size());
+	uint8_t* sharedData = outMemory->alloc(size);
 	if(sharedData == nullptr)
 		return false;
 
-	// std::cout << "coping " << bytes.size() << " bytes of data" << std::endl;
-	memcpy(sharedData, bytes.data(), bytes.size());
+	// std::cout << "coping " << size << " bytes of data" << std::endl;
+	memcpy(sharedData, bytes, size);
 
 	Msg msg = { Msg::Command::ComData };
 	msg.payload.data.addr = outMemory->translate(sharedData);
-	msg.payload.data.len = static_cast<uint32_t>(bytes.size());
+	msg.payload.data.len = static_cast<uint32_t>(size);
 	msg.payload.data.ref = reinterpret_cast<uint32_t>(sharedData);
 
 	if(!out->write(&msg))
@@ -0,0 +1,55 @@
+#include "icsneo/platform/mappedfile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace icsneo;
+
+bool MappedFile::open(const std::string& path, bool writable) {
+	close();
+
+	fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size <= 0) { // An empty file can not be mapped
+		close();
+		return false;
+	}
+
+	void* mapped = mmap(nullptr, size_t(st.st_size), writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+	if(mapped == MAP_FAILED) {
+		close();
+		return false;
+	}
+
+	// Disk images are mostly read from start to end
+	madvise(mapped, size_t(st.st_size), MADV_SEQUENTIAL);
+
+	data = static_cast<uint8_t*>(mapped);
+	size = uint64_t(st.st_size);
+	this->writable = writable;
+	return true;
+}
+
+void MappedFile::close() {
+	if(data)
+		munmap(data, size_t(size));
+	data = nullptr;
+	size = 0;
+	writable = false;
+
+	if(fd >= 0)
+		::close(fd);
+	fd = -1;
+}
+
+bool MappedFile::flush() {
+	if(!data)
+		return false;
+	if(!writable)
+		return true;
+	return msync(data, size_t(size), MS_SYNC) == 0;
+}
@@ -5,14 +5,19 @@
 #include "icsneo/communication/packetizer.h"
 #include "icsneo/communication/decoder.h"
 #include <codecvt>
+#include <algorithm>
 #include <chrono>
 #include <cstring>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
 #ifdef __linux__
 #include <netpacket/packet.h>
 #else
 #include <net/if_dl.h>
+#include <sys/sockio.h>
 #endif
 
 using namespace icsneo;
@@ -195,6 +200,22 @@ void PCAP::Find(std::vector<FoundDevice>& found) {
 	}
 }
 
+size_t PCAP::GetInterfaceMTU(const std::string& name) {
+	struct ifreq ifr = {};
+	if(name.size() >= sizeof(ifr.ifr_name))
+		return EthernetPacketizer::StandardMTU;
+	strncpy(ifr.ifr_name, name.c_str(), sizeof(ifr.ifr_name) - 1);
+
+	const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if(sock < 0)
+		return EthernetPacketizer::StandardMTU;
+	const int ret = ioctl(sock, SIOCGIFMTU, &ifr);
+	::close(sock);
+	if(ret < 0 || ifr.ifr_mtu <= 0)
+		return EthernetPacketizer::StandardMTU; // Assume a standard link if the interface won't tell us
+	return size_t(ifr.ifr_mtu);
+}
+
 bool PCAP::IsHandleValid(neodevice_handle_t handle) {
 	uint8_t netifIndex = (uint8_t)(handle >> 24);
 	return (netifIndex < knownInterfaces.size());
@@ -241,6 +262,10 @@ bool PCAP::open() {
 	pcap_setnonblock(iface.fp, 0, errbuf);
 	pcap_set_immediate_mode(iface.fp, 1);
 
+	// Use the requested MTU, as long as the interface is able to carry it
+	const size_t mtu = std::min(requestedMTU, GetInterfaceMTU(iface.nameFromPCAP));
+	ethPacketizer.setMaxPacketLength(EthernetPacketizer::MaxPacketLengthForMTU(mtu));
+
 	// Create threads
 	readThread = std::thread(&PCAP::readTask, this);
 	writeThread = std::thread(&PCAP::writeTask, this);
@@ -276,6 +301,27 @@ bool PCAP::close() {
 	return true;
 }
 
+size_t PCAP::getMTU() const {
+	if(iface.fp == nullptr) // Not open, the interface may further limit this once we are
+		return requestedMTU;
+	return ethPacketizer.getMaxPacketLength() + EthernetPacketizer::HeaderLength;
+}
+
+bool PCAP::setMTU(size_t mtu) {
+	if(isOpen()) {
+		report(APIEvent::Type::DeviceCurrentlyOpen, APIEvent::Severity::Error);
+		return false;
+	}
+
+	if(EthernetPacketizer::MaxPacketLengthForMTU(mtu) == 0) {
+		report(APIEvent::Type::ParameterOutOfRange, APIEvent::Severity::Error);
+		return false;
+	}
+
+	requestedMTU = mtu;
+	return true;
+}
+
 void PCAP::readTask() {
 	EventManager::GetInstance().downgradeErrorsOnCurrentThread();
 	while (!closing) {
@@ -305,7 +351,7 @@ void PCAP::writeTask() {
 			packetsPushed++;
 			bytesPushed += writeOp.bytes.size();
 			ethPacketizer.inputDown(std::move(writeOp.bytes));
-		} while(bytesPushed < (EthernetPacketizer::MaxPacketLength - (bytesPushed / packetsPushed * 2)) && writeQueue.try_dequeue(writeOp));
+		} while(bytesPushed < (ethPacketizer.getMaxPacketLength() - (bytesPushed / packetsPushed * 2)) && writeQueue.try_dequeue(writeOp));
 
 		for(const auto& packet : ethPacketizer.outputDown()) {
 			pcap_sendpacket(iface.fp, packet.data(), (int)packet.size());
@@ -0,0 +1,8 @@
+#include "icsneo/platform/renamefile.h"
+#include <cstdio>
+
+using namespace icsneo;
+
+bool icsneo::RenameFileReplacing(const std::string& from, const std::string& to) {
+	return std::rename(from.c_str(), to.c_str()) == 0; // Replaces atomically on POSIX
+}
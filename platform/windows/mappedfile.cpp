@@ -0,0 +1,61 @@
+#include "icsneo/platform/mappedfile.h"
+#include "icsneo/platform/windows.h"
+
+using namespace icsneo;
+
+bool MappedFile::open(const std::string& path, bool writable) {
+	close();
+
+	HANDLE fileHandle = CreateFileA(path.c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+		FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+	file = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0) { // An empty file can not be mapped
+		close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(fileHandle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	if(!mapping) {
+		close();
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, writable ? (FILE_MAP_READ | FILE_MAP_WRITE) : FILE_MAP_READ, 0, 0, 0);
+	if(!view) {
+		close();
+		return false;
+	}
+
+	data = static_cast<uint8_t*>(view);
+	size = uint64_t(fileSize.QuadPart);
+	this->writable = writable;
+	return true;
+}
+
+void MappedFile::close() {
+	if(data)
+		UnmapViewOfFile(data);
+	data = nullptr;
+	size = 0;
+	writable = false;
+
+	if(mapping)
+		CloseHandle(mapping);
+	mapping = nullptr;
+
+	if(file)
+		CloseHandle(file);
+	file = nullptr;
+}
+
+bool MappedFile::flush() {
+	if(!data)
+		return false;
+	if(!writable)
+		return true;
+	return FlushViewOfFile(data, 0) && FlushFileBuffers(file);
+}
@@ -81,6 +81,8 @@ void PCAP::Find(std::vector<FoundDevice>& found) {
 			iface.nameFromWin32API = aa->AdapterName;
 			iface.descriptionFromWin32API = converter.to_bytes(aa->Description);
 			iface.friendlyNameFromWin32API = converter.to_bytes(aa->FriendlyName);
+			if(aa->Mtu != 0 && aa->Mtu != ULONG(-1))
+				iface.mtu = aa->Mtu;
 			if(iface.descriptionFromWin32API.find("LAN9512/LAN9514") != std::string::npos) {
 				// This is an Ethernet EVB device
 				iface.fullName = "Intrepid Ethernet EVB ( " + iface.friendlyNameFromWin32API + " : " + iface.descriptionFromWin32API + " )";
@@ -225,6 +227,10 @@ bool PCAP::open() {
 		return false;
 	}
 
+	// Use the requested MTU, as long as the interface is able to carry it
+	const size_t mtu = (std::min)(requestedMTU, iface.mtu);
+	ethPacketizer.setMaxPacketLength(EthernetPacketizer::MaxPacketLengthForMTU(mtu));
+
 	// Create threads
 	readThread = std::thread(&PCAP::readTask, this);
 	writeThread = std::thread(&PCAP::writeTask, this);
@@ -261,6 +267,27 @@ bool PCAP::close() {
 	return true;
 }
 
+size_t PCAP::getMTU() const {
+	if(iface.fp == nullptr) // Not open, the interface may further limit this once we are
+		return requestedMTU;
+	return ethPacketizer.getMaxPacketLength() + EthernetPacketizer::HeaderLength;
+}
+
+bool PCAP::setMTU(size_t mtu) {
+	if(isOpen()) {
+		report(APIEvent::Type::DeviceCurrentlyOpen, APIEvent::Severity::Error);
+		return false;
+	}
+
+	if(EthernetPacketizer::MaxPacketLengthForMTU(mtu) == 0) {
+		report(APIEvent::Type::ParameterOutOfRange, APIEvent::Severity::Error);
+		return false;
+	}
+
+	requestedMTU = mtu;
+	return true;
+}
+
 void PCAP::readTask() {
 	struct pcap_pkthdr* header;
 	const uint8_t* data;
@@ -285,6 +312,8 @@ void PCAP::writeTask() {
 	WriteOperation writeOp;
 	EventManager::GetInstance().downgradeErrorsOnCurrentThread();
 
+	// Ethernet header, our payload, and FCS
+	const unsigned int maxFrameLength = unsigned(14 + getMTU() + 4);
 	pcap_send_queue* queue1 = pcap.sendqueue_alloc(128000);
 	pcap_send_queue* queue2 = pcap.sendqueue_alloc(128000);
 	pcap_send_queue* queue = queue1;
@@ -297,7 +326,7 @@ void PCAP::writeTask() {
 			unsigned int i = 0;
 			do {
 				ethPacketizer.inputDown(std::move(writeOp.bytes));
-				if(i++ >= (queue->maxlen - queue->len) / 1518 / 3)
+				if(i++ >= (queue->maxlen - queue->len) / maxFrameLength / 3)
 					break; // Not safe to try to fit any more packets in this queue, let it transmit and come around again
 			} while(writeQueue.try_dequeue(writeOp));
 
@@ -315,7 +344,7 @@ void PCAP::writeTask() {
 		// If our queue is full and we're transmitting the other, we can't accept any more packets out of the writeQueue
 		// In that case we're putting as many packets into the driver as possible, so wait for it to be free
 		// This puts the backpressure on the writeQueue
-		if(queue->len && (!transmitQueue || queue->len + (1518*2) >= queue->maxlen)) {
+		if(queue->len && (!transmitQueue || queue->len + (maxFrameLength * 2) >= queue->maxlen)) {
 			if(transmitQueue) // Need to wait for the queue to become available
 				transmitQueueCV.wait(lk, [this] { return !transmitQueue; });
 			
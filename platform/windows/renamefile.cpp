@@ -0,0 +1,9 @@
+#include "icsneo/platform/renamefile.h"
+#include "icsneo/platform/windows.h"
+
+using namespace icsneo;
+
+bool icsneo::RenameFileReplacing(const std::string& from, const std::string& to) {
+	// std::rename will not replace an existing file on Windows
+	return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
@@ -0,0 +1,144 @@
+#include "icsneo/disk/asyncdiskqueue.h"
+#include "gtest/gtest.h"
+#include <vector>
+#include <thread>
+
+using namespace icsneo;
+
+class AsyncDiskQueueTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		queue.sliceSize = 16;
+	}
+
+	// Records which operation each slice belonged to, in order
+	Disk::AsyncOperation::TransferFn recordSlices(int id) {
+		return [this, id](uint64_t offset, uint64_t amount) -> optional<uint64_t> {
+			std::lock_guard<std::mutex> lk(slicesMutex);
+			slices.push_back({ id, offset, amount });
+			return amount;
+		};
+	}
+
+	struct Slice {
+		int id;
+		uint64_t offset;
+		uint64_t amount;
+	};
+
+	std::mutex slicesMutex;
+	std::vector<Slice> slices;
+	Disk::AsyncQueue queue;
+};
+
+TEST_F(AsyncDiskQueueTest, Completes)
+{
+	bool completed = false;
+	const auto operation = queue.enqueue(recordSlices(0), 40, [&completed](const Disk::AsyncOperation& op) {
+		EXPECT_EQ(op.getState(), Disk::AsyncOperation::State::Completed);
+		completed = true;
+	});
+	EXPECT_EQ(operation->wait(), 40u);
+	EXPECT_TRUE(operation->isDone());
+	EXPECT_EQ(operation->getTransferred(), 40u);
+	EXPECT_EQ(operation->getAmount(), 40u);
+	queue.stop();
+	EXPECT_TRUE(completed);
+
+	ASSERT_EQ(slices.size(), 3u);
+	EXPECT_EQ(slices[1].offset, 16u);
+	EXPECT_EQ(slices[2].offset, 32u);
+	EXPECT_EQ(slices[2].amount, 8u);
+}
+
+TEST_F(AsyncDiskQueueTest, OperationsTakeTurns)
+{
+	// Hold the first slice until everything is queued
+	std::promise<void> allQueued;
+	auto allQueuedFuture = allQueued.get_future().share();
+	const auto first = queue.enqueue([&](uint64_t offset, uint64_t amount) {
+		if(offset == 0)
+			allQueuedFuture.wait();
+		return recordSlices(0)(offset, amount);
+	}, 48, {});
+	const auto second = queue.enqueue(recordSlices(1), 48, {});
+	allQueued.set_value();
+
+	EXPECT_EQ(first->wait(), 48u);
+	EXPECT_EQ(second->wait(), 48u);
+	ASSERT_EQ(slices.size(), 6u);
+	for(size_t i = 0; i < slices.size(); i++)
+		EXPECT_EQ(slices[i].id, int(i % 2));
+}
+
+TEST_F(AsyncDiskQueueTest, Cancel)
+{
+	std::promise<void> sliceStarted;
+	std::promise<void> cancelled;
+	auto cancelledFuture = cancelled.get_future().share();
+	const auto operation = queue.enqueue([&](uint64_t offset, uint64_t amount) -> optional<uint64_t> {
+		if(offset == 0) {
+			sliceStarted.set_value();
+			cancelledFuture.wait();
+		}
+		return amount;
+	}, 64, {});
+	const auto queued = queue.enqueue(recordSlices(1), 64, {});
+
+	sliceStarted.get_future().wait();
+	EXPECT_EQ(operation->getState(), Disk::AsyncOperation::State::Running);
+	operation->cancel();
+	queued->cancel();
+	cancelled.set_value();
+
+	// The slice in progress finishes, but nothing after it
+	EXPECT_EQ(operation->wait(), 16u);
+	EXPECT_EQ(operation->getState(), Disk::AsyncOperation::State::Cancelled);
+	EXPECT_EQ(queued->wait(), 0u);
+	EXPECT_EQ(queued->getState(), Disk::AsyncOperation::State::Cancelled);
+	EXPECT_TRUE(slices.empty());
+}
+
+TEST_F(AsyncDiskQueueTest, Fails)
+{
+	const auto shortTransfer = queue.enqueue([](uint64_t offset, uint64_t amount) -> optional<uint64_t> {
+		if(offset == 16)
+			return amount / 2; // Such as reaching the end of the disk
+		return amount;
+	}, 64, {});
+	EXPECT_EQ(shortTransfer->wait(), 24u);
+	EXPECT_EQ(shortTransfer->getState(), Disk::AsyncOperation::State::Failed);
+
+	const auto nothing = queue.enqueue([](uint64_t, uint64_t) -> optional<uint64_t> { return nullopt; }, 64, {});
+	EXPECT_FALSE(nothing->wait().has_value());
+	EXPECT_EQ(nothing->getState(), Disk::AsyncOperation::State::Failed);
+}
+
+TEST_F(AsyncDiskQueueTest, StopCancelsQueued)
+{
+	std::promise<void> sliceStarted;
+	std::promise<void> release;
+	auto releaseFuture = release.get_future().share();
+	const auto running = queue.enqueue([&](uint64_t offset, uint64_t amount) -> optional<uint64_t> {
+		if(offset == 0) {
+			sliceStarted.set_value();
+			releaseFuture.wait();
+		}
+		return amount;
+	}, 64, {});
+	const auto queued = queue.enqueue(recordSlices(1), 64, {});
+	sliceStarted.get_future().wait();
+
+	std::thread stopper([this]() { queue.stop(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Give the stop a chance to be requested
+	release.set_value();
+	stopper.join();
+
+	EXPECT_EQ(running->getState(), Disk::AsyncOperation::State::Cancelled);
+	EXPECT_EQ(running->wait(), 16u);
+	EXPECT_EQ(queued->getState(), Disk::AsyncOperation::State::Cancelled);
+	EXPECT_TRUE(slices.empty());
+
+	// The queue can be used again afterwards
+	EXPECT_EQ(queue.enqueue(recordSlices(2), 8, {})->wait(), 8u);
+}
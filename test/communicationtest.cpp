@@ -0,0 +1,360 @@
+#include "icsneo/communication/communication.h"
+#include "icsneo/communication/message/main51message.h"
+#include "icsneo/communication/message/canerrorcountmessage.h"
+#include "icsneo/communication/message/filter/canmessagefilter.h"
+#include "icsneo/platform/optional.h"
+#include "gtest/gtest.h"
+#include "mockdriver.h"
+#include <thread>
+
+using namespace icsneo;
+
+// Only frames on the one network, where MessageFilter(netid) also takes CAN error counts from any network
+class FrameFilter : public MessageFilter {
+public:
+	FrameFilter(Network::NetID netid) : MessageFilter(netid) { messageType = Message::Type::Frame; }
+};
+
+class CommunicationTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		onError = [](APIEvent::Type, APIEvent::Severity) {
+			// Unless caught by the test, communication should not throw errors
+			EXPECT_TRUE(false);
+		};
+		const device_eventhandler_t report = [this](APIEvent::Type t, APIEvent::Severity s) {
+			onError(t, s);
+		};
+		auto mockDriver = std::unique_ptr<MockDriver>(new MockDriver(report));
+		driver = mockDriver.get();
+		com.emplace(report, std::move(mockDriver), [report]() {
+			return std::unique_ptr<Packetizer>(new Packetizer(report));
+		}, std::unique_ptr<Encoder>(new Encoder(report)), std::unique_ptr<Decoder>(new Decoder(report)));
+		com->packetizer = com->makeConfiguredPacketizer();
+	}
+
+	void TearDown() override {
+		if(com->isOpen())
+			com->close();
+		// The destructor will try to close again
+		onError = [](APIEvent::Type, APIEvent::Severity) {};
+		com.reset();
+	}
+
+	// A short format Main51 packet carrying the given command
+	static std::vector<uint8_t> Main51Packet(uint8_t command) {
+		return { 0xAA, uint8_t((1 << 4) | uint8_t(Network::NetID::Main51)), command, Packetizer::ICSChecksum({ command }) };
+	}
+
+	// A long format CAN packet on the given network
+	static std::vector<uint8_t> CANPacket(Network::NetID netid) {
+		std::vector<uint8_t> packet = { 0xAA, 0x00, 6 + 24, 0x00, uint8_t(netid), uint8_t(uint16_t(netid) >> 8) };
+		packet.resize(6 + 24);
+		return packet;
+	}
+
+	// A long format CAN packet reporting the error counters, as the device sends when they change
+	static std::vector<uint8_t> CANErrorCountPacket(Network::NetID netid, uint8_t tec, uint8_t rec, bool busOff) {
+		std::vector<uint8_t> packet = CANPacket(netid);
+		packet[6 + 5] = 0x01; // RB1
+		packet[6 + 6] = busOff ? 0x20 : 0x00;
+		packet[6 + 7] = rec;
+		packet[6 + 8] = tec;
+		return packet;
+	}
+
+	// Wait for the read thread(s) to get through everything we've given them
+	bool waitFor(const std::function<bool()>& done) {
+		for(int i = 0; i < 500; i++) {
+			if(done())
+				return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		return false;
+	}
+
+	optional<Communication> com;
+	MockDriver* driver = nullptr;
+	device_eventhandler_t onError;
+};
+
+TEST_F(CommunicationTest, Dispatch)
+{
+	std::atomic<size_t> received{0};
+	com->addMessageCallback(MessageCallback(MessageFilter(Message::Type::Main51), [&received](std::shared_ptr<Message> msg) {
+		EXPECT_EQ(std::static_pointer_cast<Main51Message>(msg)->command, Command::RequestStatusUpdate);
+		received++;
+	}));
+	ASSERT_TRUE(com->open());
+	for(int i = 0; i < 100; i++)
+		driver->receive(Main51Packet(uint8_t(Command::RequestStatusUpdate)));
+	EXPECT_TRUE(waitFor([&received]() { return received == 100; }));
+
+	// Stats are only kept in pipelined mode
+	const auto stats = com->getPipelineStats();
+	EXPECT_EQ(stats.packetizing.processed, 0u);
+	EXPECT_EQ(stats.decoding.processed, 0u);
+}
+
+TEST_F(CommunicationTest, PipelinedDispatch)
+{
+	std::atomic<size_t> received{0};
+	com->addMessageCallback(MessageCallback(MessageFilter(Message::Type::Main51), [&received](std::shared_ptr<Message> msg) {
+		EXPECT_EQ(std::static_pointer_cast<Main51Message>(msg)->command, Command::RequestStatusUpdate);
+		received++;
+	}));
+	com->pipelined = true;
+	ASSERT_TRUE(com->open());
+	std::vector<uint8_t> bytes;
+	for(int i = 0; i < 100; i++) {
+		const auto packet = Main51Packet(uint8_t(Command::RequestStatusUpdate));
+		bytes.insert(bytes.end(), packet.begin(), packet.end());
+	}
+	driver->receive(bytes);
+	EXPECT_TRUE(waitFor([&received]() { return received == 100; }));
+
+	const auto stats = com->getPipelineStats();
+	EXPECT_GE(stats.packetizing.processed, 1u);
+	EXPECT_GE(stats.packetizing.maxQueueDepth, 4u); // At least one packet's worth of bytes
+	EXPECT_EQ(stats.decoding.processed, 100u);
+	EXPECT_GE(stats.decoding.maxQueueDepth, 1u);
+	EXPECT_EQ(stats.overflows, 0u);
+
+	com->resetPipelineStats();
+	EXPECT_EQ(com->getPipelineStats().decoding.processed, 0u);
+}
+
+TEST_F(CommunicationTest, PipelinedSlowCallbackOverflows)
+{
+	std::atomic<size_t> overflowEvents{0};
+	onError = [&overflowEvents](APIEvent::Type t, APIEvent::Severity s) {
+		EXPECT_EQ(t, APIEvent::Type::DecodeQueueOverflow);
+		EXPECT_EQ(s, APIEvent::Severity::EventWarning);
+		overflowEvents++;
+	};
+
+	std::atomic<bool> release{false};
+	std::atomic<size_t> received{0};
+	com->addMessageCallback(MessageCallback(MessageFilter(Message::Type::Main51), [&release, &received](std::shared_ptr<Message>) {
+		while(!release)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		received++;
+	}));
+	com->pipelined = true;
+	com->pipelineQueueSize = 16;
+	ASSERT_TRUE(com->open());
+
+	// The callback is stuck, but the packetizing thread must keep up with the driver
+	for(int i = 0; i < 1000; i++)
+		driver->receive(Main51Packet(uint8_t(Command::RequestStatusUpdate)));
+	EXPECT_TRUE(waitFor([this]() { return driver->getReadQueueSize() == 0 && com->getPipelineStats().overflows > 0; }));
+	release = true;
+
+	EXPECT_TRUE(waitFor([this, &received]() { return received + com->getPipelineStats().overflows == 1000; }));
+	const auto stats = com->getPipelineStats();
+	EXPECT_GT(stats.overflows, 1u);
+	EXPECT_EQ(overflowEvents, 1u); // The queue never drained while packets were arriving, so it is one overflow
+	EXPECT_EQ(stats.decoding.processed, received.load());
+	EXPECT_GE(stats.decoding.maxQueueDepth, 16u);
+	EXPECT_GT(stats.decoding.maxProcessingTime, std::chrono::nanoseconds(0));
+}
+
+TEST_F(CommunicationTest, BatchCallbackPerRead)
+{
+	std::mutex mutex;
+	std::vector<size_t> batches;
+	com->addMessageCallback(BatchMessageCallback(MessageFilter(Message::Type::Main51), [&](std::vector<std::shared_ptr<Message>> msgs) {
+		std::lock_guard<std::mutex> lk(mutex);
+		batches.push_back(msgs.size());
+	}));
+	ASSERT_TRUE(com->open());
+
+	// Each call is seen as one read by the read thread
+	std::vector<uint8_t> bytes;
+	for(int i = 0; i < 10; i++) {
+		const auto packet = Main51Packet(uint8_t(Command::RequestStatusUpdate));
+		bytes.insert(bytes.end(), packet.begin(), packet.end());
+	}
+	driver->receive(bytes);
+	EXPECT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> lk(mutex); return !batches.empty(); }));
+	driver->receive(Main51Packet(uint8_t(Command::RequestStatusUpdate)));
+	EXPECT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> lk(mutex); return batches.size() == 2; }));
+
+	std::lock_guard<std::mutex> lk(mutex);
+	EXPECT_EQ(batches, std::vector<size_t>({ 10, 1 }));
+}
+
+TEST_F(CommunicationTest, BatchCallbackMaxMessages)
+{
+	std::mutex mutex;
+	std::vector<size_t> batches;
+	com->addMessageCallback(BatchMessageCallback([&](std::vector<std::shared_ptr<Message>> msgs) {
+		std::lock_guard<std::mutex> lk(mutex);
+		batches.push_back(msgs.size());
+	}, MessageFilter(Message::Type::Main51), 4));
+	ASSERT_TRUE(com->open());
+
+	std::vector<uint8_t> bytes;
+	for(int i = 0; i < 10; i++) {
+		const auto packet = Main51Packet(uint8_t(Command::RequestStatusUpdate));
+		bytes.insert(bytes.end(), packet.begin(), packet.end());
+	}
+	driver->receive(bytes);
+	EXPECT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> lk(mutex); return batches.size() == 3; }));
+
+	std::lock_guard<std::mutex> lk(mutex);
+	EXPECT_EQ(batches, std::vector<size_t>({ 4, 4, 2 }));
+}
+
+TEST_F(CommunicationTest, BatchCallbackMaxLatency)
+{
+	std::mutex mutex;
+	std::vector<size_t> batches;
+	com->addMessageCallback(BatchMessageCallback([&](std::vector<std::shared_ptr<Message>> msgs) {
+		std::lock_guard<std::mutex> lk(mutex);
+		batches.push_back(msgs.size());
+	}, MessageFilter(Message::Type::Main51), 0, std::chrono::milliseconds(50)));
+	ASSERT_TRUE(com->open());
+
+	// Separate reads, well within the latency, are collected into one batch
+	for(int i = 0; i < 5; i++)
+		driver->receive(Main51Packet(uint8_t(Command::RequestStatusUpdate)));
+	EXPECT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> lk(mutex); return !batches.empty(); }));
+
+	std::lock_guard<std::mutex> lk(mutex);
+	EXPECT_EQ(batches, std::vector<size_t>({ 5 }));
+}
+
+TEST_F(CommunicationTest, BatchCallbackPipelined)
+{
+	std::atomic<size_t> received{0};
+	std::atomic<size_t> calls{0};
+	int id = com->addMessageCallback(BatchMessageCallback(MessageFilter(Message::Type::Main51), [&](std::vector<std::shared_ptr<Message>> msgs) {
+		received += msgs.size();
+		calls++;
+	}));
+	com->pipelined = true;
+	ASSERT_TRUE(com->open());
+
+	std::vector<uint8_t> bytes;
+	for(int i = 0; i < 100; i++) {
+		const auto packet = Main51Packet(uint8_t(Command::RequestStatusUpdate));
+		bytes.insert(bytes.end(), packet.begin(), packet.end());
+	}
+	driver->receive(bytes);
+	EXPECT_TRUE(waitFor([&received]() { return received == 100; }));
+	EXPECT_GE(calls, 1u);
+	EXPECT_LE(calls, 100u);
+
+	EXPECT_TRUE(com->removeMessageCallback(id));
+	driver->receive(bytes);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(received, 100u);
+}
+
+TEST_F(CommunicationTest, BlockingAsyncCallbackMayChangeCallbacks)
+{
+	// The read thread waits for room in the queue while the callback adds and removes callbacks
+	std::atomic<size_t> received{0};
+	MessageCallback cb(MessageFilter(Message::Type::Main51), [this, &received](std::shared_ptr<Message>) {
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+		com->removeMessageCallback(com->addMessageCallback(MessageCallback([](std::shared_ptr<Message>) {})));
+		received++;
+	});
+	cb.runAsync(1, CallbackExecutor::QueueFullPolicy::Block);
+	com->addMessageCallback(cb);
+	ASSERT_TRUE(com->open());
+
+	std::vector<uint8_t> bytes;
+	for(int i = 0; i < 50; i++) {
+		const auto packet = Main51Packet(uint8_t(Command::RequestStatusUpdate));
+		bytes.insert(bytes.end(), packet.begin(), packet.end());
+	}
+	driver->receive(bytes);
+	EXPECT_TRUE(waitFor([&received]() { return received == 50; }));
+	EXPECT_EQ(cb.getAsyncStats().dropped, 0u);
+}
+
+TEST_F(CommunicationTest, Subscriptions)
+{
+	// Nothing wants frames until a callback could match them, internal traffic is always wanted
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::HSCAN));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::Ethernet));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::Main51));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::Device));
+
+	const int main51 = com->addMessageCallback(MessageCallback(MessageFilter(Message::Type::Main51), [](std::shared_ptr<Message>) {}));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::HSCAN));
+
+	const int hscan = com->addMessageCallback(MessageCallback(FrameFilter(Network::NetID::HSCAN), [](std::shared_ptr<Message>) {}));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::HSCAN));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::MSCAN));
+
+	const int can = com->addMessageCallback(BatchMessageCallback([](std::vector<std::shared_ptr<Message>>) {},
+		std::make_shared<CANMessageFilter>(0x123)));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::MSCAN));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::HSCAN3));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::Ethernet));
+
+	EXPECT_TRUE(com->removeMessageCallback(can));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::MSCAN));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::HSCAN));
+
+	// Any type of message on Ethernet, which includes CAN error counts as those are not checked against the network
+	const int ethernet = com->addMessageCallback(MessageCallback(MessageFilter(Network::NetID::Ethernet), [](std::shared_ptr<Message>) {}));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::Ethernet));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::MSCAN));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::FlexRay));
+
+	const int everything = com->addMessageCallback(MessageCallback([](std::shared_ptr<Message>) {}));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::FlexRay));
+
+	for(const int id : { main51, hscan, ethernet, everything })
+		EXPECT_TRUE(com->removeMessageCallback(id));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::HSCAN));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::Ethernet));
+}
+
+TEST_F(CommunicationTest, UnsubscribedTrafficIsNotDecoded)
+{
+	std::atomic<size_t> decodedMSCAN{0};
+	com->decoder->setDecodeFunction(Network::NetID::MSCAN, [&decodedMSCAN](Decoder& d, std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+		decodedMSCAN++;
+		return d.decodeDefault(result, packet);
+	});
+
+	std::atomic<size_t> received{0};
+	com->addMessageCallback(MessageCallback(FrameFilter(Network::NetID::HSCAN), [&received](std::shared_ptr<Message> msg) {
+		EXPECT_EQ(std::static_pointer_cast<Frame>(msg)->network, Network::NetID::HSCAN);
+		received++;
+	}));
+	ASSERT_TRUE(com->open());
+	for(int i = 0; i < 50; i++) {
+		driver->receive(CANPacket(Network::NetID::HSCAN));
+		driver->receive(CANPacket(Network::NetID::MSCAN));
+	}
+	EXPECT_TRUE(waitFor([&] { return com->getReceivedPacketCount() == 100 && received == 50; }));
+	EXPECT_EQ(decodedMSCAN, 0u);
+}
+
+TEST_F(CommunicationTest, CANErrorCountSubscribesCANNetworks)
+{
+	std::atomic<size_t> received{0};
+	com->addMessageCallback(MessageCallback(MessageFilter(Message::Type::CANErrorCount), [&received](std::shared_ptr<Message> msg) {
+		ASSERT_EQ(msg->type, Message::Type::CANErrorCount);
+		const auto errors = std::static_pointer_cast<CANErrorCountMessage>(msg);
+		EXPECT_EQ(errors->network, Network::NetID::MSCAN);
+		EXPECT_EQ(errors->transmitErrorCount, 7u);
+		EXPECT_EQ(errors->receiveErrorCount, 5u);
+		EXPECT_TRUE(errors->busOff);
+		received++;
+	}));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::HSCAN));
+	EXPECT_TRUE(com->isSubscribed(Network::NetID::MSCAN));
+	EXPECT_FALSE(com->isSubscribed(Network::NetID::Ethernet));
+
+	ASSERT_TRUE(com->open());
+	driver->receive(CANPacket(Network::NetID::MSCAN)); // A frame, which does not match
+	driver->receive(CANErrorCountPacket(Network::NetID::MSCAN, 7, 5, true));
+	EXPECT_TRUE(waitFor([&] { return com->getReceivedPacketCount() == 2 && received == 1; }));
+}
@@ -0,0 +1,151 @@
+#include "icsneo/communication/decoder.h"
+#include "icsneo/communication/message/main51message.h"
+#include "icsneo/communication/message/serialnumbermessage.h"
+#include "icsneo/device/device.h"
+#include "gtest/gtest.h"
+
+using namespace icsneo;
+
+class DecoderTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		decoder.emplace([](APIEvent::Type, APIEvent::Severity) {
+			// Unless caught by the test, the decoder should not throw errors
+			EXPECT_TRUE(false);
+		});
+	}
+
+	static std::shared_ptr<Packet> MakePacket(Network::NetID netid, std::vector<uint8_t> data) {
+		auto packet = std::make_shared<Packet>();
+		packet->network = netid;
+		packet->data = std::move(data);
+		return packet;
+	}
+
+	optional<Decoder> decoder;
+};
+
+TEST_F(DecoderTest, CAN)
+{
+	std::vector<uint8_t> data(24);
+	data[4] = 2; // DLC
+	data[6] = 0xAB;
+	data[7] = 0xCD;
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::MSCAN, data)));
+	ASSERT_EQ(msg->type, Message::Type::Frame);
+	const auto can = std::dynamic_pointer_cast<CANMessage>(msg);
+	ASSERT_NE(can, nullptr);
+	EXPECT_EQ(can->network, Network::NetID::MSCAN);
+	EXPECT_EQ(can->data, std::vector<uint8_t>({ 0xAB, 0xCD }));
+}
+
+TEST_F(DecoderTest, Main51Commands)
+{
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::Main51, { uint8_t(Command::RequestSerialNumber), 0x40, 0xE2, 0x01, 0, 0, 0, 0, 0 })));
+	const auto serial = std::dynamic_pointer_cast<SerialNumberMessage>(msg);
+	ASSERT_NE(serial, nullptr);
+	EXPECT_EQ(serial->deviceSerial, Device::SerialNumToString(123456));
+
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::Main51, { uint8_t(Command::EnableNetworkCommunication), 1 })));
+	const auto main51 = std::dynamic_pointer_cast<Main51Message>(msg);
+	ASSERT_NE(main51, nullptr);
+	EXPECT_EQ(main51->command, Command::EnableNetworkCommunication);
+	EXPECT_EQ(main51->data, std::vector<uint8_t>({ 1 }));
+}
+
+TEST_F(DecoderTest, UnknownNetIDIsRaw)
+{
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::Invalid, { 1, 2, 3 })));
+	EXPECT_EQ(msg->type, Message::Type::RawMessage);
+	EXPECT_EQ(std::static_pointer_cast<RawMessage>(msg)->data, std::vector<uint8_t>({ 1, 2, 3 }));
+}
+
+TEST_F(DecoderTest, OverrideNetID)
+{
+	decoder->setDecodeFunction(Network::NetID::MSCAN, [](Decoder&, std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+		result = std::make_shared<RawMessage>(packet->network, std::vector<uint8_t>({ 0x42 }));
+		return true;
+	});
+
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::MSCAN, std::vector<uint8_t>(24))));
+	EXPECT_EQ(msg->type, Message::Type::RawMessage);
+	EXPECT_EQ(std::static_pointer_cast<RawMessage>(msg)->data, std::vector<uint8_t>({ 0x42 }));
+
+	// Other networks of the same type are unaffected
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::HSCAN, std::vector<uint8_t>(24))));
+	EXPECT_EQ(msg->type, Message::Type::Frame);
+
+	// Restore the default
+	decoder->setDecodeFunction(Network::NetID::MSCAN, nullptr);
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::MSCAN, std::vector<uint8_t>(24))));
+	EXPECT_EQ(msg->type, Message::Type::Frame);
+}
+
+TEST_F(DecoderTest, OverrideFallsBackToDefault)
+{
+	size_t calls = 0;
+	decoder->setDecodeFunction(Network::NetID::HSCAN, [&calls](Decoder& d, std::shared_ptr<Message>& result, const std::shared_ptr<Packet>& packet) {
+		calls++;
+		return d.decodeDefault(result, packet);
+	});
+
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::HSCAN, std::vector<uint8_t>(24))));
+	EXPECT_EQ(msg->type, Message::Type::Frame);
+	EXPECT_EQ(calls, 1u);
+}
+
+TEST_F(DecoderTest, OverrideUnknownNetID)
+{
+	const auto custom = Network::NetID(0x1234);
+	decoder->setDecodeFunction(custom, [](Decoder&, std::shared_ptr<Message>& result, const std::shared_ptr<Packet>&) {
+		result = std::make_shared<Main51Message>();
+		return true;
+	});
+
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(custom, {})));
+	EXPECT_EQ(msg->type, Message::Type::Main51);
+}
+
+TEST_F(DecoderTest, OverrideMain51Command)
+{
+	decoder->setDecodeFunction(Command::EnableNetworkCommunication, [](Decoder&, std::shared_ptr<Message>&, const std::shared_ptr<Packet>&) {
+		return false; // Swallow it
+	});
+
+	std::shared_ptr<Message> msg;
+	EXPECT_FALSE(decoder->decode(msg, MakePacket(Network::NetID::Main51, { uint8_t(Command::EnableNetworkCommunication), 1 })));
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::Main51, { uint8_t(Command::RequestStatusUpdate) })));
+	EXPECT_EQ(msg->type, Message::Type::Main51);
+
+	decoder->setDecodeFunction(Command::EnableNetworkCommunication, nullptr);
+	EXPECT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::Main51, { uint8_t(Command::EnableNetworkCommunication), 1 })));
+}
+
+TEST_F(DecoderTest, OldFormat)
+{
+	// Packets which did not come through the Packetizer are still unwrapped by the decoder
+	std::vector<uint8_t> data = { 24, 0, 0xF0 | uint8_t(Network::NetID::SWCAN) };
+	data.resize(3 + 24);
+	data[3 + 4] = 1; // DLC
+	data[3 + 6] = 0x99;
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder->decode(msg, MakePacket(Network::NetID::RED_OLDFORMAT, data)));
+	const auto can = std::dynamic_pointer_cast<CANMessage>(msg);
+	ASSERT_NE(can, nullptr);
+	EXPECT_EQ(can->network, Network::NetID::SWCAN);
+	EXPECT_EQ(can->data, std::vector<uint8_t>({ 0x99 }));
+
+	size_t errors = 0;
+	decoder->report = [&errors](APIEvent::Type t, APIEvent::Severity) {
+		EXPECT_EQ(t, APIEvent::Type::PacketDecodingError);
+		errors++;
+	};
+	EXPECT_FALSE(decoder->decode(msg, MakePacket(Network::NetID::RED_OLDFORMAT, { 1, 0 })));
+	EXPECT_EQ(errors, 1u);
+}
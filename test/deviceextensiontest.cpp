@@ -0,0 +1,126 @@
+#include "icsneo/device/device.h"
+#include "icsneo/device/extensions/deviceextension.h"
+#include "icsneo/communication/message/canmessage.h"
+#include "icsneo/communication/message/flexray/flexraymessage.h"
+#include "gtest/gtest.h"
+
+using namespace icsneo;
+
+class DeviceExtensionTest : public ::testing::Test {
+protected:
+	class NullDriver : public Driver {
+	public:
+		NullDriver(const device_eventhandler_t& report) : Driver(report) {}
+		bool open() override { return false; }
+		bool isOpen() override { return false; }
+		bool close() override { return true; }
+	private:
+		void readTask() override {}
+		void writeTask() override {}
+	};
+
+	class TestDevice : public Device {
+	public:
+		TestDevice() : Device(neodevice_t()) {
+			initialize([](device_eventhandler_t report, neodevice_t&) {
+				return std::unique_ptr<Driver>(new NullDriver(report));
+			});
+		}
+		using Device::addExtension;
+		using Device::handleInternalMessage;
+	};
+
+	class RecordingExtension : public DeviceExtension {
+	public:
+		RecordingExtension(Device& device, HookFilter messages, HookFilter transmits)
+			: DeviceExtension(device), messageFilter(messages), transmitFilter(transmits) {}
+		const char* getName() const override { return "Recording"; }
+		HookFilter getMessageHookFilter() const override { return messageFilter; }
+		HookFilter getTransmitHookFilter() const override { return transmitFilter; }
+		void handleMessage(const std::shared_ptr<Message>& message) override { handled.push_back(message); }
+
+		std::vector<std::shared_ptr<Message>> handled;
+
+	private:
+		const HookFilter messageFilter;
+		const HookFilter transmitFilter;
+	};
+
+	static std::shared_ptr<CANMessage> MakeCAN() {
+		auto msg = std::make_shared<CANMessage>();
+		msg->network = Network::NetID::HSCAN;
+		return msg;
+	}
+
+	static std::shared_ptr<FlexRayMessage> MakeFlexRay() {
+		auto msg = std::make_shared<FlexRayMessage>();
+		msg->network = Network::NetID::FlexRay;
+		return msg;
+	}
+
+	TestDevice device;
+};
+
+TEST_F(DeviceExtensionTest, HookFilterMatch)
+{
+	using HookFilter = DeviceExtension::HookFilter;
+	EXPECT_TRUE(HookFilter::None().empty());
+	EXPECT_FALSE(HookFilter::All().empty());
+	EXPECT_TRUE(HookFilter::All().match(*MakeCAN()));
+	EXPECT_FALSE(HookFilter::None().match(*MakeCAN()));
+
+	const auto flexray = HookFilter().add(Network::Type::FlexRay);
+	EXPECT_FALSE(flexray.empty());
+	EXPECT_TRUE(flexray.match(*MakeFlexRay()));
+	EXPECT_FALSE(flexray.match(*MakeCAN()));
+	EXPECT_FALSE(flexray.match(Message(Message::Type::FlexRayControl)));
+
+	const auto control = HookFilter().add(Message::Type::FlexRayControl);
+	EXPECT_TRUE(control.match(Message(Message::Type::FlexRayControl)));
+	EXPECT_FALSE(control.match(*MakeFlexRay()));
+
+	// Which frame traffic needs to be decoded for the hooks
+	EXPECT_TRUE(HookFilter::All().mayMatchNetwork(Network::Type::CAN));
+	EXPECT_FALSE(HookFilter::None().mayMatchNetwork(Network::Type::CAN));
+	EXPECT_TRUE(flexray.mayMatchNetwork(Network::Type::FlexRay));
+	EXPECT_FALSE(flexray.mayMatchNetwork(Network::Type::CAN));
+	EXPECT_FALSE(control.mayMatchNetwork(Network::Type::FlexRay));
+	EXPECT_TRUE(HookFilter().add(Message::Type::Frame).mayMatchNetwork(Network::Type::Ethernet));
+	EXPECT_TRUE(HookFilter().add(Message::Type::CANErrorCount).mayMatchNetwork(Network::Type::CAN));
+	EXPECT_FALSE(HookFilter().add(Message::Type::CANErrorCount).mayMatchNetwork(Network::Type::Ethernet));
+}
+
+TEST_F(DeviceExtensionTest, MessageHookOnlyForDeclaredMessages)
+{
+	using HookFilter = DeviceExtension::HookFilter;
+	auto everything = std::make_shared<RecordingExtension>(device, HookFilter::All(), HookFilter::All());
+	auto flexray = std::make_shared<RecordingExtension>(device, HookFilter().add(Network::Type::FlexRay), HookFilter::All());
+	auto nothing = std::make_shared<RecordingExtension>(device, HookFilter::None(), HookFilter::All());
+	device.addExtension(everything);
+	device.addExtension(flexray);
+	device.addExtension(nothing);
+
+	device.handleInternalMessage(MakeCAN());
+	device.handleInternalMessage(MakeFlexRay());
+	device.handleInternalMessage(std::make_shared<Message>(Message::Type::FlexRayControl));
+
+	EXPECT_EQ(everything->handled.size(), 3u);
+	ASSERT_EQ(flexray->handled.size(), 1u);
+	EXPECT_EQ(flexray->handled[0]->type, Message::Type::Frame);
+	EXPECT_EQ(nothing->handled.size(), 0u);
+}
+
+TEST_F(DeviceExtensionTest, ExtensionsAddedLaterAreHooked)
+{
+	using HookFilter = DeviceExtension::HookFilter;
+	auto first = std::make_shared<RecordingExtension>(device, HookFilter::All(), HookFilter::None());
+	device.addExtension(first);
+	device.handleInternalMessage(MakeCAN());
+
+	auto second = std::make_shared<RecordingExtension>(device, HookFilter::All(), HookFilter::None());
+	device.addExtension(second);
+	device.handleInternalMessage(MakeCAN());
+
+	EXPECT_EQ(first->handled.size(), 2u);
+	EXPECT_EQ(second->handled.size(), 1u);
+}
@@ -61,4 +61,191 @@ TEST_F(DiskDriverTest, ReadBadStartingPos) {
 	const auto amountRead = readLogicalDisk(2000, buf.data(), buf.size());
 	EXPECT_FALSE(amountRead.has_value());
 	EXPECT_EQ(driver->readCalls, 1u); // One to check EOF
-}
\ No newline at end of file
+}
+
+TEST_F(DiskDriverTest, ReadPipelined) {
+	driver->pipelined = true;
+	std::array<uint8_t, 500> buf;
+	buf.fill(0u);
+	const auto amountRead = readLogicalDisk(300, buf.data(), buf.size());
+	EXPECT_EQ(amountRead, buf.size());
+	EXPECT_EQ(buf[0], 300 & 0xFF);
+	EXPECT_EQ(buf[110], 410 & 0xFF);
+	EXPECT_EQ(buf[499], 799 & 0xFF);
+	EXPECT_EQ(driver->readCalls, 3u);
+	EXPECT_TRUE(driver->pendingReads.empty());
+}
+
+TEST_F(DiskDriverTest, ReadPipelinedOutOfOrder) {
+	driver->pipelined = true;
+	driver->completeOutOfOrder = true;
+	driver->readLatency = std::chrono::milliseconds(1);
+	std::array<uint8_t, 1024> buf;
+	buf.fill(0u);
+	const auto amountRead = readLogicalDisk(0, buf.data(), buf.size());
+	EXPECT_EQ(amountRead, buf.size());
+	EXPECT_EQ(memcmp(buf.data(), driver->mockDisk.data(), buf.size()), 0);
+}
+
+TEST_F(DiskDriverTest, ReadPipelinedKeepsReadsInFlight) {
+	std::array<uint8_t, 1024> buf;
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->maxPendingReads, 0u); // Serial reads never use the pipeline
+
+	driver->pipelined = true;
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->readCalls, 8u);
+	EXPECT_EQ(driver->maxPendingReads, 4u); // Four blocks, all in flight at once
+
+	driver->maxOutstandingReads = 2;
+	driver->maxPendingReads = 0;
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->maxPendingReads, 2u);
+}
+
+TEST_F(DiskDriverTest, ReadPipelinedRecoversFromLostRead) {
+	driver->pipelined = true;
+	driver->lostReadPos = 256;
+	std::array<uint8_t, 1024> buf;
+	buf.fill(0u);
+
+	// The device never answers for the second block, so the read gives up there
+	expectedErrors.push({ APIEvent::Type::Timeout, APIEvent::Severity::Error });
+	EXPECT_EQ(driver->readLogicalDisk(*com, onError, 0, buf.data(), buf.size(), std::chrono::milliseconds(20)), 256u);
+	EXPECT_EQ(driver->cancelCalls, 1u);
+	EXPECT_TRUE(driver->pendingReads.empty());
+
+	// Nothing is left waiting on the lost read, so the next read asks for the block again
+	buf.fill(0u);
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(memcmp(buf.data(), driver->mockDisk.data(), buf.size()), 0);
+	EXPECT_TRUE(driver->pendingReads.empty());
+}
+
+TEST_F(DiskDriverTest, ReadPipelinedReadahead) {
+	driver->pipelined = true;
+	driver->readaheadBlocks = 1;
+	std::array<uint8_t, 256> buf;
+
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->readCalls, 1u); // Not yet streaming, so nothing is read ahead
+
+	// Reading on from where we left off reads ahead
+	EXPECT_EQ(readLogicalDisk(256, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(buf[0], 256 & 0xFF);
+	EXPECT_EQ(driver->readCalls, 3u);
+
+	// Which is then served without asking the device again, other than to keep reading ahead
+	EXPECT_EQ(readLogicalDisk(512, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(buf[0], 512 & 0xFF);
+	EXPECT_EQ(buf[255], 767 & 0xFF);
+	EXPECT_EQ(driver->readCalls, 4u);
+
+	// Anything read ahead is thrown away when the disk may have changed underneath it
+	driver->mockDisk[768] = 0xAB;
+	driver->discardReadahead();
+	EXPECT_EQ(readLogicalDisk(768, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(buf[0], 0xAB);
+	EXPECT_EQ(buf[1], 769 & 0xFF);
+}
+
+TEST_F(DiskDriverTest, WriteDiscardsReadahead) {
+	driver->pipelined = true;
+	std::array<uint8_t, 256> buf;
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(readLogicalDisk(256, buf.data(), buf.size()), buf.size());
+
+	const uint8_t data[] = { 1, 2, 3, 4 };
+	EXPECT_EQ(writeLogicalDisk(512, data, sizeof(data)), sizeof(data));
+	EXPECT_EQ(readLogicalDisk(512, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(memcmp(buf.data(), data, sizeof(data)), 0);
+	EXPECT_EQ(buf[4], 516 & 0xFF);
+}
+
+TEST_F(DiskDriverTest, ReadCached) {
+	driver->cacheMaxBytes = 1024;
+	std::array<uint8_t, 100> buf;
+
+	// Repeatedly reading the same area only reaches the disk once
+	for(int i = 0; i < 5; i++) {
+		buf.fill(0u);
+		EXPECT_EQ(readLogicalDisk(10, buf.data(), buf.size()), buf.size());
+		EXPECT_EQ(buf[0], TEST_STRING[10]);
+		EXPECT_EQ(buf[99], 109u);
+	}
+	EXPECT_EQ(driver->readCalls, 1u);
+
+	auto stats = driver->getCacheStats();
+	EXPECT_EQ(stats.misses, 1u);
+	EXPECT_EQ(stats.hits, 4u);
+	EXPECT_EQ(stats.cachedBlocks, 1u);
+	EXPECT_EQ(stats.cachedBytes, 256u);
+
+	// Blocks which have been around too long are read again
+	driver->cacheLifetime = std::chrono::milliseconds::zero();
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	EXPECT_EQ(readLogicalDisk(10, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->readCalls, 2u);
+}
+
+TEST_F(DiskDriverTest, ReadCacheEvictsLeastRecentlyUsed) {
+	driver->cacheMaxBytes = 512; // Two blocks
+	std::array<uint8_t, 16> buf;
+
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(readLogicalDisk(256, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size()); // Block 0 is now the most recently used
+	EXPECT_EQ(readLogicalDisk(512, buf.data(), buf.size()), buf.size()); // Evicts block 1
+	EXPECT_EQ(driver->readCalls, 3u);
+
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->readCalls, 3u);
+	EXPECT_EQ(readLogicalDisk(256, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->readCalls, 4u);
+
+	const auto stats = driver->getCacheStats();
+	EXPECT_EQ(stats.evictions, 2u);
+	EXPECT_EQ(stats.cachedBlocks, 2u);
+	EXPECT_LE(stats.cachedBytes, driver->cacheMaxBytes);
+}
+
+TEST_F(DiskDriverTest, ReadCacheSkipsBulkReads) {
+	driver->cacheMaxBytes = 1024;
+	driver->cacheMaxReadSize = 256;
+	std::array<uint8_t, 512> buf;
+
+	// Large reads are not cached
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->getCacheStats().cachedBlocks, 0u);
+	EXPECT_EQ(readLogicalDisk(0, buf.data(), 16), 16u);
+	EXPECT_EQ(driver->readCalls, 3u);
+	EXPECT_EQ(driver->getCacheStats().cachedBlocks, 1u);
+
+	// Nor are small ones while streaming
+	driver->pipelined = true;
+	driver->readaheadBlocks = 0;
+	EXPECT_EQ(readLogicalDisk(512, buf.data(), 256), 256u);
+	EXPECT_EQ(readLogicalDisk(768, buf.data(), 256), 256u);
+	EXPECT_EQ(driver->getCacheStats().cachedBlocks, 2u); // Block 0, and block 2 as it was not yet streaming
+	EXPECT_EQ(readLogicalDisk(768, buf.data(), 16), 16u);
+	EXPECT_EQ(driver->readCalls, 6u);
+}
+
+TEST_F(DiskDriverTest, WriteInvalidatesCache) {
+	driver->cacheMaxBytes = 1024;
+	std::array<uint8_t, 16> buf;
+	EXPECT_EQ(readLogicalDisk(300, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(readLogicalDisk(600, buf.data(), buf.size()), buf.size());
+
+	EXPECT_EQ(writeLogicalDisk(300, reinterpret_cast<const uint8_t*>(TEST_OVERWRITE_STRING), sizeof(TEST_OVERWRITE_STRING)),
+		sizeof(TEST_OVERWRITE_STRING));
+	const auto readsAfterWrite = driver->readCalls;
+
+	EXPECT_EQ(readLogicalDisk(300, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(memcmp(buf.data(), TEST_OVERWRITE_STRING, sizeof(TEST_OVERWRITE_STRING)), 0);
+	EXPECT_EQ(driver->readCalls, readsAfterWrite + 1);
+
+	// Blocks the write did not touch are still cached
+	EXPECT_EQ(readLogicalDisk(600, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->readCalls, readsAfterWrite + 1);
+}
@@ -7,6 +7,9 @@
 #include "gtest/gtest.h"
 #include <queue>
 #include <functional>
+#include <thread>
+#include <deque>
+#include <limits>
 
 using namespace icsneo;
 
@@ -15,12 +18,67 @@ using namespace icsneo;
 
 class MockDiskDriver : public Disk::ReadDriver, public Disk::WriteDriver {
 public:
-	std::pair<uint32_t, uint32_t> getBlockSizeBounds() const override { return { 8, 256 }; }
+	MockDiskDriver() {
+		cacheMaxBytes = 0; // Most tests count the reads which reach the disk, the cache tests turn it on
+	}
+
+	std::pair<uint32_t, uint32_t> getBlockSizeBounds() const override { return blockSizeBounds; }
 
 	optional<uint64_t> readLogicalDiskAligned(Communication&, device_eventhandler_t,
 		uint64_t pos, uint8_t* into, uint64_t amount, std::chrono::milliseconds) override {
 		readCalls++;
+		std::this_thread::sleep_for(readLatency);
+		return completeRead(pos, into, amount);
+	}
+
+	bool supportsPipelinedReads() const override { return pipelined; }
+
+	bool beginReadLogicalDiskAligned(Communication&, device_eventhandler_t,
+		uint64_t pos, uint8_t* into, uint64_t amount) override {
+		readCalls++;
+		auto latency = readLatency;
+		if(pos == lostReadPos) {
+			lostReadPos = std::numeric_limits<uint64_t>::max(); // Only lost once
+			pendingReads.push_back({ pos, nullopt, std::chrono::steady_clock::time_point::max() });
+			maxPendingReads = std::max(maxPendingReads, pendingReads.size());
+			return true;
+		}
+		if(completeOutOfOrder && (pendingReads.size() % 2 == 0))
+			latency *= 2; // Every other request takes longer, so later ones overtake it
+		// The data is captured now, as the device would, and only reported once the latency has passed
+		pendingReads.push_back({ pos, completeRead(pos, into, amount), std::chrono::steady_clock::now() + latency });
+		maxPendingReads = std::max(maxPendingReads, pendingReads.size());
+		return true;
+	}
+
+	bool finishReadLogicalDiskAligned(Communication&, uint64_t& pos, optional<uint64_t>& result,
+		std::chrono::milliseconds timeout) override {
+		if(pendingReads.empty())
+			return false;
 
+		auto next = pendingReads.begin();
+		for(auto it = pendingReads.begin(); it != pendingReads.end(); it++) {
+			if(it->readyAt < next->readyAt)
+				next = it;
+		}
+		if(next->readyAt > std::chrono::steady_clock::now() + timeout) {
+			std::this_thread::sleep_for(timeout);
+			return false;
+		}
+
+		std::this_thread::sleep_until(next->readyAt);
+		pos = next->pos;
+		result = next->result;
+		pendingReads.erase(next);
+		return true;
+	}
+
+	void cancelPipelinedReads(Communication&) override {
+		pendingReads.clear();
+		cancelCalls++;
+	}
+
+	optional<uint64_t> completeRead(uint64_t pos, uint8_t* into, uint64_t amount) {
 		EXPECT_EQ(pos % getBlockSizeBounds().first, 0); // Ensure the alignment rules are respected
 		EXPECT_LE(amount, getBlockSizeBounds().second);
 		EXPECT_EQ(amount % getBlockSizeBounds().first, 0);
@@ -68,12 +126,28 @@ public:
 	}
 
 	std::array<uint8_t, 1024> mockDisk;
+	std::pair<uint32_t, uint32_t> blockSizeBounds = { 8, 256 };
 	size_t readCalls = 0;
 	size_t writeCalls = 0;
 	size_t atomicityChecks = 0;
 	bool supportsAtomic = true; // Ability to simulate a driver that doesn't support atomic writes
 	std::function<void(void)> afterReadHook;
 
+	// Simulated device latency, reads in pipelined mode overlap each other
+	std::chrono::microseconds readLatency{0};
+	bool pipelined = false;
+	bool completeOutOfOrder = false;
+
+	struct PendingRead {
+		uint64_t pos;
+		optional<uint64_t> result;
+		std::chrono::steady_clock::time_point readyAt;
+	};
+	std::deque<PendingRead> pendingReads;
+	size_t maxPendingReads = 0; // The most reads that were ever in flight at once
+	uint64_t lostReadPos = std::numeric_limits<uint64_t>::max(); // The device never answers a read from here
+	size_t cancelCalls = 0;
+
 private:
 	Disk::Access getPossibleAccess() const override { return Disk::Access::EntireCard; }
 };
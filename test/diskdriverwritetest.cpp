@@ -57,29 +57,31 @@ TEST_F(DiskDriverTest, WriteUnalignedLong) {
 	EXPECT_TRUE(amountWritten.has_value());
 	EXPECT_EQ(amountWritten, buf.size());
 	EXPECT_EQ(driver->mockDisk[0], TEST_STRING[0]);
+	EXPECT_EQ(driver->mockDisk[295], 295 & 0xFF);
 	EXPECT_EQ(driver->mockDisk[330], ((buf.size() - 30) + 20) & 0xFF);
-	EXPECT_EQ(driver->atomicityChecks, 3u);
-	EXPECT_EQ(driver->readCalls, 3u);
+	EXPECT_EQ(driver->mockDisk[799], ((buf.size() - 499) + 20) & 0xFF);
+	EXPECT_EQ(driver->mockDisk[800], 800 & 0xFF);
+	// Only the partial sector at the start needs a read, the write ends on a sector boundary
+	EXPECT_EQ(driver->atomicityChecks, 1u);
+	EXPECT_EQ(driver->readCalls, 1u);
 	EXPECT_EQ(driver->writeCalls, 3u);
 }
 
 TEST_F(DiskDriverTest, WriteUnalignedLongAtomicityFailures) {
-	std::array<uint8_t, 500> buf;
+	std::array<uint8_t, 490> buf;
 	for(size_t i = 0; i < buf.size(); i++)
 		buf[i] = static_cast<uint8_t>((buf.size() - i) + 20);
-	for(int i = 0; i < 4; i++)
+	for(int i = 0; i < 3; i++)
 		expectedErrors.push({ APIEvent::Type::AtomicOperationRetried, APIEvent::Severity::EventInfo });
 
 	int i = 0;
 	driver->afterReadHook = [&i, this]() {
 		switch(i) {
-		case 0: driver->mockDisk[295] = uint8_t(0xCD); break;
-		case 1: break; // We don't mess with this one so the first block can be written
-		case 2: driver->mockDisk[600] = uint8_t(0xDC); break;
-		case 3: driver->mockDisk[602] = uint8_t(0xDC); break;
-		case 4: break; // We don't mess with this one so the second block can be written
-		case 5: driver->mockDisk[777] = uint8_t(0x22); break;
-		case 6: break; // We don't mess with this one so the third block can be written
+		case 0: driver->mockDisk[298] = uint8_t(0xCD); break;
+		case 1: break; // We don't mess with this one so the first chunk can be written
+		case 2: driver->mockDisk[791] = uint8_t(0xDC); break;
+		case 3: driver->mockDisk[790] = uint8_t(0xDC); break;
+		case 4: break; // We don't mess with this one so the last chunk can be written
 		}
 		i++;
 	};
@@ -88,14 +90,53 @@ TEST_F(DiskDriverTest, WriteUnalignedLongAtomicityFailures) {
 	EXPECT_TRUE(amountWritten.has_value());
 	EXPECT_EQ(amountWritten, buf.size());
 	EXPECT_EQ(driver->mockDisk[0], TEST_STRING[0]);
-	EXPECT_EQ(driver->mockDisk[295], 0xCDu); // If the atomic worked correctly this write won't have gotten trampled
-	// Our writes happen after both of these, so they overwrite the 0xDC values
+	// If the atomic worked correctly these writes won't have gotten trampled
+	EXPECT_EQ(driver->mockDisk[298], 0xCDu);
+	EXPECT_EQ(driver->mockDisk[790], 0xDCu);
+	EXPECT_EQ(driver->mockDisk[791], 0xDCu);
 	EXPECT_EQ(driver->mockDisk[600], ((buf.size() - 300) + 20) & 0xFF);
-	EXPECT_EQ(driver->mockDisk[602], ((buf.size() - 302) + 20) & 0xFF);
+	EXPECT_EQ(driver->mockDisk[789], ((buf.size() - 489) + 20) & 0xFF);
 
-	EXPECT_EQ(driver->atomicityChecks, 7u);
-	EXPECT_EQ(driver->readCalls, 7u);
-	EXPECT_EQ(driver->writeCalls, 7u);
+	// The whole sectors in between are written once, without being read
+	EXPECT_EQ(driver->atomicityChecks, 5u);
+	EXPECT_EQ(driver->readCalls, 5u);
+	EXPECT_EQ(driver->writeCalls, 6u);
+}
+
+TEST_F(DiskDriverTest, WriteAlignedSkipsRead) {
+	std::array<uint8_t, 512> buf;
+	for(size_t i = 0; i < buf.size(); i++)
+		buf[i] = static_cast<uint8_t>(i + 7);
+	const auto amountWritten = writeLogicalDisk(256, buf.data(), buf.size());
+	EXPECT_EQ(amountWritten, buf.size());
+	EXPECT_EQ(driver->mockDisk[255], 255u);
+	EXPECT_EQ(driver->mockDisk[256], 7u);
+	EXPECT_EQ(driver->mockDisk[767], (511 + 7) & 0xFF);
+	EXPECT_EQ(driver->mockDisk[768], 768 & 0xFF);
+	EXPECT_EQ(driver->atomicityChecks, 0u);
+	EXPECT_EQ(driver->readCalls, 0u);
+	EXPECT_EQ(driver->writeCalls, 2u);
+}
+
+TEST_F(DiskDriverTest, WriteAlignedSectorsBatched) {
+	// Several whole sectors, not aligned to a block, still go out as one write
+	std::array<uint8_t, 64> buf;
+	buf.fill(0xEE);
+	const auto amountWritten = writeLogicalDisk(16, buf.data(), buf.size());
+	EXPECT_EQ(amountWritten, buf.size());
+	EXPECT_EQ(driver->mockDisk[15], TEST_STRING[15]);
+	EXPECT_EQ(driver->mockDisk[16], 0xEEu);
+	EXPECT_EQ(driver->mockDisk[79], 0xEEu);
+	EXPECT_EQ(driver->mockDisk[80], 80u);
+	EXPECT_EQ(driver->readCalls, 0u);
+	EXPECT_EQ(driver->writeCalls, 1u);
+
+	// Without the driver supporting larger writes, each sector is its own write
+	driver->blockSizeBounds.second = 8;
+	driver->writeCalls = 0;
+	EXPECT_EQ(writeLogicalDisk(16, buf.data(), buf.size()), buf.size());
+	EXPECT_EQ(driver->readCalls, 0u);
+	EXPECT_EQ(driver->writeCalls, 8u);
 }
 
 TEST_F(DiskDriverTest, WritePastEnd) {
@@ -117,4 +158,23 @@ TEST_F(DiskDriverTest, WriteBadStartingPos) {
 	EXPECT_EQ(driver->atomicityChecks, 0u);
 	EXPECT_EQ(driver->readCalls, 1u);
 	EXPECT_EQ(driver->writeCalls, 0u); // We never even attempt the write
-}
\ No newline at end of file
+}
+TEST_F(DiskDriverTest, WriteAtomicityFailuresBypassCache) {
+	driver->cacheMaxBytes = 1024;
+	std::array<uint8_t, 16> buf;
+	EXPECT_EQ(readLogicalDisk(256, buf.data(), buf.size()), buf.size()); // The block is now cached
+	expectedErrors.push({ APIEvent::Type::AtomicOperationRetried, APIEvent::Severity::EventInfo });
+
+	int i = 0;
+	driver->afterReadHook = [&i, this]() {
+		if(i++ == 0) // Changed after the write reads it, so the write must be retried from a fresh read
+			driver->mockDisk[298] = uint8_t(0xCD);
+	};
+
+	const uint8_t data[] = { 1, 2, 3, 4 };
+	EXPECT_EQ(writeLogicalDisk(300, data, sizeof(data)), sizeof(data));
+	EXPECT_EQ(driver->mockDisk[298], 0xCDu);
+	EXPECT_EQ(driver->mockDisk[300], 1u);
+	EXPECT_EQ(driver->readCalls, 3u);
+	EXPECT_EQ(driver->writeCalls, 2u);
+}
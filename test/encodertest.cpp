@@ -0,0 +1,343 @@
+#include "icsneo/communication/encoder.h"
+#include "icsneo/communication/encodebuffer.h"
+#include "icsneo/communication/message/main51message.h"
+#include "icsneo/communication/message/ethernetmessage.h"
+#include "icsneo/communication/message/iso9141message.h"
+#include "icsneo/communication/message/linmessage.h"
+#include "icsneo/communication/packet/flexraypacket.h"
+#include "gtest/gtest.h"
+
+using namespace icsneo;
+
+class EncoderTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		onError = [](APIEvent::Type, APIEvent::Severity) {
+			// Unless caught by the test, the encoder should not throw errors
+			EXPECT_TRUE(false);
+		};
+		const device_eventhandler_t report = [this](APIEvent::Type t, APIEvent::Severity s) {
+			onError(t, s);
+		};
+		packetizer.emplace(report);
+		encoder.emplace(report);
+	}
+
+	// A prepared frame should always produce the same packet as encoding the frame normally
+	void expectPreparedMatches(const PreparedFrame& prepared, const std::shared_ptr<Frame>& frame) {
+		std::vector<uint8_t> bytes;
+		ASSERT_TRUE(encoder->encode(*packetizer, bytes, frame));
+		EXPECT_EQ(prepared.getPacket().toVector(), bytes);
+	}
+
+	optional<Packetizer> packetizer;
+	optional<Encoder> encoder;
+	device_eventhandler_t onError;
+};
+
+TEST_F(EncoderTest, EncodeBufferPrepend)
+{
+	EncodeBuffer buffer(4);
+	EXPECT_TRUE(buffer.empty());
+	buffer.append({ 3, 4 });
+	buffer.prepend({ 1, 2 });
+	buffer.push_back(5);
+	EXPECT_EQ(buffer.getOffset(), 2u);
+	EXPECT_EQ(buffer.toVector(), std::vector<uint8_t>({ 1, 2, 3, 4, 5 }));
+
+	// Prepending more than the remaining headroom still works
+	buffer.prepend({ 0xA, 0xB, 0xC });
+	EXPECT_EQ(buffer.toVector(), std::vector<uint8_t>({ 0xA, 0xB, 0xC, 1, 2, 3, 4, 5 }));
+	EXPECT_EQ(buffer.size(), 8u);
+	EXPECT_EQ(buffer[3], 1);
+
+	buffer.clear();
+	EXPECT_TRUE(buffer.empty());
+	EXPECT_EQ(buffer.getOffset(), EncodeBuffer::DefaultHeadroom);
+}
+
+TEST_F(EncoderTest, EncodeBufferPoolReuse)
+{
+	EncodeBufferPool pool;
+	const EncodeBuffer* first;
+	{
+		auto buffer = pool.acquire();
+		first = buffer.get();
+		buffer->append(std::vector<uint8_t>(100, 0xFF));
+	}
+	EXPECT_EQ(pool.getPooledCount(), 1u);
+	{
+		auto buffer = pool.acquire();
+		EXPECT_EQ(buffer.get(), first);
+		EXPECT_TRUE(buffer->empty()); // Cleared for reuse
+		EXPECT_EQ(pool.getPooledCount(), 0u);
+
+		auto another = pool.acquire();
+		EXPECT_NE(another.get(), first);
+	}
+	EXPECT_EQ(pool.getPooledCount(), 2u);
+
+	// Oversized buffers are not kept
+	{
+		auto buffer = pool.acquire();
+		buffer->append(std::vector<uint8_t>(EncodeBufferPool::MaxPooledCapacity + 1));
+	}
+	EXPECT_EQ(pool.getPooledCount(), 1u);
+}
+
+TEST_F(EncoderTest, CAN)
+{
+	auto msg = std::make_shared<CANMessage>();
+	msg->network = Network::NetID::HSCAN;
+	msg->arbid = 0x123;
+	msg->data = { 1, 2 };
+
+	const std::vector<uint8_t> expected = {
+		0xAA, // Packetizer
+		0x0C, 0x0F, 0x00, 0x01, 0x00, // Long format header, size and NetID
+		0x81, 0x00, 0x00, 0x24, 0x60, 0x02, 0x01, 0x02 // CAN packet
+	};
+
+	EncodeBuffer buffer;
+	ASSERT_TRUE(encoder->encode(*packetizer, buffer, msg));
+	EXPECT_EQ(buffer.toVector(), expected);
+
+	std::vector<uint8_t> bytes;
+	ASSERT_TRUE(encoder->encode(*packetizer, bytes, msg));
+	EXPECT_EQ(bytes, expected);
+}
+
+TEST_F(EncoderTest, ShortFormatCommand)
+{
+	const uint8_t header = (2 << 4) | uint8_t(Network::NetID::Main51);
+	const uint8_t command = uint8_t(Command::EnableNetworkCommunication);
+	const std::vector<uint8_t> expected = { 0xAA, header, command, 1, Packetizer::ICSChecksum({ header, command, 1 }), 'A' };
+
+	EncodeBuffer buffer;
+	ASSERT_TRUE(encoder->encode(*packetizer, buffer, Command::EnableNetworkCommunication, { 1 }));
+	EXPECT_EQ(buffer.toVector(), expected);
+}
+
+TEST_F(EncoderTest, MessageIsNotModified)
+{
+	auto msg = std::make_shared<Main51Message>();
+	msg->command = Command::RequestStatusUpdate;
+	msg->data = { 1, 2, 3 };
+
+	EncodeBuffer buffer;
+	ASSERT_TRUE(encoder->encode(*packetizer, buffer, msg));
+	ASSERT_TRUE(encoder->encode(*packetizer, buffer, msg)); // The buffer is cleared for each encode
+	EXPECT_EQ(msg->data, std::vector<uint8_t>({ 1, 2, 3 }));
+
+	const std::vector<uint8_t> expected = { 0xAA, 0x0B, 9, 0, uint8_t(Command::RequestStatusUpdate), 1, 2, 3 };
+	EXPECT_EQ(buffer.toVector(), expected);
+}
+
+TEST_F(EncoderTest, JumboEthernet)
+{
+	auto msg = std::make_shared<EthernetMessage>();
+	msg->network = Network::NetID::Ethernet;
+	msg->data.resize(9000, 0x5A);
+
+	EncodeBuffer buffer;
+	ASSERT_TRUE(encoder->encode(*packetizer, buffer, msg));
+	// Packetizer, long format header, then the padded size and description ahead of the frame
+	ASSERT_EQ(buffer.size(), 1 + 5 + 4 + 9000u);
+	EXPECT_EQ(buffer[0], 0xAA);
+	EXPECT_EQ(buffer[6], uint8_t(9000));
+	EXPECT_EQ(buffer[7], uint8_t(9000 >> 8));
+	EXPECT_EQ(buffer[10], 0x5A);
+
+	std::vector<uint8_t> bytes;
+	ASSERT_TRUE(encoder->encode(*packetizer, bytes, msg));
+	EXPECT_EQ(bytes, buffer.toVector());
+}
+
+TEST_F(EncoderTest, PreparedCAN)
+{
+	encoder->supportCANFD = true;
+	for(const bool extended : { false, true }) {
+		for(const bool fd : { false, true }) {
+			auto msg = std::make_shared<CANMessage>();
+			msg->network = Network::NetID::HSCAN2;
+			msg->arbid = extended ? 0x1ABCDEF : 0x7FF;
+			msg->isExtended = extended;
+			msg->isCANFD = fd;
+			msg->data = { 0, 1, 2, 3, 4, 5 }; // Padded to 8 bytes on the wire
+
+			const auto prepared = encoder->prepare(*packetizer, msg);
+			ASSERT_NE(prepared, nullptr);
+			EXPECT_EQ(prepared->getDataSize(), 6u);
+			expectPreparedMatches(*prepared, msg);
+
+			// Changing payload bytes gives the same packet as encoding the changed frame
+			EXPECT_TRUE(prepared->setData(0, 0x42));
+			const uint8_t counter[] = { 0xC0, 0xDE };
+			EXPECT_TRUE(prepared->setData(4, counter, sizeof(counter)));
+			EXPECT_EQ(prepared->getData(4), 0xC0);
+			msg->data = { 0x42, 1, 2, 3, 0xC0, 0xDE };
+			expectPreparedMatches(*prepared, msg);
+
+			// Out of range
+			EXPECT_FALSE(prepared->setData(6, 0));
+			EXPECT_FALSE(prepared->setData(5, counter, sizeof(counter)));
+			expectPreparedMatches(*prepared, msg);
+		}
+	}
+}
+
+TEST_F(EncoderTest, PreparedEthernet)
+{
+	for(const bool preemption : { false, true }) {
+		auto msg = std::make_shared<EthernetMessage>();
+		msg->network = Network::NetID::Ethernet;
+		msg->preemptionEnabled = preemption;
+		msg->data.resize(100, 0x11);
+
+		const auto prepared = encoder->prepare(*packetizer, msg);
+		ASSERT_NE(prepared, nullptr);
+		EXPECT_TRUE(prepared->setData(99, 0x22));
+		msg->data[99] = 0x22;
+		expectPreparedMatches(*prepared, msg);
+	}
+}
+
+TEST_F(EncoderTest, PreparedUnsupported)
+{
+	auto msg = std::make_shared<ISO9141Message>();
+	msg->network = Network::NetID::ISO9141;
+	size_t errors = 0;
+	onError = [&errors](APIEvent::Type t, APIEvent::Severity) {
+		EXPECT_EQ(t, APIEvent::Type::PreparedTransmitNotSupported);
+		errors++;
+	};
+	EXPECT_EQ(encoder->prepare(*packetizer, msg), nullptr);
+	EXPECT_EQ(errors, 1u);
+}
+
+TEST_F(EncoderTest, FlexRayRoundTrip)
+{
+	FlexRayMessage msg;
+	msg.network = Network::NetID::FlexRay;
+	msg.channel = FlexRay::Channel::B;
+	msg.slotid = 0x2A;
+	msg.cycle = 3;
+	msg.sync = true;
+	msg.startup = true;
+	msg.payloadPreamble = true;
+	msg.data = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+	std::vector<uint8_t> bytes;
+	ASSERT_TRUE(HardwareFlexRayPacket::EncodeFromMessage(msg, bytes, onError));
+	ASSERT_EQ(bytes.size(), sizeof(HardwareFlexRayPacket) - 4 + msg.data.size());
+	const auto& packet = *reinterpret_cast<const HardwareFlexRayPacket*>(bytes.data());
+	EXPECT_EQ(packet.txmsg, 1);
+	EXPECT_EQ(packet.extra, 0);
+
+	const auto decoded = HardwareFlexRayPacket::DecodeToMessage(bytes);
+	ASSERT_NE(decoded, nullptr);
+	EXPECT_EQ(decoded->slotid, 0x2A);
+	EXPECT_EQ(decoded->cycle, 3);
+	EXPECT_EQ(decoded->channel, FlexRay::Channel::B);
+	EXPECT_TRUE(decoded->sync);
+	EXPECT_TRUE(decoded->startup);
+	EXPECT_TRUE(decoded->payloadPreamble);
+	EXPECT_FALSE(decoded->nullFrame);
+	EXPECT_FALSE(decoded->dynamic);
+	EXPECT_EQ(decoded->headerCRCStatus, FlexRay::CRCStatus::OK);
+	EXPECT_EQ(decoded->headerCRC, 0x624);
+	EXPECT_EQ(decoded->data, msg.data);
+
+	// Dynamic segment frames, odd payloads are padded to a whole word
+	msg.channel = FlexRay::Channel::A;
+	msg.dynamic = true;
+	msg.sync = msg.startup = false;
+	msg.slotid = 0x400;
+	msg.data = { 0xAB, 0xCD, 0xEF };
+	bytes.clear();
+	ASSERT_TRUE(HardwareFlexRayPacket::EncodeFromMessage(msg, bytes, onError));
+	const auto dynamic = HardwareFlexRayPacket::DecodeToMessage(bytes);
+	ASSERT_NE(dynamic, nullptr);
+	EXPECT_TRUE(dynamic->dynamic);
+	EXPECT_EQ(dynamic->slotid, 0x400);
+	EXPECT_EQ(dynamic->channel, FlexRay::Channel::A);
+	EXPECT_EQ(dynamic->headerCRC, 0x4D2);
+	EXPECT_EQ(dynamic->data, std::vector<uint8_t>({ 0xAB, 0xCD, 0xEF, 0x00 }));
+}
+
+TEST_F(EncoderTest, FlexRayHeaderCRC)
+{
+	// Worked out from the specification's definition, the remainder of dividing the sync and startup
+	// indicators, frame ID, and payload length, with the initial vector 0x1A ahead of them, by
+	// x^11 + x^9 + x^8 + x^7 + x^2 + 1. The last two differ only in the order of the indicators.
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(false, false, 1, 0), 0x69F);
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(true, true, 1, 0), 0x1BC);
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(false, false, 0x2A, 5), 0x107);
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(true, true, 0x2A, 5), 0x624);
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(false, false, 0x400, 2), 0x4D2);
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(false, false, 0x7FF, 127), 0x135);
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(true, false, 0x2A, 5), 0x4C5);
+	EXPECT_EQ(FlexRayMessage::CalcHeaderCRC(false, true, 0x2A, 5), 0x3E6);
+}
+
+TEST_F(EncoderTest, FlexRay)
+{
+	auto msg = std::make_shared<FlexRayMessage>();
+	msg->network = Network::NetID::FlexRay;
+	msg->channel = FlexRay::Channel::A;
+	msg->slotid = 5;
+	msg->data = { 1, 2, 3, 4 };
+
+	std::vector<uint8_t> record;
+	ASSERT_TRUE(HardwareFlexRayPacket::EncodeFromMessage(*msg, record, onError));
+
+	EncodeBuffer buffer;
+	ASSERT_TRUE(encoder->encode(*packetizer, buffer, msg));
+	ASSERT_EQ(buffer.size(), 1 + 5 + record.size());
+	EXPECT_EQ(buffer[1], 0x0C); // Long format
+	EXPECT_TRUE(std::equal(record.begin(), record.end(), buffer.begin() + 6));
+
+	size_t errors = 0;
+	onError = [&errors](APIEvent::Type t, APIEvent::Severity) {
+		EXPECT_EQ(t, APIEvent::Type::MessageFormattingError);
+		errors++;
+	};
+	msg->slotid = 0;
+	EXPECT_FALSE(encoder->encode(*packetizer, buffer, msg));
+	msg->slotid = 5;
+	msg->channel = FlexRay::Channel::None;
+	EXPECT_FALSE(encoder->encode(*packetizer, buffer, msg));
+	msg->channel = FlexRay::Channel::AB; // Needs the controller's message buffers
+	EXPECT_FALSE(encoder->encode(*packetizer, buffer, msg));
+	msg->channel = FlexRay::Channel::A;
+	msg->cycleRepetition = 4;
+	EXPECT_FALSE(encoder->encode(*packetizer, buffer, msg));
+	msg->cycleRepetition = 0;
+	msg->dynamic = true;
+	msg->sync = true;
+	EXPECT_FALSE(encoder->encode(*packetizer, buffer, msg));
+	EXPECT_EQ(errors, 5u);
+}
+
+TEST_F(EncoderTest, LINOnlyWhenEnabled)
+{
+	auto message = std::make_shared<LINMessage>();
+	message->network = Network::NetID::LIN;
+	message->ID = 0x22;
+	message->data = { 0x11, 0x22 };
+
+	// The record layout is unconfirmed, so LIN is not transmitted by default
+	size_t errors = 0;
+	onError = [&errors](APIEvent::Type t, APIEvent::Severity) {
+		EXPECT_EQ(t, APIEvent::Type::UnexpectedNetworkType);
+		errors++;
+	};
+	std::vector<uint8_t> bytes;
+	EXPECT_FALSE(encoder->encode(*packetizer, bytes, message));
+	EXPECT_EQ(errors, 1u);
+
+	encoder->encodeLINMessages = true;
+	EXPECT_TRUE(encoder->encode(*packetizer, bytes, message));
+	EXPECT_EQ(errors, 1u);
+	EXPECT_FALSE(bytes.empty());
+}
@@ -27,6 +27,30 @@ protected:
 		packetizer.reset();
 	}
 
+	// Packetize as the device would, then reassemble on the host side
+	std::vector<uint8_t> roundTripUp(size_t mtu, const std::vector<uint8_t>& data, size_t& framesUsed) {
+		EthernetPacketizer device([this](APIEvent::Type t, APIEvent::Severity s) {
+			onError(t, s);
+		});
+		memcpy(device.hostMAC, correctDeviceMAC, MAC_SIZE);
+		memcpy(device.deviceMAC, correctHostMAC, MAC_SIZE);
+		EXPECT_TRUE(device.setMaxPacketLength(EthernetPacketizer::MaxPacketLengthForMTU(mtu)));
+		device.inputDown(data);
+		auto frames = device.outputDown();
+		framesUsed = frames.size();
+
+		std::vector<uint8_t> ret;
+		for(auto& frame : frames) {
+			EXPECT_LE(frame.size(), mtu + 14); // Payload plus the Ethernet header
+			frame[13] = 0xb2; // Device to host
+			if(packetizer->inputUp(frame)) {
+				const auto bytes = packetizer->outputUp();
+				ret.insert(ret.end(), bytes.begin(), bytes.end());
+			}
+		}
+		return ret;
+	}
+
 	optional<EthernetPacketizer> packetizer;
 	device_eventhandler_t onError;
 };
@@ -250,4 +274,68 @@ TEST_F(EthernetPacketizerTest, PacketNumberIncrement)
 		0x03, 0x01, // first and last piece, version 1
 		0x13, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99
 	}));
-}
\ No newline at end of file
+}
+
+TEST_F(EthernetPacketizerTest, MaxPacketLengthForMTU)
+{
+	EXPECT_EQ(EthernetPacketizer::MaxPacketLengthForMTU(1500), 1490u);
+	EXPECT_EQ(EthernetPacketizer::MaxPacketLengthForMTU(9000), 8990u);
+	EXPECT_EQ(EthernetPacketizer::MaxPacketLengthForMTU(10), 0u); // No room for a payload
+	EXPECT_EQ(EthernetPacketizer::MaxPacketLengthForMTU(9001), 0u); // Larger than we allow
+
+	EXPECT_EQ(packetizer->getMaxPacketLength(), 1490u);
+	EXPECT_FALSE(packetizer->setMaxPacketLength(0));
+	EXPECT_FALSE(packetizer->setMaxPacketLength(8991));
+	EXPECT_EQ(packetizer->getMaxPacketLength(), 1490u);
+	EXPECT_TRUE(packetizer->setMaxPacketLength(8990));
+	EXPECT_EQ(packetizer->getMaxPacketLength(), 8990u);
+}
+
+TEST_F(EthernetPacketizerTest, DownJumboFrames)
+{
+	ASSERT_TRUE(packetizer->setMaxPacketLength(EthernetPacketizer::MaxPacketLengthForMTU(9000)));
+	packetizer->inputDown(std::vector<uint8_t>(9000)); // One full jumbo packet plus 10 bytes
+	const auto output = packetizer->outputDown();
+	ASSERT_EQ(output.size(), 2u);
+	std::vector<uint8_t> bigOutput({
+		0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+		0x12, 0x23, 0x34, 0x45, 0x56, 0x67,
+		0xca, 0xb1,
+		0xaa, 0xaa, 0x55, 0x55,
+		0x1e, 0x23, // 8990 bytes
+		0x00, 0x00, // packet number
+		0x01, 0x01, // first piece, version 1
+	});
+	bigOutput.resize(8990 + 24); // Full packet
+	EXPECT_EQ(output.front(), bigOutput);
+	EXPECT_EQ(output.back(), std::vector<uint8_t>({
+		0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+		0x12, 0x23, 0x34, 0x45, 0x56, 0x67,
+		0xca, 0xb1,
+		0xaa, 0xaa, 0x55, 0x55,
+		0x0a, 0x00, // 10 bytes
+		0x00, 0x00, // packet number
+		0x02, 0x01, // last piece, version 1
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	}));
+}
+
+TEST_F(EthernetPacketizerTest, UpReassemblyStandardFrames)
+{
+	std::vector<uint8_t> data(20000);
+	for(size_t i = 0; i < data.size(); i++)
+		data[i] = uint8_t(i * 7);
+	size_t frames = 0;
+	EXPECT_EQ(roundTripUp(1500, data, frames), data);
+	EXPECT_EQ(frames, 14u);
+}
+
+TEST_F(EthernetPacketizerTest, UpReassemblyJumboFrames)
+{
+	std::vector<uint8_t> data(20000);
+	for(size_t i = 0; i < data.size(); i++)
+		data[i] = uint8_t(i * 7);
+	size_t frames = 0;
+	EXPECT_EQ(roundTripUp(9000, data, frames), data);
+	EXPECT_EQ(frames, 3u);
+}
@@ -0,0 +1,214 @@
+#include "icsneo/disk/extextractordiskreaddriver.h"
+#include "icsneo/communication/communication.h"
+#include "icsneo/communication/packetizer.h"
+#include "icsneo/platform/optional.h"
+#include "gtest/gtest.h"
+#include "mockdriver.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+using namespace icsneo;
+
+static const uint64_t ReadSize = Disk::SectorSize * 512; // One Extract request
+static const uint16_t FrameSize = 4096;
+
+class ExtExtractorDiskReadDriverTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		auto mockDriver = std::unique_ptr<MockDriver>(new MockDriver(report));
+		transport = mockDriver.get();
+		transport->onWrite = [this](const std::vector<uint8_t>& bytes) {
+			std::lock_guard<std::mutex> lk(requestsMutex);
+			requests.push_back(bytes);
+		};
+		com.emplace(report, std::move(mockDriver), [this]() {
+			return std::unique_ptr<Packetizer>(new Packetizer(report));
+		}, std::unique_ptr<Encoder>(new Encoder(report)), std::unique_ptr<Decoder>(new Decoder(report)));
+		com->packetizer = com->makeConfiguredPacketizer();
+		ASSERT_TRUE(com->open());
+	}
+
+	void TearDown() override {
+		com.reset(); // Closes the communication
+	}
+
+	static uint8_t DiskByte(uint64_t pos) { return uint8_t(pos ^ (pos >> 8)); }
+
+	// The response some devices send to the Extract command before the data, which is skipped
+	static void AppendExtendedResponse(std::vector<uint8_t>& stream) {
+		const uint8_t body[] = { 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+		const uint16_t length = uint16_t(7 + sizeof(body));
+		stream.insert(stream.end(), { 0xAA, uint8_t(Network::NetID::RED), uint8_t(length & 0xFF), uint8_t(length >> 8), 0x00, 0x00, 0x00 });
+		stream.insert(stream.end(), body, body + sizeof(body));
+	}
+
+	// A frame of disk data, padded to an even length
+	static void AppendFrame(std::vector<uint8_t>& stream, uint64_t pos, uint16_t size) {
+		stream.insert(stream.end(), { 0xAA, uint8_t(Network::NetID::NeoMemorySDRead), 0x00, 0x00, 0x00, uint8_t(size & 0xFF), uint8_t(size >> 8) });
+		for(uint64_t i = 0; i < size; i++)
+			stream.push_back(DiskByte(pos + i));
+		if(size % 2 == 0)
+			stream.push_back(0x00);
+	}
+
+	// The device's answer for `amount` bytes from `pos`, starting with two short frames, one of them padded
+	static std::vector<uint8_t> ExtractResponse(uint64_t pos, uint64_t amount, bool extendedResponse = true) {
+		std::vector<uint8_t> stream;
+		if(extendedResponse)
+			AppendExtendedResponse(stream);
+		const uint16_t firstFrames[] = { 10, 11 };
+		uint64_t sent = 0;
+		for(size_t i = 0; sent < amount; i++) {
+			const uint16_t size = uint16_t(std::min<uint64_t>(i < 2 ? firstFrames[i] : FrameSize, amount - sent));
+			AppendFrame(stream, pos + sent, size);
+			sent += size;
+		}
+		return stream;
+	}
+
+	// Send the stream split at each of `splits`, then in larger chunks, letting the driver take each one separately
+	void feed(const std::vector<uint8_t>& stream, std::vector<size_t> splits) {
+		for(size_t split = (splits.empty() ? 0 : splits.back()) + 65536; split < stream.size(); split += 65536)
+			splits.push_back(split);
+		splits.push_back(stream.size());
+
+		size_t sent = 0;
+		for(const auto split : splits) {
+			transport->receive(std::vector<uint8_t>(stream.begin() + sent, stream.begin() + split));
+			sent = split;
+			while(transport->getReadQueueSize() != 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+
+	bool waitForRequests(size_t count) {
+		for(int i = 0; i < 500; i++) {
+			{
+				std::lock_guard<std::mutex> lk(requestsMutex);
+				if(requests.size() >= count)
+					return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		return false;
+	}
+
+	// Whether request `index` was an Extract of `sectorCount` sectors from `sector`
+	bool requested(size_t index, uint64_t sector, uint32_t sectorCount) {
+		std::vector<uint8_t> args;
+		for(int i = 0; i < 8; i++)
+			args.push_back(uint8_t(sector >> (i * 8)));
+		for(int i = 0; i < 4; i++)
+			args.push_back(uint8_t(sectorCount >> (i * 8)));
+		std::lock_guard<std::mutex> lk(requestsMutex);
+		return index < requests.size() &&
+			std::search(requests[index].begin(), requests[index].end(), args.begin(), args.end()) != requests[index].end();
+	}
+
+	// Read ReadSize bytes from the start of the disk, with the device's response split at `splits`
+	void readSplitAt(const std::vector<size_t>& splits, bool extendedResponse = true) {
+		std::vector<uint8_t> buf(ReadSize);
+		optional<uint64_t> amountRead;
+		std::thread reader([&]() {
+			amountRead = driver.readLogicalDisk(*com, report, 0, buf.data(), buf.size(), std::chrono::seconds(5));
+		});
+
+		ASSERT_TRUE(waitForRequests(1));
+		EXPECT_TRUE(requested(0, 0, 512));
+		feed(ExtractResponse(0, ReadSize, extendedResponse), splits);
+		reader.join();
+
+		EXPECT_EQ(amountRead, ReadSize);
+		size_t mismatched = 0;
+		for(size_t i = 0; i < buf.size(); i++) {
+			if(buf[i] != DiskByte(i))
+				mismatched++;
+		}
+		EXPECT_EQ(mismatched, 0u);
+		EXPECT_EQ(requests.size(), 1u);
+	}
+
+	const device_eventhandler_t report = [](APIEvent::Type, APIEvent::Severity) {
+		// Unless caught by the test, there should be no errors
+		EXPECT_TRUE(false);
+	};
+	optional<Communication> com;
+	MockDriver* transport = nullptr;
+	std::mutex requestsMutex;
+	std::vector<std::vector<uint8_t>> requests;
+	Disk::ExtExtractorDiskReadDriver driver;
+};
+
+// The extended response is 16 bytes, then the first frame's header, 10 bytes of data and a padding byte
+TEST_F(ExtExtractorDiskReadDriverTest, LargeChunks)
+{
+	readSplitAt({});
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, SplitWithinExtendedResponse)
+{
+	readSplitAt({ 3, 7, 12 });
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, SplitAfterExtendedResponseHeader)
+{
+	readSplitAt({ 12 });
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, SplitWithinFrameHeader)
+{
+	readSplitAt({ 16, 18, 22 });
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, SplitWithinFrameData)
+{
+	readSplitAt({ 23, 24, 28 });
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, SplitBeforePadding)
+{
+	readSplitAt({ 33 });
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, SplitEveryByte)
+{
+	std::vector<size_t> splits;
+	for(size_t i = 1; i < 64; i++)
+		splits.push_back(i);
+	readSplitAt(splits);
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, NoExtendedResponse)
+{
+	readSplitAt({ 5, 17 }, false);
+}
+
+TEST_F(ExtExtractorDiskReadDriverTest, ResumesAfterStall)
+{
+	std::vector<uint8_t> buf(ReadSize);
+	optional<uint64_t> amountRead;
+	std::thread reader([&]() {
+		amountRead = driver.readLogicalDisk(*com, report, 0, buf.data(), buf.size(), std::chrono::seconds(5));
+	});
+
+	// The device stops part way through the third sector, which is requested again along with the rest
+	ASSERT_TRUE(waitForRequests(1));
+	EXPECT_TRUE(requested(0, 0, 512));
+	const auto first = ExtractResponse(0, ReadSize);
+	const size_t stallAt = 16 + (7 + 10 + 1) + (7 + 11) + (7 + 1100);
+	feed(std::vector<uint8_t>(first.begin(), first.begin() + stallAt), {});
+
+	ASSERT_TRUE(waitForRequests(2));
+	EXPECT_TRUE(requested(1, 2, 510));
+	feed(ExtractResponse(2 * Disk::SectorSize, ReadSize - 2 * Disk::SectorSize), { 9 });
+	reader.join();
+
+	EXPECT_EQ(amountRead, ReadSize);
+	size_t mismatched = 0;
+	for(size_t i = 0; i < buf.size(); i++) {
+		if(buf[i] != DiskByte(i))
+			mismatched++;
+	}
+	EXPECT_EQ(mismatched, 0u);
+}
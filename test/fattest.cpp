@@ -0,0 +1,146 @@
+#include "icsneo/disk/fat.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <thread>
+#include <future>
+#include <atomic>
+
+using namespace icsneo;
+
+class FATTest : public ::testing::Test {
+protected:
+	// A minimal FAT12 volume holding only LOG_DATA.VSA
+	static std::vector<uint8_t> MakeImage(uint16_t vsaCluster, uint32_t vsaSize) {
+		std::vector<uint8_t> image(128 * 512);
+		uint8_t* const bs = image.data();
+		bs[0] = 0xEB; bs[1] = 0x3C; bs[2] = 0x90;
+		memcpy(bs + 3, "MSDOS5.0", 8);
+		Put16(bs + 11, 512); // Bytes per sector
+		bs[13] = 1; // Sectors per cluster
+		Put16(bs + 14, 1); // Reserved sectors
+		bs[16] = 1; // Number of FATs
+		Put16(bs + 17, 16); // Root directory entries, one sector's worth
+		Put16(bs + 19, 128); // Total sectors
+		bs[21] = 0xF8; // Media
+		Put16(bs + 22, 1); // Sectors per FAT
+		memcpy(bs + 54, "FAT12   ", 8);
+		bs[510] = 0x55; bs[511] = 0xAA;
+
+		image[512] = 0xF8; image[513] = 0xFF; image[514] = 0xFF; // Reserved FAT entries
+
+		// The root directory follows the reserved sector and the FAT, and the data follows it
+		uint8_t* const entry = image.data() + 2 * 512;
+		memcpy(entry, "LOG_DATAVSA", 11);
+		entry[11] = 0x20; // Archive
+		Put16(entry + 26, vsaCluster);
+		Put16(entry + 28, uint16_t(vsaSize));
+		Put16(entry + 30, uint16_t(vsaSize >> 16));
+		return image;
+	}
+
+	static uint64_t ExpectedOffset(uint16_t vsaCluster) {
+		return (3 + (vsaCluster - 2)) * 512;
+	}
+
+	static Disk::DiskReadFn Reader(const std::vector<uint8_t>& image) {
+		return [&image](uint64_t pos, uint8_t* into, uint64_t amount) -> optional<uint64_t> {
+			if(pos + amount > image.size())
+				return nullopt;
+			memcpy(into, image.data() + pos, size_t(amount));
+			return amount;
+		};
+	}
+
+private:
+	static void Put16(uint8_t* at, uint16_t value) {
+		at[0] = uint8_t(value);
+		at[1] = uint8_t(value >> 8);
+	}
+};
+
+TEST_F(FATTest, FindVSA)
+{
+	const auto image = MakeImage(10, 0x12345);
+	const auto extent = Disk::FindVSAExtentInFAT(Reader(image));
+	ASSERT_TRUE(extent.has_value());
+	EXPECT_EQ(extent->offset, ExpectedOffset(10));
+	EXPECT_EQ(extent->size, 0x12345u);
+	EXPECT_EQ(Disk::FindVSAInFAT(Reader(image)), ExpectedOffset(10));
+
+	const std::vector<uint8_t> blank(128 * 512);
+	EXPECT_FALSE(Disk::FindVSAExtentInFAT(Reader(blank)).has_value());
+}
+
+TEST_F(FATTest, LookupsRunInParallel)
+{
+	const auto first = MakeImage(5, 512);
+	const auto second = MakeImage(20, 1024);
+
+	// Counts the reads in progress, from either lookup
+	std::atomic<int> reading{0};
+	std::atomic<int> maxReading{0};
+	const auto read = [&](const std::vector<uint8_t>& image, uint64_t pos, uint8_t* into, uint64_t amount) {
+		const int now = ++reading;
+		int max = maxReading;
+		while(now > max && !maxReading.compare_exchange_weak(max, now)) {}
+		const auto ret = Reader(image)(pos, into, amount);
+		reading--;
+		return ret;
+	};
+
+	std::promise<void> firstStarted;
+	std::promise<void> secondRead;
+	optional<Disk::VSAExtent> firstExtent;
+	std::thread thread([&]() {
+		bool held = false;
+		firstExtent = Disk::FindVSAExtentInFAT([&](uint64_t pos, uint8_t* into, uint64_t amount) {
+			if(pos >= 2 * 512 && !held) {
+				// Hold this lookup up in its first read after mounting, the root directory, until the other one has read
+				held = true;
+				reading++;
+				firstStarted.set_value();
+				secondRead.get_future().wait();
+				reading--;
+			}
+			return read(first, pos, into, amount);
+		});
+	});
+
+	firstStarted.get_future().wait();
+	bool signalled = false;
+	const auto secondExtent = Disk::FindVSAExtentInFAT([&](uint64_t pos, uint8_t* into, uint64_t amount) {
+		const auto ret = read(second, pos, into, amount);
+		if(!signalled) {
+			signalled = true;
+			secondRead.set_value();
+		}
+		return ret;
+	});
+	thread.join();
+
+	EXPECT_EQ(maxReading, 2); // The second lookup read while the first was still part way through
+	ASSERT_TRUE(firstExtent.has_value());
+	EXPECT_EQ(firstExtent->offset, ExpectedOffset(5));
+	ASSERT_TRUE(secondExtent.has_value());
+	EXPECT_EQ(secondExtent->offset, ExpectedOffset(20));
+}
+
+TEST_F(FATTest, MoreLookupsThanVolumes)
+{
+	// More than FatFs has volumes for, the extra lookups wait for one to be free
+	std::vector<std::vector<uint8_t>> images;
+	for(uint16_t i = 0; i < 16; i++)
+		images.push_back(MakeImage(uint16_t(2 + i), 512));
+
+	std::vector<optional<Disk::VSAExtent>> extents(images.size());
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < images.size(); i++)
+		threads.emplace_back([&, i]() { extents[i] = Disk::FindVSAExtentInFAT(Reader(images[i])); });
+	for(auto& thread : threads)
+		thread.join();
+
+	for(size_t i = 0; i < images.size(); i++) {
+		ASSERT_TRUE(extents[i].has_value());
+		EXPECT_EQ(extents[i]->offset, ExpectedOffset(uint16_t(2 + i)));
+	}
+}
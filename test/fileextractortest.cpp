@@ -0,0 +1,127 @@
+#include "diskdrivertest.h"
+#include "icsneo/disk/fileextractor.h"
+#include <fstream>
+#include <cstdio>
+
+static const char* const ExtractPath = "icsneo-fileextractortest.bin";
+
+class FileExtractorTest : public DiskDriverTest {
+protected:
+	void SetUp() override {
+		DiskDriverTest::SetUp();
+		std::remove(ExtractPath);
+		std::remove(Disk::FileExtractor::CheckpointPath(ExtractPath).c_str());
+		extractor.emplace([this](uint64_t pos, uint8_t* into, uint64_t amount) -> optional<uint64_t> {
+			if(failAt && pos + amount > *failAt)
+				return nullopt; // As if the device had disconnected
+			bytesRead += amount;
+			return readLogicalDisk(pos, into, amount);
+		}, onError);
+		extractor->chunkSize = 64;
+		extractor->checkpointInterval = 256;
+	}
+
+	void TearDown() override {
+		extractor.reset();
+		std::remove(ExtractPath);
+		std::remove(Disk::FileExtractor::CheckpointPath(ExtractPath).c_str());
+		DiskDriverTest::TearDown();
+	}
+
+	static std::vector<uint8_t> ReadFile(const char* path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+	static bool Exists(const std::string& path) {
+		return std::ifstream(path).is_open();
+	}
+
+	optional<Disk::FileExtractor> extractor;
+	optional<uint64_t> failAt;
+	uint64_t bytesRead = 0;
+};
+
+TEST_F(FileExtractorTest, Extract) {
+	std::vector<Disk::FileExtractor::Progress> progress;
+	extractor->progressInterval = std::chrono::milliseconds::zero();
+	extractor->onProgress = [&progress](const Disk::FileExtractor::Progress& p) { progress.push_back(p); };
+
+	ASSERT_TRUE(extractor->extract(100, 900, ExtractPath));
+	const auto extracted = ReadFile(ExtractPath);
+	ASSERT_EQ(extracted.size(), 900u);
+	EXPECT_EQ(memcmp(extracted.data(), driver->mockDisk.data() + 100, extracted.size()), 0);
+	EXPECT_EQ(extractor->getChecksum(), Disk::FileExtractor::CRC32(driver->mockDisk.data() + 100, 900));
+	EXPECT_FALSE(Exists(Disk::FileExtractor::CheckpointPath(ExtractPath)));
+
+	ASSERT_FALSE(progress.empty());
+	EXPECT_EQ(progress.front().extracted, 0u);
+	EXPECT_EQ(progress.back().extracted, 900u);
+	EXPECT_EQ(progress.back().total, 900u);
+	for(size_t i = 1; i < progress.size(); i++)
+		EXPECT_GE(progress[i].extracted, progress[i - 1].extracted);
+}
+
+TEST_F(FileExtractorTest, CRC32) {
+	const char check[] = "123456789";
+	EXPECT_EQ(Disk::FileExtractor::CRC32(reinterpret_cast<const uint8_t*>(check), 9), 0xCBF43926u);
+	// Continuing a checksum gives the same result as doing it all at once
+	const auto first = Disk::FileExtractor::CRC32(reinterpret_cast<const uint8_t*>(check), 4);
+	EXPECT_EQ(Disk::FileExtractor::CRC32(reinterpret_cast<const uint8_t*>(check) + 4, 5, first), 0xCBF43926u);
+}
+
+TEST_F(FileExtractorTest, ResumeAfterDisconnect) {
+	failAt = 600;
+	EXPECT_FALSE(extractor->extract(0, 1024, ExtractPath));
+	EXPECT_TRUE(Exists(Disk::FileExtractor::CheckpointPath(ExtractPath)));
+
+	// Everything up to the last checkpoint at 512 is kept
+	failAt.reset();
+	bytesRead = 0;
+	ASSERT_TRUE(extractor->extract(0, 1024, ExtractPath));
+	EXPECT_EQ(bytesRead, 512u);
+
+	const auto extracted = ReadFile(ExtractPath);
+	ASSERT_EQ(extracted.size(), 1024u);
+	EXPECT_EQ(memcmp(extracted.data(), driver->mockDisk.data(), extracted.size()), 0);
+	EXPECT_EQ(extractor->getChecksum(), Disk::FileExtractor::CRC32(driver->mockDisk.data(), 1024));
+	EXPECT_FALSE(Exists(Disk::FileExtractor::CheckpointPath(ExtractPath)));
+}
+
+TEST_F(FileExtractorTest, ResumeVerifiesWhatWasWritten) {
+	failAt = 900;
+	EXPECT_FALSE(extractor->extract(0, 1024, ExtractPath));
+
+	// Damage the second segment, the first is still good
+	{
+		std::fstream file(ExtractPath, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(300);
+		file.put(char(~driver->mockDisk[300]));
+	}
+
+	failAt.reset();
+	bytesRead = 0;
+	expectedErrors.push({ APIEvent::Type::ExtractionRestarted, APIEvent::Severity::EventWarning });
+	ASSERT_TRUE(extractor->extract(0, 1024, ExtractPath));
+	EXPECT_TRUE(expectedErrors.empty());
+	EXPECT_EQ(bytesRead, 768u);
+
+	const auto extracted = ReadFile(ExtractPath);
+	ASSERT_EQ(extracted.size(), 1024u);
+	EXPECT_EQ(memcmp(extracted.data(), driver->mockDisk.data(), extracted.size()), 0);
+}
+
+TEST_F(FileExtractorTest, DifferentExtractionStartsOver) {
+	failAt = 600;
+	EXPECT_FALSE(extractor->extract(0, 1024, ExtractPath));
+
+	failAt.reset();
+	bytesRead = 0;
+	expectedErrors.push({ APIEvent::Type::ExtractionRestarted, APIEvent::Severity::EventWarning });
+	ASSERT_TRUE(extractor->extract(512, 512, ExtractPath));
+	EXPECT_EQ(bytesRead, 512u);
+
+	const auto extracted = ReadFile(ExtractPath);
+	ASSERT_EQ(extracted.size(), 512u);
+	EXPECT_EQ(memcmp(extracted.data(), driver->mockDisk.data() + 512, extracted.size()), 0);
+}
@@ -0,0 +1,100 @@
+#include "icsneo/disk/imagediskdriver.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <queue>
+
+using namespace icsneo;
+
+class ImageDiskDriverTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		report = [this](APIEvent::Type t, APIEvent::Severity) {
+			if(expectedErrors.empty()) {
+				// Unless caught by the test, the driver should not throw errors
+				EXPECT_TRUE(false);
+			} else {
+				EXPECT_EQ(expectedErrors.front(), t);
+				expectedErrors.pop();
+			}
+		};
+		driver.emplace(report);
+
+		contents.resize(4 * Disk::SectorSize);
+		for(size_t i = 0; i < contents.size(); i++)
+			contents[i] = uint8_t(i * 7);
+		std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(contents.data()), std::streamsize(contents.size()));
+	}
+
+	void TearDown() override {
+		driver.reset();
+		std::remove(path.c_str());
+		EXPECT_TRUE(expectedErrors.empty());
+	}
+
+	std::vector<uint8_t> readFile() const {
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	const std::string path = "imagediskdrivertest.img";
+	std::vector<uint8_t> contents;
+	std::queue<APIEvent::Type> expectedErrors;
+	device_eventhandler_t report;
+	optional<Disk::ImageDiskDriver> driver;
+};
+
+TEST_F(ImageDiskDriverTest, Read)
+{
+	ASSERT_TRUE(driver->open(path));
+	EXPECT_EQ(driver->getSize(), contents.size());
+
+	std::vector<uint8_t> buf(1000);
+	EXPECT_EQ(driver->readLogicalDisk(300, buf.data(), buf.size()), buf.size());
+	EXPECT_TRUE(std::equal(buf.begin(), buf.end(), contents.begin() + 300));
+
+	// Larger blocks, as the ExtExtractorDiskReadDriver uses, read the same
+	driver->maxBlockSize = 4 * Disk::SectorSize;
+	driver->invalidateCache();
+	std::vector<uint8_t> all(contents.size());
+	EXPECT_EQ(driver->readLogicalDisk(0, all.data(), all.size()), all.size());
+	EXPECT_EQ(all, contents);
+
+	// Reads past the end stop there
+	expectedErrors.push(APIEvent::Type::EOFReached);
+	EXPECT_EQ(driver->readLogicalDisk(contents.size() - 10, buf.data(), 20), 10u);
+}
+
+TEST_F(ImageDiskDriverTest, Write)
+{
+	ASSERT_TRUE(driver->open(path, true));
+	const uint8_t data[] = { 0xDE, 0xAD, 0xBE, 0xEF };
+	EXPECT_EQ(driver->writeLogicalDisk(510, data, sizeof(data)), sizeof(data));
+
+	uint8_t back[sizeof(data)];
+	EXPECT_EQ(driver->readLogicalDisk(510, back, sizeof(back)), sizeof(back));
+	EXPECT_EQ(memcmp(back, data, sizeof(data)), 0);
+
+	driver->close();
+	auto expected = contents;
+	std::copy(data, data + sizeof(data), expected.begin() + 510);
+	EXPECT_EQ(readFile(), expected);
+}
+
+TEST_F(ImageDiskDriverTest, ReadOnly)
+{
+	ASSERT_TRUE(driver->open(path));
+	const uint8_t data[] = { 1, 2, 3 };
+	expectedErrors.push(APIEvent::Type::DiskNotSupported);
+	expectedErrors.push(APIEvent::Type::ParameterOutOfRange);
+	EXPECT_FALSE(driver->writeLogicalDisk(0, data, sizeof(data)).has_value());
+	driver->close();
+	EXPECT_EQ(readFile(), contents);
+}
+
+TEST_F(ImageDiskDriverTest, MissingImage)
+{
+	expectedErrors.push(APIEvent::Type::DiskImageError);
+	EXPECT_FALSE(driver->open("imagediskdrivertest-missing.img"));
+	EXPECT_FALSE(driver->isOpen());
+}
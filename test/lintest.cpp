@@ -0,0 +1,178 @@
+#include "icsneo/communication/decoder.h"
+#include "icsneo/communication/packet/linpacket.h"
+#include "icsneo/communication/message/linmessage.h"
+#include "gtest/gtest.h"
+
+using namespace icsneo;
+
+class LINTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		report = [](APIEvent::Type, APIEvent::Severity) {
+			// Unless caught by the test, there should be no errors
+			EXPECT_TRUE(false);
+		};
+		decoder.emplace(report);
+		decoder->decodeLINMessages = true;
+	}
+
+	std::shared_ptr<Message> decode(const std::vector<uint8_t>& bytes) {
+		auto packet = std::make_shared<Packet>();
+		packet->network = Network::NetID::LIN;
+		packet->data = bytes;
+		std::shared_ptr<Message> decoded;
+		EXPECT_TRUE(decoder->decode(decoded, packet));
+		return decoded;
+	}
+
+	std::shared_ptr<LINMessage> roundTrip(const LINMessage& message) {
+		auto packet = std::make_shared<Packet>();
+		packet->network = Network::NetID::LIN;
+		EXPECT_TRUE(HardwareLINPacket::EncodeFromMessage(message, packet->data, report));
+		EXPECT_EQ(packet->data.size(), sizeof(HardwareLINPacket));
+
+		std::shared_ptr<Message> decoded;
+		EXPECT_TRUE(decoder->decode(decoded, packet));
+		return std::dynamic_pointer_cast<LINMessage>(decoded);
+	}
+
+	device_eventhandler_t report;
+	optional<Decoder> decoder;
+};
+
+TEST_F(LINTest, ProtectedID)
+{
+	EXPECT_EQ(LINMessage::CalcProtectedID(0x00), 0x80);
+	EXPECT_EQ(LINMessage::CalcProtectedID(0x01), 0xC1);
+	EXPECT_EQ(LINMessage::CalcProtectedID(0x3C), 0x3C);
+	EXPECT_EQ(LINMessage::CalcProtectedID(0x3D), 0x7D);
+	EXPECT_EQ(LINMessage::CalcProtectedID(0x3F), 0xBF);
+}
+
+TEST_F(LINTest, Checksum)
+{
+	const uint8_t data[] = { 0x4A, 0x55, 0x93, 0xE5 };
+	// 0x4A + 0x55 + 0x93 + 0xE5 with carries is 0x19
+	EXPECT_EQ(LINMessage::CalcChecksum(data, sizeof(data), 0, false), 0xE6);
+	// The enhanced checksum adds in the protected ID
+	EXPECT_EQ(LINMessage::CalcChecksum(data, sizeof(data), 0x50, true), 0x96);
+}
+
+TEST_F(LINTest, RawMessageByDefault)
+{
+	const std::vector<uint8_t> bytes(sizeof(HardwareLINPacket), 0x5A);
+	decoder->decodeLINMessages = false;
+	const auto decoded = decode(bytes);
+	ASSERT_NE(decoded, nullptr);
+	ASSERT_EQ(decoded->type, Message::Type::RawMessage);
+	const auto raw = std::static_pointer_cast<RawMessage>(decoded);
+	EXPECT_EQ(raw->network, Network::NetID::LIN);
+	EXPECT_EQ(raw->data, bytes);
+}
+
+// These records are assembled byte by byte from the HardwareLINPacket layout, independently of the
+// encoder, they are not captures from a device. Replace them with captures once the layout is confirmed.
+TEST_F(LINTest, DecodeReceivedEnhanced)
+{
+	const auto decoded = std::dynamic_pointer_cast<LINMessage>(decode({
+		0x88, 0x03, // Protected ID 0xE2 (ID 0x22) in bits 2-12
+		0x04, 0x00, // 4 data bytes
+		0x72, 0x00, // Enhanced checksum, nothing transmitted
+		0x11, 0x22, 0x33, 0x44, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, // Description
+		0x34, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 // Timestamp
+	}));
+	ASSERT_NE(decoded, nullptr);
+	EXPECT_EQ(decoded->network, Network::NetID::LIN);
+	EXPECT_EQ(decoded->ID, 0x22);
+	EXPECT_EQ(decoded->protectedID, 0xE2);
+	EXPECT_EQ(decoded->data, std::vector<uint8_t>({ 0x11, 0x22, 0x33, 0x44 }));
+	EXPECT_EQ(decoded->checksum, 0x72);
+	EXPECT_TRUE(decoded->isEnhancedChecksum);
+	EXPECT_FALSE(decoded->transmitted);
+	EXPECT_FALSE(decoded->error);
+	EXPECT_EQ(decoded->timestamp, 0x1234u * 25);
+}
+
+TEST_F(LINTest, DecodeReceivedClassic)
+{
+	const auto decoded = std::dynamic_pointer_cast<LINMessage>(decode({
+		0x40, 0x01, // Protected ID 0x50 (ID 0x10)
+		0x02, 0x00, // 2 data bytes
+		0x99, 0x00, // Classic checksum
+		0xAA, 0xBB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00,
+		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	}));
+	ASSERT_NE(decoded, nullptr);
+	EXPECT_EQ(decoded->ID, 0x10);
+	EXPECT_EQ(decoded->data, std::vector<uint8_t>({ 0xAA, 0xBB }));
+	EXPECT_FALSE(decoded->isEnhancedChecksum);
+	EXPECT_FALSE(decoded->error);
+}
+
+TEST_F(LINTest, RoundTrip)
+{
+	LINMessage message;
+	message.ID = 0x22;
+	message.data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	message.isEnhancedChecksum = true;
+
+	const auto decoded = roundTrip(message);
+	ASSERT_NE(decoded, nullptr);
+	EXPECT_EQ(decoded->network, Network::NetID::LIN);
+	EXPECT_EQ(decoded->ID, 0x22);
+	EXPECT_EQ(decoded->protectedID, LINMessage::CalcProtectedID(0x22));
+	EXPECT_EQ(decoded->data, message.data);
+	EXPECT_TRUE(decoded->isEnhancedChecksum);
+	EXPECT_TRUE(decoded->transmitted);
+	EXPECT_FALSE(decoded->error);
+
+	message.isEnhancedChecksum = false;
+	const auto classic = roundTrip(message);
+	ASSERT_NE(classic, nullptr);
+	EXPECT_FALSE(classic->isEnhancedChecksum);
+	EXPECT_FALSE(classic->error);
+}
+
+TEST_F(LINTest, DetectsErrors)
+{
+	LINMessage message;
+	message.ID = 0x10;
+	message.data = { 0xAA, 0xBB };
+	auto packet = std::make_shared<Packet>();
+	packet->network = Network::NetID::LIN;
+	ASSERT_TRUE(HardwareLINPacket::EncodeFromMessage(message, packet->data, report));
+
+	auto corrupt = std::make_shared<Packet>(*packet);
+	reinterpret_cast<HardwareLINPacket*>(corrupt->data.data())->flags.checksum ^= 0x01;
+	std::shared_ptr<Message> decoded;
+	ASSERT_TRUE(decoder->decode(decoded, corrupt));
+	auto lin = std::static_pointer_cast<LINMessage>(decoded);
+	EXPECT_TRUE(lin->errFlags.checksumError);
+	EXPECT_FALSE(lin->errFlags.idParityError);
+	EXPECT_TRUE(lin->error);
+
+	corrupt = std::make_shared<Packet>(*packet);
+	reinterpret_cast<HardwareLINPacket*>(corrupt->data.data())->CoreMiniBitsLIN.ID ^= 0x80; // Flip a parity bit
+	ASSERT_TRUE(decoder->decode(decoded, corrupt));
+	lin = std::static_pointer_cast<LINMessage>(decoded);
+	EXPECT_TRUE(lin->errFlags.idParityError);
+	EXPECT_TRUE(lin->error);
+}
+
+TEST_F(LINTest, EncodeRejectsBadMessages)
+{
+	size_t errors = 0;
+	const device_eventhandler_t countErrors = [&errors](APIEvent::Type, APIEvent::Severity) { errors++; };
+	std::vector<uint8_t> bytes;
+
+	LINMessage message;
+	message.ID = 0x40;
+	EXPECT_FALSE(HardwareLINPacket::EncodeFromMessage(message, bytes, countErrors));
+	message.ID = 0x01;
+	message.data.resize(9);
+	EXPECT_FALSE(HardwareLINPacket::EncodeFromMessage(message, bytes, countErrors));
+	EXPECT_EQ(errors, 2u);
+	EXPECT_TRUE(bytes.empty());
+}
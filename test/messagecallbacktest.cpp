@@ -0,0 +1,213 @@
+#include "icsneo/communication/message/callback/messagecallback.h"
+#include "icsneo/communication/message/canmessage.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+
+using namespace icsneo;
+
+class MessageCallbackTest : public ::testing::Test {
+protected:
+	static std::shared_ptr<Message> MakeMessage(uint32_t arbid) {
+		auto msg = std::make_shared<CANMessage>();
+		msg->network = Network::NetID::HSCAN;
+		msg->arbid = arbid;
+		return msg;
+	}
+
+	static uint32_t ArbIDOf(const std::shared_ptr<Message>& msg) {
+		return std::static_pointer_cast<CANMessage>(msg)->arbid;
+	}
+
+	bool waitFor(const std::function<bool()>& done) {
+		for(int i = 0; i < 500; i++) {
+			if(done())
+				return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		return false;
+	}
+
+	// Lets a test hold up a callback until it is ready
+	class Gate {
+	public:
+		void wait() {
+			std::unique_lock<std::mutex> lk(mutex);
+			cv.wait(lk, [this]() { return open; });
+		}
+		void release() {
+			{
+				std::lock_guard<std::mutex> lk(mutex);
+				open = true;
+			}
+			cv.notify_all();
+		}
+	private:
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool open = false;
+	};
+};
+
+TEST_F(MessageCallbackTest, SynchronousByDefault)
+{
+	std::thread::id calledOn;
+	MessageCallback cb([&calledOn](std::shared_ptr<Message>) { calledOn = std::this_thread::get_id(); });
+	EXPECT_FALSE(cb.isAsync());
+	EXPECT_TRUE(cb.callIfMatch(MakeMessage(1)));
+	EXPECT_EQ(calledOn, std::this_thread::get_id());
+	EXPECT_EQ(cb.getAsyncStats().delivered, 0u);
+}
+
+TEST_F(MessageCallbackTest, AsyncDeliversInOrder)
+{
+	std::mutex mutex;
+	std::vector<uint32_t> seen;
+	std::thread::id calledOn;
+	MessageCallback cb([&](std::shared_ptr<Message> msg) {
+		std::lock_guard<std::mutex> lk(mutex);
+		seen.push_back(ArbIDOf(msg));
+		calledOn = std::this_thread::get_id();
+	});
+	cb.runAsync();
+	EXPECT_TRUE(cb.isAsync());
+
+	const MessageCallback copy = cb; // As it would be when added to a device
+	for(uint32_t i = 0; i < 1000; i++)
+		EXPECT_TRUE(copy.callIfMatch(MakeMessage(i)));
+	EXPECT_TRUE(waitFor([&cb]() { return cb.getAsyncStats().delivered == 1000; }));
+
+	std::lock_guard<std::mutex> lk(mutex);
+	ASSERT_EQ(seen.size(), 1000u);
+	for(uint32_t i = 0; i < 1000; i++)
+		EXPECT_EQ(seen[i], i);
+	EXPECT_NE(calledOn, std::this_thread::get_id());
+	EXPECT_EQ(cb.getAsyncStats().dropped, 0u);
+}
+
+TEST_F(MessageCallbackTest, AsyncFilterStillApplies)
+{
+	std::atomic<size_t> received{0};
+	MessageCallback cb(MessageFilter(Network::NetID::MSCAN), [&received](std::shared_ptr<Message>) { received++; });
+	cb.runAsync();
+	EXPECT_FALSE(cb.callIfMatch(MakeMessage(1)));
+	EXPECT_EQ(cb.getAsyncStats().maxQueueDepth, 0u);
+}
+
+TEST_F(MessageCallbackTest, AsyncDropNewest)
+{
+	Gate gate;
+	std::vector<uint32_t> seen;
+	MessageCallback cb([&](std::shared_ptr<Message> msg) {
+		gate.wait();
+		seen.push_back(ArbIDOf(msg));
+	});
+	cb.runAsync(4, CallbackExecutor::QueueFullPolicy::DropNewest);
+
+	// The first is picked up by the worker, which is then held by the gate
+	cb.callIfMatch(MakeMessage(0));
+	ASSERT_TRUE(waitFor([&cb]() { return cb.getAsyncStats().queueDepth == 0; }));
+	for(uint32_t i = 1; i < 10; i++)
+		cb.callIfMatch(MakeMessage(i));
+	auto stats = cb.getAsyncStats();
+	EXPECT_EQ(stats.queueDepth, 4u);
+	EXPECT_EQ(stats.maxQueueDepth, 4u);
+	EXPECT_EQ(stats.dropped, 5u);
+
+	gate.release();
+	EXPECT_TRUE(waitFor([&cb]() { return cb.getAsyncStats().delivered == 5; }));
+	EXPECT_EQ(seen, std::vector<uint32_t>({ 0, 1, 2, 3, 4 }));
+}
+
+TEST_F(MessageCallbackTest, AsyncDropOldest)
+{
+	Gate gate;
+	std::vector<uint32_t> seen;
+	MessageCallback cb([&](std::shared_ptr<Message> msg) {
+		gate.wait();
+		seen.push_back(ArbIDOf(msg));
+	});
+	cb.runAsync(4, CallbackExecutor::QueueFullPolicy::DropOldest);
+
+	cb.callIfMatch(MakeMessage(0));
+	ASSERT_TRUE(waitFor([&cb]() { return cb.getAsyncStats().queueDepth == 0; }));
+	for(uint32_t i = 1; i < 10; i++)
+		cb.callIfMatch(MakeMessage(i));
+	EXPECT_EQ(cb.getAsyncStats().dropped, 5u);
+
+	gate.release();
+	EXPECT_TRUE(waitFor([&cb]() { return cb.getAsyncStats().delivered == 5; }));
+	EXPECT_EQ(seen, std::vector<uint32_t>({ 0, 6, 7, 8, 9 }));
+}
+
+TEST_F(MessageCallbackTest, AsyncBlock)
+{
+	std::atomic<size_t> received{0};
+	MessageCallback cb([&received](std::shared_ptr<Message>) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+		received++;
+	});
+	cb.runAsync(2, CallbackExecutor::QueueFullPolicy::Block);
+
+	for(uint32_t i = 0; i < 100; i++)
+		cb.callIfMatch(MakeMessage(i));
+	EXPECT_TRUE(waitFor([&received]() { return received == 100; }));
+	const auto stats = cb.getAsyncStats();
+	EXPECT_EQ(stats.dropped, 0u);
+	EXPECT_LE(stats.maxQueueDepth, 2u);
+}
+
+TEST_F(MessageCallbackTest, SlowCallbackDoesNotHoldUpOthersInSharedExecutor)
+{
+	auto executor = std::make_shared<CallbackExecutor>(2);
+	EXPECT_EQ(executor->getThreadCount(), 2u);
+
+	Gate gate;
+	std::atomic<size_t> fastReceived{0};
+	MessageCallback slow([&gate](std::shared_ptr<Message>) { gate.wait(); });
+	MessageCallback fast([&fastReceived](std::shared_ptr<Message>) { fastReceived++; });
+	slow.runAsync(executor);
+	fast.runAsync(executor);
+
+	for(uint32_t i = 0; i < 100; i++) {
+		slow.callIfMatch(MakeMessage(i));
+		fast.callIfMatch(MakeMessage(i));
+	}
+	EXPECT_TRUE(waitFor([&fastReceived]() { return fastReceived == 100; }));
+	EXPECT_EQ(slow.getAsyncStats().delivered, 0u);
+
+	gate.release();
+	EXPECT_TRUE(waitFor([&slow]() { return slow.getAsyncStats().delivered == 100; }));
+}
+
+TEST_F(MessageCallbackTest, StopAsyncDiscardsAndWaits)
+{
+	Gate gate;
+	std::atomic<bool> running{false};
+	std::atomic<size_t> received{0};
+	MessageCallback cb([&](std::shared_ptr<Message>) {
+		running = true;
+		gate.wait();
+		received++;
+	});
+	cb.runAsync();
+
+	for(uint32_t i = 0; i < 10; i++)
+		cb.callIfMatch(MakeMessage(i));
+	ASSERT_TRUE(waitFor([&running]() { return !!running; }));
+
+	std::atomic<bool> stopped{false};
+	std::thread stopper([&cb, &stopped]() {
+		cb.stopAsync();
+		stopped = true;
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_FALSE(stopped); // Still waiting for the running callback
+	gate.release();
+	stopper.join();
+
+	EXPECT_EQ(received, 1u);
+	cb.callIfMatch(MakeMessage(100));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(received, 1u);
+}
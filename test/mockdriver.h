@@ -0,0 +1,34 @@
+#ifndef __MOCKDRIVER_H_
+#define __MOCKDRIVER_H_
+
+#include "icsneo/communication/driver.h"
+#include <functional>
+
+using namespace icsneo;
+
+// A driver with no device behind it, the test plays the part of the device
+class MockDriver : public Driver {
+public:
+	MockDriver(const device_eventhandler_t& report) : Driver(report) {}
+	bool open() override { opened = true; return true; }
+	bool isOpen() override { return opened; }
+	bool close() override { opened = false; return true; }
+
+	// Bytes as they would come from the device
+	void receive(const std::vector<uint8_t>& bytes) { readQueue.enqueue_bulk(bytes.data(), bytes.size()); }
+
+	// Called with the bytes as they would go to the device, which are otherwise dropped
+	std::function<void(const std::vector<uint8_t>&)> onWrite;
+
+private:
+	void readTask() override {}
+	void writeTask() override {}
+	bool writeInternal(const uint8_t* b, size_t size) override {
+		if(onWrite)
+			onWrite(std::vector<uint8_t>(b, b + size));
+		return true;
+	}
+	bool opened = false;
+};
+
+#endif // __MOCKDRIVER_H_
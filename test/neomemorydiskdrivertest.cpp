@@ -0,0 +1,119 @@
+#include "icsneo/disk/neomemorydiskdriver.h"
+#include "icsneo/communication/communication.h"
+#include "icsneo/communication/packetizer.h"
+#include "icsneo/platform/optional.h"
+#include "gtest/gtest.h"
+#include "mockdriver.h"
+#include <atomic>
+#include <thread>
+
+using namespace icsneo;
+
+class NeoMemoryDiskDriverTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		auto mockDriver = std::unique_ptr<MockDriver>(new MockDriver(report));
+		transport = mockDriver.get();
+		transport->onWrite = [this](const std::vector<uint8_t>&) { requests++; };
+		com.emplace(report, std::move(mockDriver), [this]() {
+			return std::unique_ptr<Packetizer>(new Packetizer(report));
+		}, std::unique_ptr<Encoder>(new Encoder(report)), std::unique_ptr<Decoder>(new Decoder(report)));
+		com->packetizer = com->makeConfiguredPacketizer();
+		ASSERT_TRUE(com->open());
+	}
+
+	void TearDown() override {
+		EXPECT_EQ(errors, expectedErrors);
+		com.reset(); // Closes the communication
+	}
+
+	static uint8_t DiskByte(uint64_t pos) { return uint8_t(pos ^ (pos >> 8)); }
+
+	// A long format NeoMemorySDRead packet answering for one sector, carrying the sector as its startAddress
+	static std::vector<uint8_t> SectorPacket(uint32_t sector) {
+		const size_t length = 6 + sizeof(uint32_t) + Disk::SectorSize;
+		std::vector<uint8_t> packet = {
+			0xAA, 0x00, uint8_t(length & 0xFF), uint8_t(length >> 8),
+			uint8_t(Network::NetID::NeoMemorySDRead), uint8_t(uint16_t(Network::NetID::NeoMemorySDRead) >> 8),
+			uint8_t(sector & 0xFF), uint8_t((sector >> 8) & 0xFF), uint8_t((sector >> 16) & 0xFF), uint8_t(sector >> 24)
+		};
+		for(size_t i = 0; i < Disk::SectorSize; i++)
+			packet.push_back(DiskByte(sector * Disk::SectorSize + i));
+		return packet;
+	}
+
+	bool waitFor(const std::function<bool()>& done) {
+		for(int i = 0; i < 500; i++) {
+			if(done())
+				return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		return false;
+	}
+
+	// Unless the test expects some, there should be no errors
+	const device_eventhandler_t report = [this](APIEvent::Type, APIEvent::Severity) { errors++; };
+	std::atomic<size_t> errors{0};
+	size_t expectedErrors = 0;
+	optional<Communication> com;
+	MockDriver* transport = nullptr;
+	std::atomic<size_t> requests{0};
+	Disk::NeoMemoryDiskDriver driver;
+};
+
+TEST_F(NeoMemoryDiskDriverTest, ReadPipelined)
+{
+	std::vector<uint8_t> buf(Disk::SectorSize * 3);
+	optional<uint64_t> amountRead;
+	std::thread reader([&]() {
+		amountRead = driver.readLogicalDisk(*com, report, 0, buf.data(), buf.size(), std::chrono::seconds(5));
+	});
+
+	// Every sector is requested before the device has answered any of them
+	EXPECT_TRUE(waitFor([this]() { return requests == 3; }));
+	for(uint32_t sector = 0; sector < 3; sector++)
+		transport->receive(SectorPacket(sector));
+	reader.join();
+
+	EXPECT_EQ(amountRead, buf.size());
+	for(size_t i = 0; i < buf.size(); i++)
+		EXPECT_EQ(buf[i], DiskByte(i));
+}
+
+TEST_F(NeoMemoryDiskDriverTest, ReadOneAtATime)
+{
+	driver.maxOutstandingReads = 1;
+	std::atomic<uint32_t> answered{0};
+	transport->onWrite = [this, &answered](const std::vector<uint8_t>&) {
+		requests++;
+		EXPECT_EQ(requests, answered + 1); // The previous request was answered before the next was made
+		transport->receive(SectorPacket(answered++));
+	};
+
+	std::vector<uint8_t> buf(Disk::SectorSize * 2);
+	EXPECT_EQ(driver.readLogicalDisk(*com, report, 0, buf.data(), buf.size(), std::chrono::seconds(5)), buf.size());
+	EXPECT_EQ(requests, 2u);
+	for(size_t i = 0; i < buf.size(); i++)
+		EXPECT_EQ(buf[i], DiskByte(i));
+}
+
+TEST_F(NeoMemoryDiskDriverTest, ResponsesMatchedBySector)
+{
+	std::vector<uint8_t> buf(Disk::SectorSize * 3);
+	optional<uint64_t> amountRead;
+	std::thread reader([&]() {
+		amountRead = driver.readLogicalDisk(*com, report, 0, buf.data(), buf.size(), std::chrono::seconds(5));
+	});
+
+	// A response for a sector nobody asked for is an error, and is not taken as the answer to another request
+	EXPECT_TRUE(waitFor([this]() { return requests == 3; }));
+	expectedErrors = 1;
+	transport->receive(SectorPacket(7));
+	for(const uint32_t sector : { 2, 0, 1 })
+		transport->receive(SectorPacket(sector));
+	reader.join();
+
+	EXPECT_EQ(amountRead, buf.size());
+	for(size_t i = 0; i < buf.size(); i++)
+		EXPECT_EQ(buf[i], DiskByte(i));
+}
@@ -0,0 +1,90 @@
+#include "icsneo/communication/network.h"
+#include "icsneo/communication/networkset.h"
+#include "gtest/gtest.h"
+#include <cstring>
+
+using namespace icsneo;
+
+static constexpr Network::NetIDTables Tables = Network::MakeNetIDTables();
+
+static constexpr Network::Type TableType(Network::NetID netid) {
+	return Tables.types[neonetid_t(netid)];
+}
+
+static constexpr bool TableStringIs(Network::NetID netid, const char* expected) {
+	const char* str = Tables.strings[neonetid_t(netid)];
+	while(*str && *str == *expected) {
+		str++;
+		expected++;
+	}
+	return *str == *expected;
+}
+
+// One NetID of each type
+static_assert(TableType(Network::NetID::HSCAN) == Network::Type::CAN, "HSCAN should be CAN");
+static_assert(TableType(Network::NetID::LIN2) == Network::Type::LIN, "LIN2 should be LIN");
+static_assert(TableType(Network::NetID::FlexRay1a) == Network::Type::FlexRay, "FlexRay1a should be FlexRay");
+static_assert(TableType(Network::NetID::MOST50) == Network::Type::MOST, "MOST50 should be MOST");
+static_assert(TableType(Network::NetID::Main51) == Network::Type::Internal, "Main51 should be Internal");
+static_assert(TableType(Network::NetID::OP_Ethernet1) == Network::Type::Ethernet, "OP_Ethernet1 should be Ethernet");
+static_assert(TableType(Network::NetID::LSFTCAN2) == Network::Type::LSFTCAN, "LSFTCAN2 should be LSFTCAN");
+static_assert(TableType(Network::NetID::SWCAN2) == Network::Type::SWCAN, "SWCAN2 should be SWCAN");
+static_assert(TableType(Network::NetID::ISO9141_3) == Network::Type::ISO9141, "ISO9141_3 should be ISO9141");
+static_assert(TableType(Network::NetID::I2C3) == Network::Type::I2C, "I2C3 should be I2C");
+static_assert(TableType(Network::NetID(0x1FF)) == Network::Type::Other, "Unknown NetIDs should be Other");
+static_assert(Network::ComputeTypeOfNetID(Network::NetID::Invalid) == Network::Type::Invalid, "Invalid should be Invalid");
+
+static_assert(TableStringIs(Network::NetID::HSCAN, "HSCAN"), "HSCAN should be named HSCAN");
+static_assert(TableStringIs(Network::NetID::Device, "neoVI"), "Device should be named neoVI");
+
+// The table ends with the last NetID in use, and the NetID after it is not one
+static_assert(sizeof(Tables.types) / sizeof(Tables.types[0]) == Network::NetIDTableSize, "Tables should cover NetIDTableSize");
+static_assert(TableType(Network::NetID(Network::NetIDTableSize - 1)) == Network::Type::Ethernet, "The table should end with Ethernet2");
+static_assert(Network::ComputeTypeOfNetID(Network::NetID(Network::NetIDTableSize)) == Network::Type::Other,
+	"NetIDs past the table should not be in use");
+
+TEST(NetworkTest, LookupsPastTable)
+{
+	const auto past = Network::NetID(Network::NetIDTableSize);
+	EXPECT_EQ(Network::GetTypeOfNetID(past), Network::Type::Other);
+	EXPECT_STREQ(Network::GetNetIDString(past), Network::ComputeNetIDString(past));
+	EXPECT_EQ(Network::GetTypeOfNetID(Network::NetID::Invalid), Network::Type::Invalid);
+	EXPECT_EQ(Network::GetTypeOfNetID(Network::NetID::Any), Network::Type::Invalid);
+}
+
+TEST(NetworkTest, Construction)
+{
+	const Network net(Network::NetID::Ethernet2);
+	EXPECT_EQ(net.getNetID(), Network::NetID::Ethernet2);
+	EXPECT_EQ(net.getType(), Network::Type::Ethernet);
+
+	Network copy;
+	EXPECT_EQ(copy.getType(), Network::Type::Invalid);
+	std::memcpy(&copy, &net, sizeof(Network)); // Trivially copyable
+	EXPECT_EQ(copy, net);
+	EXPECT_EQ(copy.getType(), Network::Type::Ethernet);
+
+	EXPECT_EQ(Network(Network::NetID::Any).getType(), Network::Type::Invalid);
+	EXPECT_EQ(Network(neonetid_t(0x1234)).getType(), Network::Type::Other);
+}
+
+TEST(NetworkTest, NetworkSet)
+{
+	NetworkSet set({ Network::NetID::HSCAN, Network::NetID::Ethernet2, Network::NetID::HSCAN });
+	EXPECT_EQ(set.size(), 2u);
+	EXPECT_TRUE(set.contains(Network::NetID::HSCAN));
+	EXPECT_TRUE(set.contains(Network::NetID::Ethernet2));
+	EXPECT_FALSE(set.contains(Network::NetID::MSCAN));
+	EXPECT_FALSE(set.contains(Network::NetID::Invalid));
+
+	// NetIDs outside of the table are still tracked
+	const Network custom(neonetid_t(0x1234));
+	EXPECT_FALSE(set.contains(custom));
+	set.insert(custom);
+	set.insert(custom);
+	EXPECT_TRUE(set.contains(custom));
+	EXPECT_EQ(set.size(), 3u);
+
+	EXPECT_TRUE(NetworkSet().empty());
+	EXPECT_FALSE(NetworkSet().contains(Network::NetID::HSCAN));
+}
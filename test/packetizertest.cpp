@@ -0,0 +1,141 @@
+#include "icsneo/communication/packetizer.h"
+#include "icsneo/communication/decoder.h"
+#include "icsneo/communication/message/main51message.h"
+#include "gtest/gtest.h"
+
+using namespace icsneo;
+
+class PacketizerTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		packetizer.emplace([](APIEvent::Type, APIEvent::Severity) {
+			// Unless caught by the test, the packetizer should not throw errors
+			EXPECT_TRUE(false);
+		});
+	}
+
+	// A long format packet from the device carrying `size` bytes, each set to `fill`
+	static std::vector<uint8_t> LongPacket(Network::NetID netid, size_t size, uint8_t fill) {
+		std::vector<uint8_t> packet = { 0xAA, 0x00, uint8_t(size + 6), uint8_t((size + 6) >> 8), uint8_t(netid), uint8_t(uint16_t(netid) >> 8) };
+		packet.resize(6 + size, fill);
+		return packet;
+	}
+
+	// A short format packet, the length nibble counts the payload but not the header or checksum
+	static std::vector<uint8_t> ShortPacket(Network::NetID netid, std::vector<uint8_t> data) {
+		const uint8_t header = uint8_t((data.size() << 4) | uint8_t(netid));
+		const uint8_t checksum = Packetizer::ICSChecksum(data);
+		data.insert(data.begin(), { 0xAA, header });
+		data.push_back(checksum);
+		return data;
+	}
+
+	// An old format packet, a short packet wrapped in a long format packet
+	static std::vector<uint8_t> OldFormatPacket(Network::NetID netid, const std::vector<uint8_t>& data, size_t padding = 0) {
+		std::vector<uint8_t> payload = { uint8_t(data.size()), uint8_t(data.size() >> 8), uint8_t(0xF0 | uint8_t(netid)) };
+		payload.insert(payload.end(), data.begin(), data.end());
+		payload.resize(payload.size() + padding, 'A');
+		auto packet = LongPacket(Network::NetID::RED_OLDFORMAT, payload.size(), 0);
+		std::copy(payload.begin(), payload.end(), packet.begin() + 6);
+		return packet;
+	}
+
+	optional<Packetizer> packetizer;
+};
+
+TEST_F(PacketizerTest, SplitAcrossReads)
+{
+	std::vector<uint8_t> stream = { 0x01, 0x02 }; // Garbage before the first header is skipped
+	for(uint8_t i = 0; i < 50; i++) {
+		const auto packet = LongPacket(Network::NetID::HSCAN, 24 + i, i);
+		stream.insert(stream.end(), packet.begin(), packet.end());
+	}
+	const auto main51 = ShortPacket(Network::NetID::Main51, { 0x10, 0x20, 0x30 });
+	stream.insert(stream.end(), main51.begin(), main51.end());
+
+	// Odd sized reads, so that packets are split in every possible place
+	std::vector<std::shared_ptr<Packet>> packets;
+	for(size_t i = 0; i < stream.size(); i += 7) {
+		if(packetizer->input(std::vector<uint8_t>(stream.begin() + i, stream.begin() + std::min(i + 7, stream.size())))) {
+			for(auto& packet : packetizer->output())
+				packets.push_back(packet);
+		}
+	}
+
+	ASSERT_EQ(packets.size(), 51u);
+	for(uint8_t i = 0; i < 50; i++) {
+		EXPECT_EQ(packets[i]->network, Network::NetID::HSCAN);
+		EXPECT_EQ(packets[i]->data, std::vector<uint8_t>(24 + i, i));
+	}
+	EXPECT_EQ(packets[50]->network, Network::NetID::Main51);
+	EXPECT_EQ(packets[50]->data, std::vector<uint8_t>({ 0x10, 0x20, 0x30 }));
+}
+
+TEST_F(PacketizerTest, ChecksumError)
+{
+	auto good = ShortPacket(Network::NetID::Main51, { 1, 2 });
+	ASSERT_TRUE(packetizer->input(good));
+	EXPECT_EQ(packetizer->output().size(), 1u);
+
+	auto bad = good;
+	bad.back()++;
+	size_t errors = 0;
+	packetizer.emplace([&errors](APIEvent::Type t, APIEvent::Severity) {
+		EXPECT_EQ(t, APIEvent::Type::PacketChecksumError);
+		errors++;
+	});
+	ASSERT_TRUE(packetizer->input(good));
+	EXPECT_EQ(packetizer->output().size(), 1u);
+	EXPECT_FALSE(packetizer->input(bad));
+	EXPECT_EQ(errors, 1u);
+
+	// The stream recovers at the next good packet
+	ASSERT_TRUE(packetizer->input(good));
+	EXPECT_EQ(packetizer->output().size(), 1u);
+
+	// Unless checksums are disabled
+	packetizer->disableChecksum = true;
+	ASSERT_TRUE(packetizer->input(bad));
+	EXPECT_EQ(packetizer->output().size(), 1u);
+}
+
+TEST_F(PacketizerTest, OldFormat)
+{
+	std::vector<uint8_t> can(24);
+	can[4] = 2; // DLC
+	can[6] = 0x12;
+	can[7] = 0x34;
+	const uint8_t status = uint8_t(Command::RequestStatusUpdate);
+
+	std::vector<uint8_t> stream;
+	for(const auto& packet : {
+		OldFormatPacket(Network::NetID::HSCAN, can),
+		OldFormatPacket(Network::NetID::Main51, { status, 0x01, 0x02 }, 1), // Padded to an even length
+		OldFormatPacket(Network::NetID::MSCAN, can),
+	})
+		stream.insert(stream.end(), packet.begin(), packet.end());
+	ASSERT_TRUE(packetizer->input(stream));
+	const auto packets = packetizer->output();
+	ASSERT_EQ(packets.size(), 3u);
+
+	// The wrapper is removed, leaving the short packet
+	EXPECT_EQ(packets[0]->network, Network::NetID::HSCAN);
+	EXPECT_EQ(packets[0]->data, can);
+	EXPECT_EQ(packets[1]->network, Network::NetID::Main51);
+	EXPECT_EQ(packets[1]->data, std::vector<uint8_t>({ status, 0x01, 0x02 }));
+	EXPECT_EQ(packets[2]->network, Network::NetID::MSCAN);
+
+	Decoder decoder([](APIEvent::Type, APIEvent::Severity) { EXPECT_TRUE(false); });
+	std::shared_ptr<Message> msg;
+	ASSERT_TRUE(decoder.decode(msg, packets[0]));
+	const auto canmsg = std::dynamic_pointer_cast<CANMessage>(msg);
+	ASSERT_NE(canmsg, nullptr);
+	EXPECT_EQ(canmsg->network, Network::NetID::HSCAN);
+	EXPECT_EQ(canmsg->data, std::vector<uint8_t>({ 0x12, 0x34 }));
+
+	ASSERT_TRUE(decoder.decode(msg, packets[1]));
+	const auto main51 = std::dynamic_pointer_cast<Main51Message>(msg);
+	ASSERT_NE(main51, nullptr);
+	EXPECT_EQ(main51->command, Command::RequestStatusUpdate);
+	EXPECT_EQ(main51->data, std::vector<uint8_t>({ 0x01, 0x02 }));
+}